@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "memdb/core/Database.h"
+
+namespace {
+
+double run_query(memdb::core::Database& db, const std::string& query, const memdb::core::QueryOptions& options,
+                 int32_t& count) {
+    auto start = std::chrono::steady_clock::now();
+    memdb::core::QueryResult result = db.execute(query, options);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    if (!result.is_ok()) {
+        std::cerr << query << ": " << result.get_error() << "\n";
+        std::exit(1);
+    }
+    count = result.get_data()[0][0]->get_int();
+    return elapsed.count();
+}
+
+}
+
+// Times WHERE evaluation over one table with the interpreter, with compiled
+// filters row at a time and with vectorized filters, serially; the last
+// queries run as bytecode unless vectorized. The row count can be given as the first argument.
+int main(int argc, char** argv) {
+    const int row_count = argc > 1 ? std::atoi(argv[1]) : 500000;
+
+    memdb::core::Database db;
+    auto result = db.execute("create table events (id : int32, user_id : int32, amount : int32, kind : string[16], flagged : bool);");
+    if (!result.is_ok()) {
+        std::cerr << "Error creating table: " << result.get_error() << "\n";
+        return 1;
+    }
+    const std::vector<std::string> kinds = {"click", "view", "purchase", "refund"};
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    rows.reserve(row_count);
+    for (int i = 0; i < row_count; ++i) {
+        rows.push_back({memdb::core::Value(i), memdb::core::Value(i % 9973), memdb::core::Value((i * 7919) % 1000),
+                        memdb::core::Value(kinds[i % kinds.size()]), memdb::core::Value(i % 17 == 0)});
+    }
+    db.insert_rows("events", rows);
+
+    const std::vector<std::string> queries = {
+        "select count(*) from events where amount < 100;",
+        "select count(*) from events where kind = \"refund\";",
+        "select count(*) from events where kind = \"purchase\" && amount >= 500;",
+        "select count(*) from events where user_id = amount || flagged;",
+        "select count(*) from events where !flagged && kind != \"view\" && amount < 900 && user_id > 10;",
+        "select count(*) from events where (amount + user_id) % 10 = 3 && |kind| > 4;",
+        "select count(*) from events where amount * 2 - user_id / 7 > 500 || kind + \"s\" = \"views\";"
+    };
+
+    memdb::core::QueryOptions interpreted;
+    interpreted.num_threads = 1;
+    interpreted.compile_filters = false;
+    memdb::core::QueryOptions compiled = interpreted;
+    compiled.compile_filters = true;
+    compiled.vectorized_filters = false;
+    memdb::core::QueryOptions vectorized = compiled;
+    vectorized.vectorized_filters = true;
+
+    std::cout << row_count << " rows\n";
+    for (const auto& query : queries) {
+        int32_t interpreted_count = 0;
+        int32_t compiled_count = 0;
+        int32_t vectorized_count = 0;
+        double interpreted_ms = run_query(db, query, interpreted, interpreted_count);
+        double compiled_ms = run_query(db, query, compiled, compiled_count);
+        double vectorized_ms = run_query(db, query, vectorized, vectorized_count);
+        if (interpreted_count != compiled_count || interpreted_count != vectorized_count) {
+            std::cerr << query << ": results differ\n";
+            return 1;
+        }
+        std::cout << query << "\n  interpreted " << interpreted_ms << " ms, compiled " << compiled_ms
+                  << " ms, vectorized " << vectorized_ms << " ms, speedup " << interpreted_ms / vectorized_ms << "x\n";
+    }
+    return 0;
+}
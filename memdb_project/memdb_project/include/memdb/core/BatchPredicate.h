@@ -0,0 +1,59 @@
+#ifndef MEMDB_CORE_BATCHPREDICATE_H
+#define MEMDB_CORE_BATCHPREDICATE_H
+
+#include "memdb/core/Expression.h"
+#include "memdb/core/Operator.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// A WHERE conjunct evaluated a batch of tuples at a time: the columns it
+// reads are gathered into contiguous arrays for the selected tuples,
+// arithmetic and comparisons run as plain loops over them, and the selection
+// vector is narrowed to the tuples that pass. Comparisons of an int32
+// expression with a constant use AVX2 when the CPU has it.
+//
+// Supported are comparisons of int32 expressions built from columns,
+// literals, + - * / % and the length of string and bytes columns,
+// comparisons of bool columns and literals, a bool column or its negation,
+// and comparisons of a string[N] or bytes[N] column with a literal. The
+// values of such a column are packed at a fixed stride derived from N and
+// compared with the literal 16 bytes per SSE2 instruction, or two 16-byte
+// strides per AVX2 instruction.
+class BatchPredicate {
+public:
+    // Returns nothing when the conjunct has another form. Names in `hidden`
+    // are not read from the tuple.
+    static std::optional<BatchPredicate> compile(const Expression& conjunct,
+                                                 const ExecutionContext& context,
+                                                 const std::unordered_set<std::string>& hidden);
+
+    // Keeps the entries of `selection`, indexes into `tuples`, whose tuple
+    // passes. Throws when a selected tuple has a NULL column or a divisor is
+    // zero; the caller then evaluates the batch one tuple at a time, which
+    // raises the interpreter's error for the right row.
+    void filter(const std::vector<RowTuple>& tuples, std::vector<uint32_t>& selection) const;
+
+    struct Node;
+    struct PackedComparison;
+
+private:
+    void filter_packed(const std::vector<RowTuple>& tuples, std::vector<uint32_t>& selection) const;
+
+    std::shared_ptr<const PackedComparison> packed_;
+    std::shared_ptr<const Node> left_;
+    std::shared_ptr<const Node> right_;
+    BinaryExpression::Operator op_ = BinaryExpression::Operator::NotEqual;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_BATCHPREDICATE_H
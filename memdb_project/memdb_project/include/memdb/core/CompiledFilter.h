@@ -0,0 +1,69 @@
+#ifndef MEMDB_CORE_COMPILEDFILTER_H
+#define MEMDB_CORE_COMPILEDFILTER_H
+
+#include "memdb/core/BatchPredicate.h"
+#include "memdb/core/Expression.h"
+#include "memdb/core/Operator.h"
+
+#include "memdb/core/structs/QueryOptions.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// WHERE conjuncts compiled into closures that read the columns of a RowTuple
+// in place, without building a row map or boxing intermediate values. Each
+// comparison of a column with a literal or with another column of the same
+// type is one template-specialised kernel, and '&&', '||' and '!' over
+// compiled operands combine their closures.
+//
+// With bytecode_filters, other conjuncts over the columns of the tuple are
+// compiled into an ExpressionProgram instead. With vectorized_filters, the
+// conjuncts a BatchPredicate supports are also evaluated over whole batches
+// of tuples by select().
+//
+// Expressions must have been bound. Like the interpreter, a kernel throws
+// when it reads a NULL column.
+class CompiledFilter {
+public:
+    using Predicate = std::function<bool(const RowTuple& tuple)>;
+
+    static const size_t kBatchSize = 1024;
+
+    // Compiles the leading conjuncts that have a compiled form and appends
+    // the others to `rest` in order, so that the conjuncts are still
+    // evaluated in the given order. Names in `hidden` are not read from the
+    // tuple, as select aliases shadow them.
+    static CompiledFilter compile(const std::vector<const Expression*>& conjuncts,
+                                  const ExecutionContext& context,
+                                  const std::unordered_set<std::string>& hidden,
+                                  const QueryOptions& options,
+                                  std::vector<const Expression*>& rest);
+
+    bool empty() const { return conjuncts_.empty(); }
+    bool matches(const RowTuple& tuple) const;
+
+    // Sets `selection` to the indexes in [begin, end) of the tuples that
+    // pass. Returns false, with every index selected, when evaluating the
+    // batch raised an error; those tuples must then be checked with matches()
+    // one at a time, so that the error is raised for the right tuple.
+    bool select(const std::vector<RowTuple>& tuples, size_t begin, size_t end, std::vector<uint32_t>& selection) const;
+
+private:
+    struct Conjunct {
+        Predicate predicate;
+        std::optional<BatchPredicate> batch;
+    };
+
+    std::vector<Conjunct> conjuncts_;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_COMPILEDFILTER_H
@@ -0,0 +1,62 @@
+#ifndef MEMDB_CORE_CSVIMPORTER_H
+#define MEMDB_CORE_CSVIMPORTER_H
+
+#include "memdb/core/Table.h"
+#include "memdb/core/ThreadPool.h"
+#include "memdb/core/Value.h"
+
+#include "memdb/core/structs/CsvImportOptions.h"
+#include "memdb/core/structs/CsvImportResult.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+namespace memdb {
+namespace core {
+
+// Loads a CSV file into a table. The file is memory-mapped and cut into
+// chunks on line boundaries; chunks are parsed in parallel into column
+// buffers and appended in file order through Table::insert_rows.
+// Quoted fields may contain delimiters and doubled quotes, but not line breaks.
+// Chunks are parsed on `pool`, or on a pool of the importer's own when none
+// is given.
+class CsvImporter {
+public:
+    CsvImporter(Table& table, const CsvImportOptions& options = CsvImportOptions(), ThreadPool* pool = nullptr);
+
+    CsvImportResult import_file(const std::string& path);
+
+private:
+    struct Field {
+        std::string_view text;
+        bool quoted = false;
+        bool has_escapes = false;
+    };
+
+    struct ParsedChunk {
+        std::vector<std::vector<std::optional<Value>>> columns;
+        std::vector<size_t> row_lines;
+        std::vector<CsvImportError> errors;
+        size_t line_count = 0;
+    };
+
+    void map_header(std::string_view header_line);
+    ParsedChunk parse_chunk(std::string_view chunk) const;
+    void split_line(std::string_view line, std::vector<Field>& fields) const;
+    std::optional<Value> convert_field(const Field& field, const Column& column) const;
+    void append_chunk(ParsedChunk& chunk, size_t first_line, CsvImportResult& result);
+
+    Table& table_;
+    CsvImportOptions options_;
+    ThreadPool* pool_;
+    std::shared_ptr<ThreadPool> own_pool_;
+    std::vector<size_t> field_columns_;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_CSVIMPORTER_H
@@ -7,8 +7,14 @@
 #include "memdb/core/Row.h"
 #include "memdb/core/QueryParser.h"
 #include "memdb/core/QueryExecutor.h"
+#include "memdb/core/ThreadPool.h"
 
 #include "memdb/core/structs/ParsedQuery.h"
+#include "memdb/core/structs/CsvImportOptions.h"
+#include "memdb/core/structs/CsvImportResult.h"
+#include "memdb/core/structs/ExportOptions.h"
+#include "memdb/core/structs/QueryOptions.h"
+#include "memdb/core/structs/ThreadPoolOptions.h"
 
 #include <string>
 #include <unordered_map>
@@ -23,7 +29,11 @@ namespace core {
 
 class Database {
 public:
-    Database();
+    explicit Database(const ThreadPoolOptions& thread_pool_options = ThreadPoolOptions());
+
+    // The parser keeps a pointer to its database.
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
 
     void create_table(const std::string& table_name, const std::vector<Column>& columns);
     void drop_table(const std::string& table_name);
@@ -31,6 +41,7 @@ public:
     bool has_table(const std::string& table_name) const;
 
     RowID insert_row(const std::string& table_name, const std::vector<std::optional<Value>>& values);
+    std::vector<RowID> insert_rows(const std::string& table_name, const std::vector<std::vector<std::optional<Value>>>& rows);
     void delete_row(const std::string& table_name, core::RowID row_id);
     Row& get_row(const std::string& table_name, core::RowID row_id);
     const Row& get_row(const std::string& table_name, core::RowID row_id) const;
@@ -39,10 +50,25 @@ public:
     void save_to_file(const std::string& filename) const;
     void load_from_file(const std::string& filename);
 
-    QueryResult execute(const std::string& query);
+    CsvImportResult import_csv(const std::string& table_name, const std::string& path,
+                               const CsvImportOptions& options = CsvImportOptions());
+    void export_csv(const std::string& table_name, const std::string& path,
+                    const ExportOptions& options = ExportOptions()) const;
+    void export_columnar(const std::string& table_name, const std::string& path,
+                         const ExportOptions& options = ExportOptions()) const;
+
+    QueryResult execute(const std::string& query, const QueryOptions& options = QueryOptions());
+    // Streams the rows of a SELECT; the tables it reads must not be modified
+    // while the cursor is in use.
+    QueryCursor open_cursor(const std::string& query, const QueryOptions& options = QueryOptions());
+    // Hash aggregation switches to sorting once its groups would exceed this.
+    void set_aggregation_memory_budget(size_t bytes) { executor_.set_aggregation_memory_budget(bytes); }
     
     void create_index(const std::string& table_name, const std::string& index_type, const std::vector<std::string>& columns);
 
+    // Shared by scans, index builds, snapshot I/O, CSV import and export.
+    ThreadPool& get_thread_pool() const { return *thread_pool_; }
+
     std::string to_string() const;
 
 private:
@@ -50,6 +76,7 @@ private:
 
     QueryParser parser_;
     QueryExecutor executor_;
+    std::unique_ptr<ThreadPool> thread_pool_;
 };
 
 } 
@@ -0,0 +1,72 @@
+#ifndef MEMDB_CORE_EXPORTER_H
+#define MEMDB_CORE_EXPORTER_H
+
+#include "memdb/core/Table.h"
+#include "memdb/core/QueryResult.h"
+#include "memdb/core/ThreadPool.h"
+
+#include "memdb/core/structs/ColumnInfo.h"
+#include "memdb/core/structs/ExportOptions.h"
+
+#include <functional>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// Streams a table or a query result to disk, either as CSV or as a binary
+// columnar file. The columnar layout is:
+//
+//   "MDBCOL01" | column chunks ... | footer | u64 footer offset | "MDBCOL01"
+//
+// Rows are cut into row groups of ExportOptions::rows_per_chunk. Every row
+// group stores one chunk per column: a validity bitmap followed by the
+// values (int32 little endian, one byte per bool, or u32 offsets plus data
+// for strings and bytes). The footer holds the schema and the offset and
+// length of every chunk.
+//
+// Chunks are encoded on `pool`, or on a pool of the exporter's own when none
+// is given.
+class Exporter {
+public:
+    explicit Exporter(const ExportOptions& options = ExportOptions(), ThreadPool* pool = nullptr);
+
+    void write_csv(const Table& table, const std::string& path) const;
+    void write_csv(const QueryResult& result, const std::string& path) const;
+
+    void write_columnar(const Table& table, const std::string& path) const;
+    void write_columnar(const QueryResult& result, const std::string& path) const;
+
+    static QueryResult read_columnar(const std::string& path);
+
+private:
+    using RowChunk = std::vector<const std::vector<std::optional<Value>>*>;
+    using RowSource = std::function<bool(RowChunk&)>;
+
+    void write_csv(const std::vector<ColumnInfo>& columns, const RowSource& source, const std::string& path) const;
+    void write_columnar(const std::vector<ColumnInfo>& columns, const RowSource& source, const std::string& path) const;
+
+    void append_csv_row(std::string& out, const std::vector<std::optional<Value>>& row, size_t column_count) const;
+    void append_csv_field(std::string& out, const std::string& text, bool force_quotes) const;
+    static std::string encode_column_chunk(const RowChunk& rows, size_t column, Type type);
+
+    static RowSource table_source(const Table& table, size_t rows_per_chunk);
+    static RowSource result_source(const QueryResult& result, size_t rows_per_chunk);
+    static std::vector<ColumnInfo> table_columns(const Table& table);
+    static std::vector<ColumnInfo> result_columns(const QueryResult& result);
+
+    size_t thread_count() const;
+
+    ExportOptions options_;
+    ThreadPool* pool_;
+    std::shared_ptr<ThreadPool> own_pool_;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_EXPORTER_H
@@ -16,17 +16,59 @@ class Expression {
 public:
     virtual ~Expression() = default;
     virtual DataType get_type() const = 0;
+
+    // Resolves the columns of the expression against `schema`, checks the
+    // operand types of every node and returns the result type; ill-typed
+    // expressions throw TypeMismatchException. Binding records types on the
+    // nodes of the const tree, so a tree is bound by one query execution
+    // only; the executor binds a copy of the parsed query per execution.
+    virtual DataType bind(const std::unordered_map<std::string, DataType>& schema) const = 0;
     virtual Value evaluate(const std::unordered_map<std::string, Value>& row) const = 0;
     virtual std::string to_string() const = 0;
+
+    static const size_t kNotShared = static_cast<size_t>(-1);
+
+    // Set by the planner on subtrees that occur more than once in a query:
+    // within a SubexpressionCache::Scope such a subtree is evaluated once and
+    // its value reused by every occurrence with the same slot. Like bind(),
+    // the planner only marks the copy of the query a cursor owns.
+    void set_shared_slot(size_t slot) const { shared_slot_ = slot; }
+    size_t get_shared_slot() const { return shared_slot_; }
+
+protected:
+    mutable size_t shared_slot_ = kNotShared;
+};
+
+// The values of shared subtrees for the row being evaluated on the current
+// thread. A Scope covers one row; outside of any scope shared subtrees are
+// evaluated every time.
+class SubexpressionCache {
+public:
+    class Scope {
+    public:
+        explicit Scope(size_t slots);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        size_t previous_base_;
+    };
+
+    static const Value* find(size_t slot);
+    static void store(size_t slot, const Value& value);
 };
 
 class LiteralExpression : public Expression {
 public:
     LiteralExpression(const Value& value);
     DataType get_type() const override;
+    DataType bind(const std::unordered_map<std::string, DataType>& schema) const override;
     Value evaluate(const std::unordered_map<std::string, Value>& row) const override;
     std::string to_string() const override;
 
+    const Value& get_value() const { return value_; }
+
 private:
     Value value_;
 };
@@ -35,6 +77,7 @@ class VariableExpression : public Expression {
 public:
     VariableExpression(const std::string& name);
     DataType get_type() const override;
+    DataType bind(const std::unordered_map<std::string, DataType>& schema) const override;
     Value evaluate(const std::unordered_map<std::string, Value>& row) const override;
     std::string to_string() const override;
 
@@ -42,6 +85,7 @@ public:
 
 private:
     std::string name_;
+    mutable DataType type_ = DataType(Type::Unknown);
 };
 
 class UnaryExpression : public Expression {
@@ -53,10 +97,16 @@ public:
 
     UnaryExpression(Operator op, std::unique_ptr<Expression> operand);
     DataType get_type() const override;
+    DataType bind(const std::unordered_map<std::string, DataType>& schema) const override;
     Value evaluate(const std::unordered_map<std::string, Value>& row) const override;
     std::string to_string() const override;
 
+    Operator get_operator() const { return op_; }
+    const Expression* get_operand() const { return operand_.get(); }
+
 private:
+    Value compute(const std::unordered_map<std::string, Value>& row) const;
+
     Operator op_;
     std::unique_ptr<Expression> operand_;
 };
@@ -82,6 +132,7 @@ public:
 
     BinaryExpression(Operator op, std::unique_ptr<Expression> left, std::unique_ptr<Expression> right);
     DataType get_type() const override;
+    DataType bind(const std::unordered_map<std::string, DataType>& schema) const override;
     Value evaluate(const std::unordered_map<std::string, Value>& row) const override;
     std::string to_string() const override;
 
@@ -90,9 +141,48 @@ public:
     const Expression* get_right() const { return right_.get(); }
 
 private:
+    using Kernel = Value (*)(const Value& left, const Value& right);
+
+    Value compute(const std::unordered_map<std::string, Value>& row) const;
+
     Operator op_;
     std::unique_ptr<Expression> left_;
     std::unique_ptr<Expression> right_;
+
+    // Set by bind() once both operand types are known: the result type and,
+    // except for '&&' and '||', an evaluator specialised for the operand
+    // types that performs no type checks.
+    mutable bool bound_ = false;
+    mutable DataType type_ = DataType(Type::Unknown);
+    mutable Kernel kernel_ = nullptr;
+};
+
+// count/sum/min/max/avg over the rows of a group. The aggregation stage
+// stores the result in the row under to_string(), which evaluate() reads back;
+// a NULL result is absent from the row.
+class AggregateExpression : public Expression {
+public:
+    enum class Function {
+        Count,
+        Sum,
+        Min,
+        Max,
+        Avg
+    };
+
+    // A null argument stands for count(*).
+    AggregateExpression(Function function, std::unique_ptr<Expression> argument);
+    DataType get_type() const override;
+    DataType bind(const std::unordered_map<std::string, DataType>& schema) const override;
+    Value evaluate(const std::unordered_map<std::string, Value>& row) const override;
+    std::string to_string() const override;
+
+    Function get_function() const { return function_; }
+    const Expression* get_argument() const { return argument_.get(); }
+
+private:
+    Function function_;
+    std::unique_ptr<Expression> argument_;
 };
 
 } 
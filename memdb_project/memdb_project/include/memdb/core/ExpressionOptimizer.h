@@ -0,0 +1,38 @@
+#ifndef MEMDB_CORE_EXPRESSIONOPTIMIZER_H
+#define MEMDB_CORE_EXPRESSIONOPTIMIZER_H
+
+#include "memdb/core/Expression.h"
+
+#include <memory>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// Rewrites parsed expressions into equivalent ones that are cheaper to
+// evaluate per row: constant subtrees are folded into literals, boolean
+// identities such as `true && x` are removed and a literal compared with a
+// column is moved to the right-hand side.
+//
+// Conjunctions that no row can satisfy, such as `x < 1 && x > 5`, are only
+// recognised by is_contradiction once the query is bound, so that comparing
+// a column with a literal of another type is still rejected.
+//
+// Subtrees whose evaluation fails are kept, and so are operands that may
+// fail before an operand that decides the result, so errors such as division
+// by zero are still reported per row.
+class ExpressionOptimizer {
+public:
+    static std::unique_ptr<Expression> simplify(const Expression& expression);
+
+    // A deep copy of `expression` that is not yet bound.
+    static std::unique_ptr<Expression> clone(const Expression& expression);
+
+    static bool is_false(const Expression* expression);
+    static bool is_contradiction(const std::vector<const Expression*>& conjuncts);
+};
+
+}
+}
+
+#endif // MEMDB_CORE_EXPRESSIONOPTIMIZER_H
@@ -25,6 +25,7 @@ private:
     std::unique_ptr<Expression> parse_factor();
     std::unique_ptr<Expression> parse_unary();
     std::unique_ptr<Expression> parse_primary();
+    std::unique_ptr<Expression> parse_aggregate(const std::string& name);
 
     Lexer lexer_;
     Token current_token_;
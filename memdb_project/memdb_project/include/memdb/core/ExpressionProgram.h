@@ -0,0 +1,127 @@
+#ifndef MEMDB_CORE_EXPRESSIONPROGRAM_H
+#define MEMDB_CORE_EXPRESSIONPROGRAM_H
+
+#include "memdb/core/Expression.h"
+#include "memdb/core/Operator.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// A bound expression compiled into register bytecode that reads the columns
+// of a RowTuple in place. Every opcode is specialised for the types of its
+// operands, so the dispatch loop performs no type checks; it uses computed
+// gotos where the compiler supports them. '&&' and '||' jump over their right
+// operand like the interpreter does, and errors carry the same messages.
+//
+// A program refers to columns by slot and position only, so it stays valid
+// for any tuple of the same relations and can be evaluated on several
+// threads at once.
+class ExpressionProgram {
+public:
+    enum class OpCode : uint8_t {
+        LoadInt,
+        LoadBool,
+        LoadString,
+        LoadBytes,
+        LoadImmediate,
+        LoadConstString,
+        LoadConstBytes,
+        Move,
+        AddInt,
+        SubtractInt,
+        MultiplyInt,
+        DivideInt,
+        ModuloInt,
+        Concat,
+        LengthString,
+        LengthBytes,
+        Not,
+        Xor,
+        LessInt,
+        LessEqualInt,
+        GreaterInt,
+        GreaterEqualInt,
+        EqualInt,
+        NotEqualInt,
+        LessString,
+        LessEqualString,
+        GreaterString,
+        GreaterEqualString,
+        EqualString,
+        NotEqualString,
+        LessBytes,
+        LessEqualBytes,
+        GreaterBytes,
+        GreaterEqualBytes,
+        EqualBytes,
+        NotEqualBytes,
+        JumpIfFalse,
+        JumpIfTrue,
+        Return
+    };
+
+    // `dst` is a register; `a` and `b` are registers, a column, a constant,
+    // an immediate int32 or a jump target depending on the opcode.
+    struct Instruction {
+        OpCode op;
+        uint32_t dst;
+        uint32_t a;
+        uint32_t b;
+    };
+
+    // Returns nothing when the expression has a node without bytecode, such
+    // as an aggregate, a NULL literal or a column not in the tuple. Names in
+    // `hidden` are not read from the tuple.
+    static std::optional<ExpressionProgram> compile(const Expression& expression,
+                                                    const ExecutionContext& context,
+                                                    const std::unordered_set<std::string>& hidden);
+
+    Value evaluate(const RowTuple& tuple) const;
+    // For a Bool program.
+    bool matches(const RowTuple& tuple) const;
+
+    const std::vector<Instruction>& get_code() const { return code_; }
+    Type get_type() const { return type_; }
+    // One instruction per line, e.g. "r2 = lt.int r0, r1".
+    std::string to_string() const;
+
+    // A little-endian byte encoding of the whole program. deserialize()
+    // throws SerializationException unless every instruction reads only
+    // registers of the right kind that are set on every path to it, columns
+    // and constants the program defines, and only jumps forward to end in a
+    // Return. Like the compiled program, the result is only valid for tuples
+    // of the relations it was compiled for.
+    std::string serialize() const;
+    static ExpressionProgram deserialize(const std::string& data);
+
+private:
+    struct ColumnSlot {
+        size_t slot;
+        size_t column;
+        std::string name;
+    };
+
+    struct Register;
+
+    class Compiler;
+
+    const Register& run(const RowTuple& tuple) const;
+    void verify() const;
+
+    std::vector<Instruction> code_;
+    std::vector<ColumnSlot> columns_;
+    std::vector<Value> constants_;
+    size_t register_count_ = 0;
+    Type type_ = Type::Unknown;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_EXPRESSIONPROGRAM_H
@@ -0,0 +1,98 @@
+#ifndef MEMDB_CORE_HASHAGGREGATOR_H
+#define MEMDB_CORE_HASHAGGREGATOR_H
+
+#include "memdb/core/Expression.h"
+#include "memdb/core/Value.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// Groups rows by `keys` and computes `aggregates` for every group in an
+// open-addressing hash table sized from `expected_rows`. When the groups would
+// outgrow `memory_budget` bytes it switches to sorting: the remaining rows are
+// buffered as one-row partial groups that are sorted and merged by key
+// whenever the buffer fills up, and the groups come out in key order.
+//
+// A plain variable that names one of `columns` but is absent from the row is
+// NULL: it forms its own group as a key and is skipped by the aggregates.
+//
+// Parallel aggregation pre-aggregates every morsel into a partial() and
+// merges the partials in morsel order, so groups come out in the order in
+// which a single aggregator would have seen them.
+class HashAggregator {
+public:
+    HashAggregator(std::vector<const Expression*> keys,
+                   std::vector<const AggregateExpression*> aggregates,
+                   std::unordered_set<std::string> columns,
+                   size_t memory_budget,
+                   size_t expected_rows);
+
+    void add(const std::unordered_map<std::string, Value>& row);
+
+    // An empty aggregator over the same keys and aggregates.
+    std::unique_ptr<HashAggregator> partial(size_t expected_rows) const;
+    // Folds the groups of `other` into this aggregator; `other` is left empty.
+    void merge(HashAggregator& other);
+
+    // Writes the keys and aggregate results of the next group into `row`,
+    // under the variable name of each key and the to_string() of each key and
+    // aggregate. NULL results are left out.
+    bool next(std::unordered_map<std::string, Value>& row);
+
+    bool is_sorting() const { return sorting_; }
+
+private:
+    struct Accumulator {
+        int64_t count = 0;
+        int64_t sum = 0;
+        std::optional<Value> extreme;
+    };
+
+    struct Group {
+        std::vector<std::optional<Value>> keys;
+        std::vector<Accumulator> accumulators;
+    };
+
+    struct Slot {
+        size_t hash;
+        size_t group;
+    };
+
+    std::optional<Value> evaluate(const Expression* expression, const std::unordered_map<std::string, Value>& row) const;
+    size_t find_group(size_t hash, const std::vector<std::optional<Value>>& keys) const;
+    size_t locate(std::vector<std::optional<Value>> keys);
+    void insert_slot(size_t hash, size_t group);
+    void grow();
+    void accumulate(Accumulator& accumulator, const AggregateExpression& aggregate,
+                    const std::unordered_map<std::string, Value>& row) const;
+    void merge(Accumulator& into, const Accumulator& from, const AggregateExpression& aggregate) const;
+    std::optional<Value> result(const Accumulator& accumulator, const AggregateExpression& aggregate) const;
+    void collapse();
+    void finish();
+
+    std::vector<const Expression*> keys_;
+    std::vector<const AggregateExpression*> aggregates_;
+    std::unordered_set<std::string> columns_;
+    size_t memory_budget_;
+    size_t max_groups_;
+    size_t collapse_at_;
+
+    bool sorting_ = false;
+    bool finished_ = false;
+    std::vector<Slot> slots_;
+    std::vector<Group> groups_;
+    size_t position_ = 0;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_HASHAGGREGATOR_H
\ No newline at end of file
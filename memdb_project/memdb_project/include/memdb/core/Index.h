@@ -22,6 +22,7 @@ public:
     const std::vector<std::string>& get_columns() const { return columns_; }
 
     void add_row(RowID row_id, const std::unordered_map<std::string, Value>& row);
+    void add_rows(const std::vector<RowID>& row_ids, const std::vector<std::unordered_map<std::string, Value>>& rows);
     void remove_row(RowID row_id, const std::unordered_map<std::string, Value>& row);
 
     std::vector<RowID> search_unordered(const std::unordered_map<std::string, Value>& condition) const;
@@ -31,12 +32,17 @@ public:
                                       const std::optional<Value>& upper,
                                       bool upper_inclusive) const;
 
+    const std::multimap<Value, RowID>& get_ordered_entries() const { return ordered_map_; }
+
 private:
+    std::string make_key(const std::unordered_map<std::string, Value>& row) const;
+    const Value& ordered_key(const std::unordered_map<std::string, Value>& row) const;
+
     IndexType type_;
     std::vector<std::string> columns_;
     
     std::unordered_map<std::string, std::vector<RowID>> unordered_map_;
-    std::map<std::string, RowID> ordered_map_;
+    std::multimap<Value, RowID> ordered_map_;
 };
 
 } 
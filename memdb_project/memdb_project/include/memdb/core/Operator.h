@@ -0,0 +1,295 @@
+#ifndef MEMDB_CORE_OPERATOR_H
+#define MEMDB_CORE_OPERATOR_H
+
+#include "memdb/core/Expression.h"
+#include "memdb/core/Index.h"
+#include "memdb/core/Row.h"
+#include "memdb/core/Table.h"
+#include "memdb/core/ThreadPool.h"
+
+#include "memdb/core/structs/ColumnRange.h"
+#include "memdb/core/structs/QueryOptions.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// One slot per table of the query, pointing into that table's storage.
+using RowTuple = std::vector<const Row*>;
+
+// Tables of one pipeline and the names their columns are bound under:
+// "table.column" in joins, the plain column name otherwise.
+class ExecutionContext {
+public:
+    size_t add_relation(std::shared_ptr<Table> table, const std::string& qualifier);
+
+    size_t relation_count() const { return tables_.size(); }
+    const Table& get_table(size_t slot) const { return *tables_[slot]; }
+    const std::string& get_qualifier(size_t slot) const { return qualifiers_[slot]; }
+    const std::vector<std::string>& get_names(size_t slot) const { return names_[slot]; }
+
+    std::unordered_map<std::string, Value>& bind(const RowTuple& tuple);
+    std::unordered_map<std::string, Value>& bind(const RowTuple& tuple, size_t slot);
+    // Binds into a map owned by the caller, so that several threads can
+    // evaluate tuples of the same pipeline.
+    void bind_into(const RowTuple& tuple, std::unordered_map<std::string, Value>& row_map) const;
+
+    bool passes(const std::vector<const Expression*>& conditions, const std::string& error_message) const;
+    static bool passes(const std::unordered_map<std::string, Value>& row_map,
+                       const std::vector<const Expression*>& conditions, const std::string& error_message);
+
+    // Lets operators and the cursor spread work over `pool`. The pipeline
+    // stays serial when the options leave fewer than two workers.
+    void set_parallelism(ThreadPool& pool, const QueryOptions& options);
+    ThreadPool* get_thread_pool() const { return pool_; }
+    size_t get_workers() const { return workers_; }
+    size_t get_morsel_size() const { return morsel_size_; }
+
+private:
+    std::vector<std::shared_ptr<Table>> tables_;
+    std::vector<std::string> qualifiers_;
+    std::vector<std::vector<std::string>> names_;
+    std::vector<const Row*> bound_;
+    std::unordered_map<std::string, Value> row_map_;
+
+    ThreadPool* pool_ = nullptr;
+    size_t workers_ = 1;
+    size_t morsel_size_ = 1;
+};
+
+struct TupleKey {
+    size_t outer_slot;
+    size_t outer_column;
+    size_t inner_column;
+};
+
+// "inner_column op outer value" for range probes of an ordered index.
+struct TupleRange {
+    size_t outer_slot;
+    size_t outer_column;
+    BinaryExpression::Operator op;
+};
+
+class Operator {
+public:
+    virtual ~Operator() = default;
+    virtual bool next(RowTuple& tuple) = 0;
+};
+
+// Yields no rows; replaces the pipeline of a query whose WHERE or join
+// condition simplified to `false`, so that no table is read.
+class EmptyOperator : public Operator {
+public:
+    bool next(RowTuple& tuple) override;
+};
+
+// A column whose conjuncts the index read by a ScanOperator answers exactly:
+// only its equalities when `equality_only`, otherwise all of its range
+// comparisons.
+struct IndexedColumn {
+    std::string column;
+    bool equality_only;
+};
+
+// Streams the rows of one table in RowID order, reading through an index
+// when `ranges` pin an indexed column. Otherwise the blocks whose zones rule
+// out one of `ranges` are skipped.
+class ScanOperator : public Operator {
+public:
+    ScanOperator(ExecutionContext& context, size_t slot,
+                 std::vector<ColumnRange> ranges, std::vector<const Expression*> filters);
+    bool next(RowTuple& tuple) override;
+
+    static std::vector<const Row*> collect(ExecutionContext& context, size_t slot,
+                                           const std::vector<ColumnRange>& ranges,
+                                           const std::vector<const Expression*>& filters);
+    static std::vector<IndexedColumn> indexed_columns(const Table& table, const std::vector<ColumnRange>& ranges);
+
+private:
+    void open();
+
+    ExecutionContext& context_;
+    size_t slot_;
+    std::vector<ColumnRange> ranges_;
+    std::vector<const Expression*> filters_;
+    RowTuple scratch_;
+
+    bool opened_ = false;
+    bool use_index_ = false;
+    std::vector<RowID> row_ids_;
+    size_t position_ = 0;
+    std::map<RowID, Row>::const_iterator row_it_;
+    std::vector<ZoneMap::Range> zone_ranges_;
+    uint64_t zone_end_ = 0;
+};
+
+// Streams the rows of one table in the key order of an ordered index,
+// optionally restricted to `range` of the indexed column. Rows whose key is
+// NULL are not in the index and are not returned.
+class OrderedIndexScanOperator : public Operator {
+public:
+    OrderedIndexScanOperator(ExecutionContext& context, size_t slot, const Index* index,
+                             const std::optional<ColumnRange>& range, bool descending);
+    bool next(RowTuple& tuple) override;
+
+private:
+    ExecutionContext& context_;
+    size_t slot_;
+    bool descending_;
+    std::multimap<Value, RowID>::const_iterator begin_;
+    std::multimap<Value, RowID>::const_iterator end_;
+};
+
+class FilterOperator : public Operator {
+public:
+    FilterOperator(ExecutionContext& context, std::unique_ptr<Operator> child,
+                   std::vector<const Expression*> conditions, std::string error_message);
+    bool next(RowTuple& tuple) override;
+
+private:
+    ExecutionContext& context_;
+    std::unique_ptr<Operator> child_;
+    std::vector<const Expression*> conditions_;
+    std::string error_message_;
+};
+
+// Pulls outer tuples one at a time and pairs each with the inner rows that
+// find_matches() returns, keeping those that satisfy `conditions`.
+class JoinOperator : public Operator {
+public:
+    JoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                 std::vector<const Expression*> inner_filters, std::vector<const Expression*> conditions);
+    bool next(RowTuple& tuple) override;
+
+protected:
+    virtual void find_matches(const RowTuple& outer, std::vector<const Row*>& matches) = 0;
+    bool inner_passes(const Row& row);
+    bool outer_next(RowTuple& tuple) { return outer_->next(tuple); }
+
+    ExecutionContext& context_;
+    size_t inner_slot_;
+    std::vector<const Expression*> inner_filters_;
+    std::vector<const Expression*> conditions_;
+
+private:
+    std::unique_ptr<Operator> outer_;
+    RowTuple outer_tuple_;
+    RowTuple scratch_;
+    std::vector<const Row*> matches_;
+    size_t match_position_ = 0;
+};
+
+class NestedLoopJoinOperator : public JoinOperator {
+public:
+    NestedLoopJoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                           std::vector<ColumnRange> inner_ranges, std::vector<const Expression*> inner_filters,
+                           std::vector<const Expression*> conditions);
+
+protected:
+    void find_matches(const RowTuple& outer, std::vector<const Row*>& matches) override;
+
+private:
+    std::vector<ColumnRange> inner_ranges_;
+    std::optional<std::vector<const Row*>> inner_rows_;
+};
+
+// Builds a hash table on the inner table the first time it is pulled. With
+// `build_outer` the outer side is drained and hashed instead, and the matches
+// are sorted back into outer order before they are returned.
+//
+// With a thread pool in the context both sides are drained, radix-partitioned
+// on the key hash so that the inner side of each partition fits in L2 cache,
+// and the partitions are joined in parallel. Matches come out in the same
+// order as from the serial join.
+class HashJoinOperator : public JoinOperator {
+public:
+    HashJoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                     std::vector<ColumnRange> inner_ranges, std::vector<const Expression*> inner_filters,
+                     std::vector<const Expression*> conditions, std::vector<TupleKey> keys, bool build_outer = false);
+    bool next(RowTuple& tuple) override;
+
+protected:
+    void find_matches(const RowTuple& outer, std::vector<const Row*>& matches) override;
+
+private:
+    bool outer_key(const RowTuple& tuple, size_t& hash) const;
+    bool inner_key(const Row& row, size_t& hash) const;
+    bool keys_match(const RowTuple& tuple, const Row& row) const;
+    void build_on_outer();
+    void build_partitioned();
+
+    std::vector<ColumnRange> inner_ranges_;
+    std::vector<TupleKey> keys_;
+    std::vector<size_t> inner_columns_;
+    bool build_outer_;
+    bool built_ = false;
+    std::unordered_map<size_t, std::vector<const Row*>> hash_table_;
+
+    std::vector<RowTuple> outer_tuples_;
+    std::vector<std::pair<size_t, const Row*>> pairs_;
+    size_t pair_position_ = 0;
+};
+
+// Looks each outer tuple up in an index of the inner table: an equality probe
+// over `keys`, or an ordered range probe bounded by `ranges`.
+class IndexJoinOperator : public JoinOperator {
+public:
+    IndexJoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                      std::vector<const Expression*> inner_filters, std::vector<const Expression*> conditions,
+                      const Index* index, std::vector<TupleKey> keys, std::vector<TupleRange> ranges = {});
+
+protected:
+    void find_matches(const RowTuple& outer, std::vector<const Row*>& matches) override;
+
+private:
+    const Index* index_;
+    std::vector<TupleKey> keys_;
+    std::vector<TupleRange> ranges_;
+    std::unordered_map<std::string, Value> probe_;
+};
+
+// Walks ordered indexes of both tables in key order and pairs up the groups
+// of equal keys, so the output is sorted by the key.
+class MergeJoinOperator : public Operator {
+public:
+    MergeJoinOperator(ExecutionContext& context,
+                      size_t left_slot, const Index* left_index, std::vector<const Expression*> left_filters,
+                      size_t right_slot, const Index* right_index, std::vector<const Expression*> right_filters,
+                      std::vector<TupleKey> keys, std::vector<const Expression*> conditions);
+    bool next(RowTuple& tuple) override;
+
+private:
+    bool next_group();
+    bool side_passes(size_t slot, const std::vector<const Expression*>& filters, const Row& row);
+
+    ExecutionContext& context_;
+    size_t left_slot_;
+    size_t right_slot_;
+    std::vector<const Expression*> left_filters_;
+    std::vector<const Expression*> right_filters_;
+    std::vector<TupleKey> keys_;
+    std::vector<const Expression*> conditions_;
+
+    std::multimap<Value, RowID>::const_iterator left_it_;
+    std::multimap<Value, RowID>::const_iterator left_end_;
+    std::multimap<Value, RowID>::const_iterator right_it_;
+    std::multimap<Value, RowID>::const_iterator right_end_;
+
+    RowTuple scratch_;
+    std::vector<const Row*> left_group_;
+    std::vector<const Row*> right_group_;
+    size_t left_position_ = 0;
+    size_t right_position_ = 0;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_OPERATOR_H
\ No newline at end of file
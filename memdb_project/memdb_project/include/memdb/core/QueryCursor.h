@@ -0,0 +1,121 @@
+#ifndef MEMDB_CORE_QUERYCURSOR_H
+#define MEMDB_CORE_QUERYCURSOR_H
+
+#include "memdb/core/CompiledFilter.h"
+#include "memdb/core/HashAggregator.h"
+#include "memdb/core/Operator.h"
+#include "memdb/core/ThreadPool.h"
+#include "memdb/core/Value.h"
+
+#include "memdb/core/structs/ColumnInfo.h"
+#include "memdb/core/structs/ParsedQuery.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// Pulls the rows of a SELECT one at a time from its operator pipeline, so a
+// result is never held in memory as a whole. The tables read by the query
+// must not be modified while the cursor is in use. Once LIMIT rows have been
+// returned the pipeline is no longer pulled.
+//
+// ORDER BY drains the pipeline before the first row is returned, keeping only
+// the first OFFSET + LIMIT rows in a heap when there is a LIMIT. `presorted`
+// means the pipeline already yields rows in the requested order.
+//
+// With an `aggregator` every row passing WHERE is aggregated first and the
+// cursor returns one row per group.
+//
+// Rows that fail `filter` are dropped before their row map is built; the
+// filter is applied to batches of tuples pulled from the pipeline. `where`
+// holds the conjuncts that are interpreted.
+//
+// When the context has a thread pool, WHERE, the select list and the sort
+// keys are evaluated in morsels on its workers, which also pre-aggregate
+// morsels and sort large results. Rows keep the order in which the pipeline
+// produced them.
+class QueryCursor {
+public:
+    QueryCursor(const ParsedQuery& query,
+                std::shared_ptr<const ParsedQuery> owner,
+                std::unique_ptr<ExecutionContext> context,
+                std::unique_ptr<Operator> root,
+                std::vector<ColumnInfo> columns,
+                std::vector<const Expression*> where,
+                bool aliases_in_where,
+                bool presorted = false,
+                std::unique_ptr<HashAggregator> aggregator = nullptr,
+                CompiledFilter filter = CompiledFilter());
+
+    bool next(std::vector<std::optional<Value>>& row);
+    std::vector<std::vector<std::optional<Value>>> fetch(size_t max_rows);
+
+    const std::vector<ColumnInfo>& get_columns() const { return columns_; }
+
+private:
+    struct SortedRow {
+        std::vector<std::optional<Value>> keys;
+        std::vector<std::optional<Value>> values;
+        size_t sequence;
+    };
+
+    bool pull(std::vector<std::optional<Value>>& row);
+    bool produce(std::vector<std::optional<Value>>& row, std::vector<std::optional<Value>>* keys = nullptr);
+    bool produce_group(std::vector<std::optional<Value>>& row);
+    void aggregate_parallel();
+    bool produce_batch(std::vector<std::optional<Value>>& row, std::vector<std::optional<Value>>* keys);
+    bool pull_tuples(size_t capacity);
+    const RowTuple* next_tuple();
+    void fill_batch();
+    bool evaluate(std::unordered_map<std::string, Value>& row_map, std::vector<std::optional<Value>>& row) const;
+    std::vector<std::optional<Value>> order_keys(const std::vector<std::optional<Value>>& row,
+                                                 std::unordered_map<std::string, Value>& row_map) const;
+    bool row_less(const SortedRow& left, const SortedRow& right) const;
+    void sort_rows();
+
+    const ParsedQuery* query_;
+    std::shared_ptr<const ParsedQuery> owner_;
+    std::unique_ptr<ExecutionContext> context_;
+    std::unique_ptr<Operator> root_;
+    std::vector<ColumnInfo> columns_;
+    std::vector<std::string> aliases_;
+    std::vector<const Expression*> where_;
+    CompiledFilter filter_;
+    bool aliases_in_where_;
+    std::vector<bool> where_items_;
+    size_t shared_slots_ = 0;
+    RowTuple tuple_;
+    size_t skipped_ = 0;
+    size_t produced_ = 0;
+
+    bool sort_;
+    bool sorted_ = false;
+    std::vector<const VariableExpression*> key_columns_;
+    std::vector<SortedRow> sorted_rows_;
+    size_t sorted_position_ = 0;
+
+    std::unique_ptr<HashAggregator> aggregator_;
+    bool aggregated_ = false;
+    std::vector<bool> grouped_items_;
+    std::unordered_map<std::string, Value> group_map_;
+
+    ThreadPool* pool_ = nullptr;
+    size_t workers_ = 1;
+    size_t morsel_size_ = 1;
+    std::vector<RowTuple> tuples_;
+    std::vector<SortedRow> batch_;
+    size_t batch_position_ = 0;
+    bool exhausted_ = false;
+    std::vector<uint32_t> selection_;
+    size_t selection_position_ = 0;
+    bool selected_exactly_ = true;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_QUERYCURSOR_H
\ No newline at end of file
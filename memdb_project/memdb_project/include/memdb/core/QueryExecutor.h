@@ -2,9 +2,11 @@
 #define MEMDB_CORE_QUERYEXECUTOR_H
 
 #include "memdb/core/Expression.h"
+#include "memdb/core/QueryCursor.h"
 #include "memdb/core/QueryResult.h"
 
 #include "memdb/core/structs/ParsedQuery.h"
+#include "memdb/core/structs/QueryOptions.h"
 
 #include <memory>
 
@@ -15,13 +17,26 @@ class Database;
 
 class QueryExecutor {
 public:
-    QueryResult execute(const ParsedQuery& parsed_query, Database& db);
+    QueryResult execute(const ParsedQuery& parsed_query, Database& db, const QueryOptions& options = QueryOptions());
+    // The cursor binds and plans its own copy of `pq`, which the caller need
+    // not keep alive.
+    QueryCursor open_select(const ParsedQuery& pq, Database& db, const QueryOptions& options = QueryOptions());
+
+    void set_aggregation_memory_budget(size_t bytes) { aggregation_memory_budget_ = bytes; }
     
 private:
-    QueryResult execute_select(const ParsedQuery& pq, Database& db);
-    QueryResult execute_update(const ParsedQuery& pq, Database& db);
-    QueryResult execute_delete(const ParsedQuery& pq, Database& db);
+    QueryResult execute_select(const ParsedQuery& pq, Database& db, const QueryOptions& options);
+    QueryCursor open_scan(const ParsedQuery& pq, Database& db, const QueryOptions& options,
+                           std::shared_ptr<const ParsedQuery> owner);
+    QueryCursor open_join(const ParsedQuery& pq, Database& db, const QueryOptions& options,
+                           std::shared_ptr<const ParsedQuery> owner);
+    QueryCursor open_multi_join(const ParsedQuery& pq, Database& db, const QueryOptions& options,
+                           std::shared_ptr<const ParsedQuery> owner);
+    QueryResult execute_update(const ParsedQuery& pq, Database& db, const QueryOptions& options);
+    QueryResult execute_delete(const ParsedQuery& pq, Database& db, const QueryOptions& options);
     QueryResult execute_create_index(const ParsedQuery& pq, Database& db);
+
+    size_t aggregation_memory_budget_ = 64 * 1024 * 1024;
 };
 
 } 
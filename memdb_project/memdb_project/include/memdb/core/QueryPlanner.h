@@ -0,0 +1,46 @@
+#ifndef MEMDB_CORE_QUERYPLANNER_H
+#define MEMDB_CORE_QUERYPLANNER_H
+
+#include "memdb/core/Expression.h"
+
+#include "memdb/core/structs/ColumnRange.h"
+#include "memdb/core/structs/JoinPlan.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+class QueryPlanner {
+public:
+    static std::vector<const Expression*> split_conjuncts(const Expression* expression);
+    static std::vector<const Expression*> order_conjuncts(std::vector<const Expression*> conjuncts);
+    static std::string column_qualifier(const std::string& column_name);
+    static BinaryExpression::Operator mirror_comparison(BinaryExpression::Operator op);
+    static void collect_columns(const Expression* expression, std::vector<std::string>& columns);
+    static bool may_raise(const Expression* expression);
+    static void collect_aggregates(const Expression* expression, std::vector<const AggregateExpression*>& aggregates);
+    static size_t share_subexpressions(const std::vector<const Expression*>& expressions,
+                                       const std::unordered_set<std::string>& shadowed);
+    static std::vector<bool> where_dependencies(const std::vector<const Expression*>& items,
+                                                const std::vector<std::string>& aliases,
+                                                const std::vector<const Expression*>& conjuncts);
+
+    static JoinPlan plan_join(const Expression* condition,
+                              const std::string& left_table,
+                              const std::string& right_table);
+
+    static std::vector<ColumnRange> literal_ranges(const std::vector<const Expression*>& conjuncts,
+                                                   const std::string& qualifier);
+
+    static std::vector<EquiJoinKey> equi_join_keys(const std::vector<const Expression*>& conjuncts);
+    static std::vector<size_t> order_joins(const std::vector<JoinRelation>& relations,
+                                           const std::vector<EquiJoinKey>& keys);
+};
+
+}
+}
+
+#endif // MEMDB_CORE_QUERYPLANNER_H
@@ -7,10 +7,15 @@
 #include "memdb/core/Value.h"
 #include "memdb/core/Index.h"
 #include "memdb/core/Expression.h"
+#include "memdb/core/ThreadPool.h"
+#include "memdb/core/ZoneMap.h"
+
+#include "memdb/core/structs/QueryOptions.h"
 
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <optional>
 #include <memory>
 #include <stdexcept>
@@ -34,17 +39,26 @@ public:
 
     RowID insert_row(const std::vector<std::optional<Value>>& values);
     RowID insert_row(const std::vector<std::optional<Value>>& values, RowID id);
+    std::vector<RowID> insert_rows(const std::vector<std::vector<std::optional<Value>>>& rows);
+    void update_row(RowID id, const std::vector<std::optional<Value>>& values);
     void delete_row(RowID id);
     Row& get_row(RowID id);
     const Row& get_row(RowID id) const;
     const std::map<RowID, Row>& get_all_rows() const;
     std::map<RowID, Row>& get_all_rows();
     const std::vector<std::unique_ptr<Index>>& get_indexes() const { return indexes_; }
+    const ZoneMap& get_zone_map() const { return zones_; }
 
-    void add_index(const std::string& index_type_str, const std::vector<std::string>& columns);
-    std::vector<RowID> find_rows(const std::unique_ptr<Expression>& condition) const;
+    void add_index(const std::string& index_type_str, const std::vector<std::string>& columns,
+                   ThreadPool* pool = nullptr);
+    // Rows matching `condition` in RowID order. Blocks whose zones rule out a
+    // range the condition puts on a column are skipped. With a pool, tables
+    // larger than one morsel are filtered by several workers.
+    std::vector<RowID> find_rows(const std::unique_ptr<Expression>& condition, ThreadPool* pool = nullptr,
+                                 const QueryOptions& options = QueryOptions()) const;
 
     void validate_row(const std::vector<std::optional<Value>>& values) const;
+    void validate_rows(const std::vector<std::vector<std::optional<Value>>>& rows) const;
     void validate_row_update(const std::vector<std::optional<Value>>& updated_values, RowID current_row_id) const;
 
     nlohmann::json to_json() const;
@@ -53,10 +67,24 @@ public:
     std::string to_string() const;
 
 private:
+    std::vector<std::optional<Value>> complete_row(const std::vector<std::optional<Value>>& values, RowID auto_value) const;
+    void check_unique_batch(const std::vector<std::vector<std::optional<Value>>>& rows) const;
+    bool is_unique_column(size_t column) const;
+    size_t unique_count(size_t column, const Value& value) const;
+    void track_unique(const std::vector<std::optional<Value>>& values, bool add);
+
+    std::optional<std::unordered_map<std::string, Value>> index_row_map(const Index& index, const std::vector<std::optional<Value>>& values) const;
+    void index_row(RowID id, const std::vector<std::optional<Value>>& values);
+    void unindex_row(RowID id, const std::vector<std::optional<Value>>& values);
+
     std::string name_;
     std::vector<Column> columns_;
     std::map<RowID, Row> rows_;
     std::vector<std::unique_ptr<Index>> indexes_;
+    ZoneMap zones_;
+    // How often each value occurs in a unique or key column, maintained by
+    // every insert, update and delete; empty for the other columns.
+    std::vector<std::unordered_map<Value, size_t, ValueHash>> unique_values_;
     RowID next_row_id_;
 };
 
@@ -0,0 +1,76 @@
+#ifndef MEMDB_CORE_THREADPOOL_H
+#define MEMDB_CORE_THREADPOOL_H
+
+#include "memdb/core/structs/ThreadPoolOptions.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// Worker threads shared by every parallel feature of one database, so that
+// concurrent work does not oversubscribe the machine. The threads are started
+// on first use.
+//
+// Every worker owns a deque of jobs. Jobs submitted from a worker go to its
+// own deque, other jobs are spread over the deques round-robin. A worker
+// takes jobs from the back of its own deque and steals from the front of the
+// others' when it runs out.
+class ThreadPool {
+public:
+    // The thread calling run() counts as one of the workers.
+    explicit ThreadPool(const ThreadPoolOptions& options = ThreadPoolOptions());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return size_; }
+
+    // Calls task(i) for every i in [0, count) on at most `max_workers` threads
+    // (0 means all of them) and returns once every call has finished. If
+    // tasks throw, the exception of the lowest failing index is rethrown, and
+    // the indices above it are skipped.
+    void run(size_t count, const std::function<void(size_t)>& task, size_t max_workers = 0);
+
+    // Calls fn(begin, end) for consecutive ranges of at most `grain` rows
+    // covering [0, count).
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn,
+                      size_t max_workers = 0);
+
+private:
+    struct Worker {
+        std::deque<std::function<void()>> jobs;
+        std::mutex mutex;
+    };
+
+    void start();
+    void submit(std::vector<std::function<void()>> jobs);
+    bool take(size_t worker, std::function<void()>& job);
+    void work(size_t worker);
+
+    size_t size_;
+    bool pin_threads_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::once_flag started_;
+    std::atomic<size_t> next_worker_{0};
+
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::atomic<long> pending_{0};
+    bool stopping_ = false;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_THREADPOOL_H
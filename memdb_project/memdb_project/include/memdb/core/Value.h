@@ -40,10 +40,18 @@ public:
 
     std::string to_string() const;
 
+    bool operator==(const Value& other) const;
+    bool operator!=(const Value& other) const;
+    bool operator<(const Value& other) const;
+
 private:
     std::optional<std::variant<int32_t, bool, std::string, std::vector<uint8_t>>> data_;
 };
 
+struct ValueHash {
+    size_t operator()(const Value& value) const;
+};
+
 } 
 } 
 
@@ -0,0 +1,78 @@
+#ifndef MEMDB_CORE_ZONEMAP_H
+#define MEMDB_CORE_ZONEMAP_H
+
+#include "memdb/core/Column.h"
+#include "memdb/core/Row.h"
+#include "memdb/core/Value.h"
+
+#include "memdb/core/structs/ColumnRange.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+// Per-block summaries of the rows of a table, where a block holds the rows
+// whose RowIDs share id / kBlockRows. A zone keeps the block's row count and
+// per column its NULL count and, for int32, string and bytes columns, the
+// smallest and largest value. Inserts widen the bounds; updates and deletes
+// keep the NULL counts exact but leave the bounds as they are, so they may be
+// wider than the rows still in the block. A zone is dropped with its last row.
+class ZoneMap {
+public:
+    static const RowID kBlockRows = 4096;
+
+    struct Zone {
+        size_t rows = 0;
+        std::vector<size_t> nulls;
+        std::vector<std::optional<Value>> min;
+        std::vector<std::optional<Value>> max;
+    };
+
+    // A range on the column at `column`.
+    struct Range {
+        size_t column;
+        ColumnRange range;
+    };
+
+    explicit ZoneMap(const std::vector<Column>& columns);
+
+    void add(RowID id, const std::vector<std::optional<Value>>& values);
+    void remove(RowID id, const std::vector<std::optional<Value>>& values);
+
+    const Zone* get_zone(RowID block) const;
+    const std::map<RowID, Zone>& get_zones() const { return zones_; }
+
+    // The ranges of `ranges` the zones can rule blocks out for: those on a
+    // column with bounds whose literals have the column's type.
+    std::vector<Range> resolve(const std::vector<ColumnRange>& ranges) const;
+
+    // Whether rows of `block` may lie within every range. A block with NULLs
+    // in a ranged column may always match, so that comparing them still
+    // raises its error.
+    bool may_match(RowID block, const std::vector<Range>& ranges) const;
+
+    // The first row from `it` on, but not past `end`, in a block that may
+    // match `ranges`.
+    std::map<RowID, Row>::const_iterator seek(const std::map<RowID, Row>& rows,
+                                              std::map<RowID, Row>::const_iterator it,
+                                              std::map<RowID, Row>::const_iterator end,
+                                              const std::vector<Range>& ranges) const;
+
+    // One past the last RowID of the block of `id`.
+    static uint64_t block_end(RowID id) { return (static_cast<uint64_t>(id / kBlockRows) + 1) * kBlockRows; }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<Type> types_;
+    std::map<RowID, Zone> zones_;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_ZONEMAP_H
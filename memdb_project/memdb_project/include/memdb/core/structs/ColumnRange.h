@@ -0,0 +1,34 @@
+#ifndef MEMDB_CORE_STRUCTS_COLUMNRANGE_H
+#define MEMDB_CORE_STRUCTS_COLUMNRANGE_H
+
+#include "memdb/core/Value.h"
+
+#include <optional>
+#include <string>
+
+namespace memdb {
+namespace core {
+
+struct ColumnRange {
+    std::string column;
+    std::optional<Value> lower;
+    bool lower_inclusive = true;
+    std::optional<Value> upper;
+    bool upper_inclusive = true;
+
+    bool is_equality() const {
+        return lower.has_value() && upper.has_value() && lower_inclusive && upper_inclusive && *lower == *upper;
+    }
+
+    bool is_empty() const {
+        if (!lower.has_value() || !upper.has_value()) {
+            return false;
+        }
+        return *upper < *lower || (*lower == *upper && !(lower_inclusive && upper_inclusive));
+    }
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_COLUMNRANGE_H
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef MEMDB_CORE_STRUCTS_CSVIMPORTOPTIONS_H
+#define MEMDB_CORE_STRUCTS_CSVIMPORTOPTIONS_H
+
+#include <cstddef>
+#include <functional>
+
+namespace memdb {
+namespace core {
+
+struct CsvImportOptions {
+    char delimiter = ',';
+    char quote = '"';
+    bool has_header = true;
+    bool stop_on_error = false;
+
+    // 0 means one worker per hardware thread.
+    size_t num_threads = 0;
+    size_t chunk_size = 4 * 1024 * 1024;
+
+    std::function<void(size_t rows_imported, size_t bytes_processed, size_t total_bytes)> on_progress;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_CSVIMPORTOPTIONS_H
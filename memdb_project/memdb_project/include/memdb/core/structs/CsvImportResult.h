@@ -0,0 +1,25 @@
+#ifndef MEMDB_CORE_STRUCTS_CSVIMPORTRESULT_H
+#define MEMDB_CORE_STRUCTS_CSVIMPORTRESULT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+struct CsvImportError {
+    size_t line;
+    std::string message;
+};
+
+struct CsvImportResult {
+    size_t rows_imported = 0;
+    size_t rows_rejected = 0;
+    std::vector<CsvImportError> errors;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_CSVIMPORTRESULT_H
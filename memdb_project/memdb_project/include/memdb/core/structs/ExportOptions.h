@@ -0,0 +1,24 @@
+#ifndef MEMDB_CORE_STRUCTS_EXPORTOPTIONS_H
+#define MEMDB_CORE_STRUCTS_EXPORTOPTIONS_H
+
+#include <cstddef>
+
+namespace memdb {
+namespace core {
+
+struct ExportOptions {
+    char delimiter = ',';
+    char quote = '"';
+    bool write_header = true;
+
+    size_t rows_per_chunk = 64 * 1024;
+    size_t buffer_size = 1024 * 1024;
+
+    // 0 means one worker per hardware thread.
+    size_t num_threads = 0;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_EXPORTOPTIONS_H
@@ -0,0 +1,41 @@
+#ifndef MEMDB_CORE_STRUCTS_JOINPLAN_H
+#define MEMDB_CORE_STRUCTS_JOINPLAN_H
+
+#include "memdb/core/Expression.h"
+
+#include <string>
+#include <vector>
+
+namespace memdb {
+namespace core {
+
+struct EquiJoinKey {
+    std::string left_column;
+    std::string right_column;
+    const Expression* condition;
+};
+
+// Comparison between the two sides, normalised to "right_column op left_column".
+struct RangeJoinKey {
+    std::string left_column;
+    std::string right_column;
+    BinaryExpression::Operator op;
+    const Expression* condition;
+};
+
+struct JoinRelation {
+    std::string table_name;
+    size_t cardinality = 0;
+    std::vector<std::string> indexed_columns;
+};
+
+struct JoinPlan {
+    std::vector<EquiJoinKey> keys;
+    std::vector<RangeJoinKey> ranges;
+    std::vector<const Expression*> residual;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_JOINPLAN_H
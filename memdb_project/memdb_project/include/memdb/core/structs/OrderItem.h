@@ -0,0 +1,17 @@
+#ifndef MEMDB_CORE_STRUCTS_ORDERITEM_H
+#define MEMDB_CORE_STRUCTS_ORDERITEM_H
+
+#include <memdb/core/Expression.h>
+
+namespace memdb {
+namespace core {
+
+struct OrderItem {
+    std::unique_ptr<Expression> expression;
+    bool descending = false;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_ORDERITEM_H
\ No newline at end of file
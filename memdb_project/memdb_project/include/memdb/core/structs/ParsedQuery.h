@@ -7,6 +7,7 @@
 
 #include "memdb/core/structs/SelectItem.h"
 #include "memdb/core/structs/JoinInfo.h"
+#include "memdb/core/structs/OrderItem.h"
 
 #include <string>
 #include <vector>
@@ -32,6 +33,7 @@ struct ParsedQuery {
 
     std::optional<std::vector<std::optional<Value>>> insert_values;
     std::optional<std::unordered_map<std::string, Value>> insert_named_values;
+    std::vector<std::vector<std::optional<Value>>> insert_batch;
 
     std::vector<SelectItem> select_items;
     
@@ -49,6 +51,11 @@ struct ParsedQuery {
 
     std::vector<JoinInfo> joins;
 
+    std::vector<std::unique_ptr<Expression>> group_by;
+    std::vector<OrderItem> order_by;
+    std::optional<size_t> limit;
+    size_t offset = 0;
+
     // TODO: other fields if needed
 };
 
@@ -0,0 +1,29 @@
+#ifndef MEMDB_CORE_STRUCTS_QUERYOPTIONS_H
+#define MEMDB_CORE_STRUCTS_QUERYOPTIONS_H
+
+#include <cstddef>
+
+namespace memdb {
+namespace core {
+
+struct QueryOptions {
+    // Workers of the database's thread pool a query may use; 0 means all of
+    // them and 1 runs the query on the calling thread only.
+    size_t num_threads = 0;
+    // Rows a worker evaluates at a time.
+    size_t morsel_size = 16 * 1024;
+    // Evaluates the WHERE conjuncts that have a compiled form directly on the
+    // stored rows instead of interpreting them over a row map.
+    bool compile_filters = true;
+    // With compile_filters, runs the other conjuncts as register bytecode
+    // where they have no specialised kernel.
+    bool bytecode_filters = true;
+    // With compile_filters, evaluates the conjuncts a BatchPredicate
+    // supports a batch of rows at a time.
+    bool vectorized_filters = true;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_QUERYOPTIONS_H
@@ -0,0 +1,19 @@
+#ifndef MEMDB_CORE_STRUCTS_THREADPOOLOPTIONS_H
+#define MEMDB_CORE_STRUCTS_THREADPOOLOPTIONS_H
+
+#include <cstddef>
+
+namespace memdb {
+namespace core {
+
+struct ThreadPoolOptions {
+    // 0 means one worker per hardware thread.
+    size_t num_threads = 0;
+    // Binds every worker thread to its own CPU where the platform allows it.
+    bool pin_threads = false;
+};
+
+}
+}
+
+#endif // MEMDB_CORE_STRUCTS_THREADPOOLOPTIONS_H
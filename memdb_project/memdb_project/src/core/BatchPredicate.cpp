@@ -0,0 +1,533 @@
+#include "memdb/core/BatchPredicate.h"
+
+#include "memdb/core/exceptions/TypeMismatchException.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MEMDB_AVX2_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace memdb {
+namespace core {
+
+using Op = BinaryExpression::Operator;
+
+struct BatchPredicate::Node {
+    enum class Kind {
+        Column,
+        Length,
+        Constant,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Modulo
+    };
+
+    Kind kind;
+    size_t slot = 0;
+    size_t column = 0;
+    bool boolean = false;
+    bool bytes = false;
+    std::string name;
+    int32_t constant = 0;
+    std::shared_ptr<const Node> left;
+    std::shared_ptr<const Node> right;
+};
+
+// `column` op `constant` over strings or byte arrays. Values are padded with
+// zeros to `stride`, a multiple of 16 that fits both the declared size of
+// the column and the constant.
+struct BatchPredicate::PackedComparison {
+    size_t slot;
+    size_t column;
+    bool bytes;
+    std::string name;
+    size_t stride;
+    // The constant twice over, so that a 32-byte load at any 16-byte
+    // aligned offset of a stride has its counterpart.
+    std::vector<uint8_t> pattern;
+    size_t length;
+};
+
+namespace {
+
+using Node = BatchPredicate::Node;
+using PackedComparison = BatchPredicate::PackedComparison;
+using NodePtr = std::shared_ptr<const Node>;
+
+struct ColumnRef {
+    size_t slot;
+    size_t column;
+};
+
+using Resolver = std::unordered_map<std::string, ColumnRef>;
+
+NodePtr column_node(const VariableExpression& variable, const Resolver& resolver) {
+    auto ref = resolver.find(variable.get_name());
+    if (ref == resolver.end()) {
+        return nullptr;
+    }
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Column;
+    node->slot = ref->second.slot;
+    node->column = ref->second.column;
+    node->boolean = variable.get_type().get_type() == Type::Bool;
+    node->name = variable.get_name();
+    return node;
+}
+
+const Value& column_value(const RowTuple& tuple, size_t slot, size_t column, const std::string& name) {
+    const Row* row = tuple[slot];
+    // The interpreter leaves NULLs out of its rows, so they raise its error.
+    if (row == nullptr || !row->get_values()[column].has_value() || !row->get_values()[column]->has_value()) {
+        throw exceptions::TypeMismatchException("Column not found: " + name);
+    }
+    return *row->get_values()[column];
+}
+
+NodePtr constant_node(int32_t value) {
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Constant;
+    node->constant = value;
+    return node;
+}
+
+// An operand of type `type`, which is Int32 or Bool.
+NodePtr compile_operand(const Expression& expression, Type type, const Resolver& resolver) {
+    if (expression.get_type().get_type() != type) {
+        return nullptr;
+    }
+    if (auto literal = dynamic_cast<const LiteralExpression*>(&expression)) {
+        if (!literal->get_value().has_value()) {
+            return nullptr;
+        }
+        return constant_node(type == Type::Bool ? literal->get_value().get_bool() : literal->get_value().get_int());
+    }
+    if (auto variable = dynamic_cast<const VariableExpression*>(&expression)) {
+        return column_node(*variable, resolver);
+    }
+    if (auto unary = dynamic_cast<const UnaryExpression*>(&expression)) {
+        auto variable = dynamic_cast<const VariableExpression*>(unary->get_operand());
+        Type operand = variable ? variable->get_type().get_type() : Type::Unknown;
+        if (unary->get_operator() != UnaryExpression::Operator::Length || (operand != Type::String && operand != Type::Bytes)) {
+            return nullptr;
+        }
+        auto column = column_node(*variable, resolver);
+        if (!column) {
+            return nullptr;
+        }
+        auto node = std::make_shared<Node>(*column);
+        node->kind = Node::Kind::Length;
+        node->bytes = operand == Type::Bytes;
+        return node;
+    }
+
+    auto binary = dynamic_cast<const BinaryExpression*>(&expression);
+    if (!binary || type != Type::Int32) {
+        return nullptr;
+    }
+    Node::Kind kind;
+    switch (binary->get_operator()) {
+        case Op::Add: kind = Node::Kind::Add; break;
+        case Op::Subtract: kind = Node::Kind::Subtract; break;
+        case Op::Multiply: kind = Node::Kind::Multiply; break;
+        case Op::Divide: kind = Node::Kind::Divide; break;
+        case Op::Modulo: kind = Node::Kind::Modulo; break;
+        default: return nullptr;
+    }
+    auto left = compile_operand(*binary->get_left(), Type::Int32, resolver);
+    auto right = left ? compile_operand(*binary->get_right(), Type::Int32, resolver) : nullptr;
+    if (!right) {
+        return nullptr;
+    }
+    auto node = std::make_shared<Node>();
+    node->kind = kind;
+    node->left = std::move(left);
+    node->right = std::move(right);
+    return node;
+}
+
+// Writes the value of `node` for each selected tuple to `out`.
+void evaluate(const Node& node, const std::vector<RowTuple>& tuples, const std::vector<uint32_t>& selection,
+              std::vector<int32_t>& out) {
+    size_t count = selection.size();
+    out.resize(count);
+    if (node.kind == Node::Kind::Constant) {
+        std::fill(out.begin(), out.end(), node.constant);
+        return;
+    }
+    if (node.kind == Node::Kind::Column) {
+        for (size_t i = 0; i < count; ++i) {
+            const Value& value = column_value(tuples[selection[i]], node.slot, node.column, node.name);
+            out[i] = node.boolean ? value.get_bool() : value.get_int();
+        }
+        return;
+    }
+    if (node.kind == Node::Kind::Length) {
+        for (size_t i = 0; i < count; ++i) {
+            const Value& value = column_value(tuples[selection[i]], node.slot, node.column, node.name);
+            out[i] = static_cast<int32_t>(node.bytes ? value.get_bytes().size() : value.get_string().size());
+        }
+        return;
+    }
+
+    evaluate(*node.left, tuples, selection, out);
+    std::vector<int32_t> right;
+    evaluate(*node.right, tuples, selection, right);
+    int32_t* values = out.data();
+    const int32_t* operand = right.data();
+    switch (node.kind) {
+        case Node::Kind::Add:
+            for (size_t i = 0; i < count; ++i) values[i] += operand[i];
+            break;
+        case Node::Kind::Subtract:
+            for (size_t i = 0; i < count; ++i) values[i] -= operand[i];
+            break;
+        case Node::Kind::Multiply:
+            for (size_t i = 0; i < count; ++i) values[i] *= operand[i];
+            break;
+        case Node::Kind::Divide:
+        case Node::Kind::Modulo:
+            for (size_t i = 0; i < count; ++i) {
+                if (operand[i] == 0) {
+                    throw exceptions::TypeMismatchException(node.kind == Node::Kind::Divide ? "Division by zero." : "Modulo by zero.");
+                }
+            }
+            if (node.kind == Node::Kind::Divide) {
+                for (size_t i = 0; i < count; ++i) values[i] /= operand[i];
+            } else {
+                for (size_t i = 0; i < count; ++i) values[i] %= operand[i];
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+template <Op op>
+bool compare(int32_t left, int32_t right) {
+    if constexpr (op == Op::Less) return left < right;
+    if constexpr (op == Op::LessEqual) return left <= right;
+    if constexpr (op == Op::Greater) return left > right;
+    if constexpr (op == Op::GreaterEqual) return left >= right;
+    if constexpr (op == Op::Equal) return left == right;
+    return left != right;
+}
+
+// Both select kernels compact `selection` in place, keeping entry i when
+// values[i] compares true, and return how many entries were kept.
+template <Op op>
+size_t select_columns(const int32_t* values, const int32_t* other, size_t begin, size_t count, uint32_t* selection,
+                      size_t kept) {
+    for (size_t i = begin; i < count; ++i) {
+        selection[kept] = selection[i];
+        kept += compare<op>(values[i], other[i]);
+    }
+    return kept;
+}
+
+template <Op op>
+size_t select_constant(const int32_t* values, int32_t constant, size_t begin, size_t count, uint32_t* selection,
+                       size_t kept) {
+    for (size_t i = begin; i < count; ++i) {
+        selection[kept] = selection[i];
+        kept += compare<op>(values[i], constant);
+    }
+    return kept;
+}
+
+#ifdef MEMDB_AVX2_KERNELS
+// Compares eight values at a time; the lanes that pass are read off the
+// movemask bits.
+template <Op op>
+__attribute__((target("avx2")))
+size_t select_constant_avx2(const int32_t* values, int32_t constant, size_t count, uint32_t* selection) {
+    const __m256i broadcast = _mm256_set1_epi32(constant);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i result;
+        bool negate = false;
+        if constexpr (op == Op::Less) {
+            result = _mm256_cmpgt_epi32(broadcast, chunk);
+        } else if constexpr (op == Op::LessEqual) {
+            result = _mm256_cmpgt_epi32(chunk, broadcast);
+            negate = true;
+        } else if constexpr (op == Op::Greater) {
+            result = _mm256_cmpgt_epi32(chunk, broadcast);
+        } else if constexpr (op == Op::GreaterEqual) {
+            result = _mm256_cmpgt_epi32(broadcast, chunk);
+            negate = true;
+        } else if constexpr (op == Op::Equal) {
+            result = _mm256_cmpeq_epi32(chunk, broadcast);
+        } else {
+            result = _mm256_cmpeq_epi32(chunk, broadcast);
+            negate = true;
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(result)));
+        if (negate) {
+            mask ^= 0xff;
+        }
+        while (mask != 0) {
+            selection[kept++] = selection[i + __builtin_ctz(mask)];
+            mask &= mask - 1;
+        }
+    }
+    return select_constant<op>(values, constant, i, count, selection, kept);
+}
+
+bool has_avx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+// Two 16-byte chunks per instruction; see chunk_masks().
+__attribute__((target("avx2")))
+size_t chunk_masks_avx2(const uint8_t* packed, size_t chunks, const uint8_t* pattern, size_t stride, uint16_t* masks) {
+    size_t chunk = 0;
+    for (; chunk + 2 <= chunks; chunk += 2) {
+        size_t offset = chunk * 16;
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(packed + offset));
+        __m256i constant = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern + offset % stride));
+        uint32_t equal = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(values, constant)));
+        masks[chunk] = static_cast<uint16_t>(equal);
+        masks[chunk + 1] = static_cast<uint16_t>(equal >> 16);
+    }
+    return chunk;
+}
+#endif
+
+// Sets masks[c] to the bits of the bytes of 16-byte chunk c of `packed` that
+// equal the byte at the same offset of the constant.
+void chunk_masks(const uint8_t* packed, size_t chunks, const uint8_t* pattern, size_t stride, uint16_t* masks) {
+    size_t chunk = 0;
+#ifdef MEMDB_AVX2_KERNELS
+    if (has_avx2()) {
+        chunk = chunk_masks_avx2(packed, chunks, pattern, stride, masks);
+    }
+    for (; chunk < chunks; ++chunk) {
+        size_t offset = chunk * 16;
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + offset));
+        __m128i constant = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + offset % stride));
+        masks[chunk] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(values, constant)));
+    }
+#else
+    for (; chunk < chunks; ++chunk) {
+        size_t offset = chunk * 16;
+        uint16_t mask = 0;
+        for (size_t byte = 0; byte < 16; ++byte) {
+            mask |= static_cast<uint16_t>(packed[offset + byte] == pattern[offset % stride + byte]) << byte;
+        }
+        masks[chunk] = mask;
+    }
+#endif
+}
+
+template <Op op>
+size_t select(const int32_t* values, const Node& right, const std::vector<int32_t>& other, size_t count,
+              uint32_t* selection) {
+    if (right.kind != Node::Kind::Constant) {
+        return select_columns<op>(values, other.data(), 0, count, selection, 0);
+    }
+#ifdef MEMDB_AVX2_KERNELS
+    if (has_avx2()) {
+        return select_constant_avx2<op>(values, right.constant, count, selection);
+    }
+#endif
+    return select_constant<op>(values, right.constant, 0, count, selection, 0);
+}
+
+// `column` op `literal` over a string[N] or bytes[N] column.
+std::shared_ptr<const PackedComparison> compile_packed(const Expression& conjunct, const ExecutionContext& context,
+                                                       const Resolver& resolver) {
+    auto binary = dynamic_cast<const BinaryExpression*>(&conjunct);
+    if (!binary || binary->get_operator() < Op::Less || binary->get_operator() > Op::NotEqual) {
+        return nullptr;
+    }
+    auto variable = dynamic_cast<const VariableExpression*>(binary->get_left());
+    auto literal = dynamic_cast<const LiteralExpression*>(binary->get_right());
+    auto ref = variable ? resolver.find(variable->get_name()) : resolver.end();
+    if (ref == resolver.end() || !literal || !literal->get_value().has_value()) {
+        return nullptr;
+    }
+    Type type = variable->get_type().get_type();
+    if ((type != Type::String && type != Type::Bytes) || literal->get_value().get_type() != type) {
+        return nullptr;
+    }
+
+    const Value& value = literal->get_value();
+    const uint8_t* data = type == Type::String ? reinterpret_cast<const uint8_t*>(value.get_string().data())
+                                               : value.get_bytes().data();
+    size_t length = type == Type::String ? value.get_string().size() : value.get_bytes().size();
+    size_t declared = context.get_table(ref->second.slot).get_columns()[ref->second.column].get_type().get_size();
+
+    auto packed = std::make_shared<PackedComparison>();
+    packed->slot = ref->second.slot;
+    packed->column = ref->second.column;
+    packed->bytes = type == Type::Bytes;
+    packed->name = variable->get_name();
+    packed->stride = std::max<size_t>(16, (std::max(declared, length) + 15) / 16 * 16);
+    packed->pattern.assign(2 * packed->stride, 0);
+    std::copy(data, data + length, packed->pattern.begin());
+    std::copy(data, data + length, packed->pattern.begin() + packed->stride);
+    packed->length = length;
+    return packed;
+}
+
+}
+
+std::optional<BatchPredicate> BatchPredicate::compile(const Expression& conjunct,
+                                                      const ExecutionContext& context,
+                                                      const std::unordered_set<std::string>& hidden) {
+    Resolver resolver;
+    for (size_t slot = 0; slot < context.relation_count(); ++slot) {
+        const auto& names = context.get_names(slot);
+        for (size_t column = 0; column < names.size(); ++column) {
+            if (hidden.count(names[column]) == 0) {
+                resolver.emplace(names[column], ColumnRef{slot, column});
+            }
+        }
+    }
+
+    BatchPredicate predicate;
+    if (auto packed = compile_packed(conjunct, context, resolver)) {
+        predicate.packed_ = std::move(packed);
+        predicate.op_ = dynamic_cast<const BinaryExpression&>(conjunct).get_operator();
+        return predicate;
+    }
+
+    const Expression* operand = &conjunct;
+    auto unary = dynamic_cast<const UnaryExpression*>(operand);
+    bool negated = unary && unary->get_operator() == UnaryExpression::Operator::Not;
+    if (negated) {
+        operand = unary->get_operand();
+    }
+    if (auto variable = dynamic_cast<const VariableExpression*>(operand)) {
+        if (variable->get_type().get_type() != Type::Bool) {
+            return std::nullopt;
+        }
+        predicate.left_ = column_node(*variable, resolver);
+        predicate.right_ = constant_node(0);
+        predicate.op_ = negated ? Op::Equal : Op::NotEqual;
+        return predicate.left_ ? std::optional<BatchPredicate>(std::move(predicate)) : std::nullopt;
+    }
+
+    auto binary = dynamic_cast<const BinaryExpression*>(&conjunct);
+    if (!binary) {
+        return std::nullopt;
+    }
+    switch (binary->get_operator()) {
+        case Op::Less:
+        case Op::LessEqual:
+        case Op::Greater:
+        case Op::GreaterEqual:
+        case Op::Equal:
+        case Op::NotEqual:
+            break;
+        default:
+            return std::nullopt;
+    }
+    Type type = binary->get_left()->get_type().get_type();
+    if (type != Type::Int32 && type != Type::Bool) {
+        return std::nullopt;
+    }
+    predicate.op_ = binary->get_operator();
+    predicate.left_ = compile_operand(*binary->get_left(), type, resolver);
+    predicate.right_ = predicate.left_ ? compile_operand(*binary->get_right(), type, resolver) : nullptr;
+    if (!predicate.right_) {
+        return std::nullopt;
+    }
+    return predicate;
+}
+
+void BatchPredicate::filter(const std::vector<RowTuple>& tuples, std::vector<uint32_t>& selection) const {
+    if (selection.empty()) {
+        return;
+    }
+    if (packed_) {
+        filter_packed(tuples, selection);
+        return;
+    }
+    std::vector<int32_t> values;
+    std::vector<int32_t> other;
+    evaluate(*left_, tuples, selection, values);
+    if (right_->kind != Node::Kind::Constant) {
+        evaluate(*right_, tuples, selection, other);
+    }
+
+    size_t count = selection.size();
+    size_t kept = 0;
+    switch (op_) {
+        case Op::Less: kept = select<Op::Less>(values.data(), *right_, other, count, selection.data()); break;
+        case Op::LessEqual: kept = select<Op::LessEqual>(values.data(), *right_, other, count, selection.data()); break;
+        case Op::Greater: kept = select<Op::Greater>(values.data(), *right_, other, count, selection.data()); break;
+        case Op::GreaterEqual: kept = select<Op::GreaterEqual>(values.data(), *right_, other, count, selection.data()); break;
+        case Op::Equal: kept = select<Op::Equal>(values.data(), *right_, other, count, selection.data()); break;
+        default: kept = select<Op::NotEqual>(values.data(), *right_, other, count, selection.data()); break;
+    }
+    selection.resize(kept);
+}
+
+// Each value is compared like std::string::compare and the byte array
+// operators: by its first byte that differs from the constant, or else by
+// length.
+void BatchPredicate::filter_packed(const std::vector<RowTuple>& tuples, std::vector<uint32_t>& selection) const {
+    const PackedComparison& packed = *packed_;
+    size_t count = selection.size();
+    size_t chunks_per_value = packed.stride / 16;
+    std::vector<uint8_t> values(count * packed.stride, 0);
+    std::vector<uint32_t> lengths(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Value& value = column_value(tuples[selection[i]], packed.slot, packed.column, packed.name);
+        const uint8_t* data = packed.bytes ? value.get_bytes().data() : reinterpret_cast<const uint8_t*>(value.get_string().data());
+        size_t length = packed.bytes ? value.get_bytes().size() : value.get_string().size();
+        if (length > packed.stride) {
+            throw std::length_error("Value of column " + packed.name + " exceeds its declared size.");
+        }
+        std::memcpy(values.data() + i * packed.stride, data, length);
+        lengths[i] = static_cast<uint32_t>(length);
+    }
+
+    std::vector<uint16_t> masks(count * chunks_per_value);
+    chunk_masks(values.data(), masks.size(), packed.pattern.data(), packed.stride, masks.data());
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t first = packed.stride;
+        for (size_t chunk = 0; chunk < chunks_per_value; ++chunk) {
+            uint16_t differs = static_cast<uint16_t>(~masks[i * chunks_per_value + chunk]);
+            if (differs != 0) {
+                first = chunk * 16 + __builtin_ctz(differs);
+                break;
+            }
+        }
+        int order;
+        if (first < std::min<size_t>(lengths[i], packed.length)) {
+            order = static_cast<int>(values[i * packed.stride + first]) - static_cast<int>(packed.pattern[first]);
+        } else {
+            order = static_cast<int>(lengths[i] > packed.length) - static_cast<int>(lengths[i] < packed.length);
+        }
+        bool passes;
+        switch (op_) {
+            case Op::Less: passes = order < 0; break;
+            case Op::LessEqual: passes = order <= 0; break;
+            case Op::Greater: passes = order > 0; break;
+            case Op::GreaterEqual: passes = order >= 0; break;
+            case Op::Equal: passes = order == 0; break;
+            default: passes = order != 0; break;
+        }
+        selection[kept] = selection[i];
+        kept += passes;
+    }
+    selection.resize(kept);
+}
+
+}
+}
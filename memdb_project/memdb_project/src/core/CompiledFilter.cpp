@@ -0,0 +1,250 @@
+#include "memdb/core/CompiledFilter.h"
+
+#include "memdb/core/ExpressionProgram.h"
+
+#include "memdb/core/exceptions/TypeMismatchException.h"
+
+#include <optional>
+#include <unordered_map>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+using Predicate = CompiledFilter::Predicate;
+
+struct ColumnRef {
+    size_t slot;
+    size_t column;
+    std::string name;
+};
+
+using Resolver = std::unordered_map<std::string, ColumnRef>;
+
+template <typename T>
+struct Access;
+
+template <>
+struct Access<int32_t> {
+    static int32_t get(const Value& value) { return value.get_int(); }
+};
+
+template <>
+struct Access<bool> {
+    static bool get(const Value& value) { return value.get_bool(); }
+};
+
+template <>
+struct Access<std::string> {
+    static const std::string& get(const Value& value) { return value.get_string(); }
+};
+
+template <typename T>
+struct ColumnOperand {
+    ColumnRef ref;
+
+    decltype(auto) get(const RowTuple& tuple) const {
+        const Row* row = tuple[ref.slot];
+        // The interpreter leaves NULLs out of its rows, so they raise its error.
+        if (row == nullptr || !row->get_values()[ref.column].has_value() || !row->get_values()[ref.column]->has_value()) {
+            throw exceptions::TypeMismatchException("Column not found: " + ref.name);
+        }
+        return Access<T>::get(*row->get_values()[ref.column]);
+    }
+};
+
+template <typename T>
+struct LiteralOperand {
+    T value;
+
+    const T& get(const RowTuple&) const { return value; }
+};
+
+template <typename Compare, typename Left, typename Right>
+struct CompareKernel {
+    Left left;
+    Right right;
+
+    bool operator()(const RowTuple& tuple) const { return Compare{}(left.get(tuple), right.get(tuple)); }
+};
+
+template <typename Left, typename Right>
+std::optional<Predicate> make_comparison(BinaryExpression::Operator op, Left left, Right right) {
+    switch (op) {
+        case BinaryExpression::Operator::Less:
+            return Predicate(CompareKernel<std::less<>, Left, Right>{left, right});
+        case BinaryExpression::Operator::LessEqual:
+            return Predicate(CompareKernel<std::less_equal<>, Left, Right>{left, right});
+        case BinaryExpression::Operator::Greater:
+            return Predicate(CompareKernel<std::greater<>, Left, Right>{left, right});
+        case BinaryExpression::Operator::GreaterEqual:
+            return Predicate(CompareKernel<std::greater_equal<>, Left, Right>{left, right});
+        case BinaryExpression::Operator::Equal:
+            return Predicate(CompareKernel<std::equal_to<>, Left, Right>{left, right});
+        case BinaryExpression::Operator::NotEqual:
+            return Predicate(CompareKernel<std::not_equal_to<>, Left, Right>{left, right});
+        default:
+            return std::nullopt;
+    }
+}
+
+// "column op literal" or "column op column" over values of type T.
+template <typename T>
+std::optional<Predicate> compile_comparison(BinaryExpression::Operator op, const ColumnRef& left, const Expression& right,
+                                            const Resolver& resolver) {
+    if (auto literal = dynamic_cast<const LiteralExpression*>(&right)) {
+        return make_comparison(op, ColumnOperand<T>{left}, LiteralOperand<T>{Access<T>::get(literal->get_value())});
+    }
+    auto variable = dynamic_cast<const VariableExpression*>(&right);
+    auto ref = variable ? resolver.find(variable->get_name()) : resolver.end();
+    if (ref == resolver.end()) {
+        return std::nullopt;
+    }
+    return make_comparison(op, ColumnOperand<T>{left}, ColumnOperand<T>{ref->second});
+}
+
+std::optional<Predicate> compile_predicate(const Expression& expression, const Resolver& resolver) {
+    if (auto variable = dynamic_cast<const VariableExpression*>(&expression)) {
+        auto ref = resolver.find(variable->get_name());
+        if (ref == resolver.end() || variable->get_type().get_type() != Type::Bool) {
+            return std::nullopt;
+        }
+        ColumnOperand<bool> column{ref->second};
+        return Predicate([column](const RowTuple& tuple) { return column.get(tuple); });
+    }
+
+    if (auto unary = dynamic_cast<const UnaryExpression*>(&expression)) {
+        if (unary->get_operator() != UnaryExpression::Operator::Not) {
+            return std::nullopt;
+        }
+        auto operand = compile_predicate(*unary->get_operand(), resolver);
+        if (!operand) {
+            return std::nullopt;
+        }
+        return Predicate([operand = std::move(*operand)](const RowTuple& tuple) { return !operand(tuple); });
+    }
+
+    auto binary = dynamic_cast<const BinaryExpression*>(&expression);
+    if (!binary) {
+        return std::nullopt;
+    }
+    BinaryExpression::Operator op = binary->get_operator();
+    if (op == BinaryExpression::Operator::And || op == BinaryExpression::Operator::Or) {
+        auto left = compile_predicate(*binary->get_left(), resolver);
+        auto right = left ? compile_predicate(*binary->get_right(), resolver) : std::nullopt;
+        if (!right) {
+            return std::nullopt;
+        }
+        if (op == BinaryExpression::Operator::And) {
+            return Predicate([left = std::move(*left), right = std::move(*right)](const RowTuple& tuple) {
+                return left(tuple) && right(tuple);
+            });
+        }
+        return Predicate([left = std::move(*left), right = std::move(*right)](const RowTuple& tuple) {
+            return left(tuple) || right(tuple);
+        });
+    }
+
+    auto variable = dynamic_cast<const VariableExpression*>(binary->get_left());
+    auto ref = variable ? resolver.find(variable->get_name()) : resolver.end();
+    if (ref == resolver.end() || binary->get_right()->get_type().get_type() != variable->get_type().get_type()) {
+        return std::nullopt;
+    }
+    switch (variable->get_type().get_type()) {
+        case Type::Int32:
+            return compile_comparison<int32_t>(op, ref->second, *binary->get_right(), resolver);
+        case Type::Bool:
+            return compile_comparison<bool>(op, ref->second, *binary->get_right(), resolver);
+        case Type::String:
+            return compile_comparison<std::string>(op, ref->second, *binary->get_right(), resolver);
+        default:
+            return std::nullopt;
+    }
+}
+
+}
+
+CompiledFilter CompiledFilter::compile(const std::vector<const Expression*>& conjuncts,
+                                       const ExecutionContext& context,
+                                       const std::unordered_set<std::string>& hidden,
+                                       const QueryOptions& options,
+                                       std::vector<const Expression*>& rest) {
+    Resolver resolver;
+    for (size_t slot = 0; slot < context.relation_count(); ++slot) {
+        const auto& names = context.get_names(slot);
+        for (size_t column = 0; column < names.size(); ++column) {
+            if (hidden.count(names[column]) == 0) {
+                resolver.emplace(names[column], ColumnRef{slot, column, names[column]});
+            }
+        }
+    }
+
+    CompiledFilter filter;
+    bool interpreted = false;
+    for (const Expression* conjunct : conjuncts) {
+        if (interpreted) {
+            rest.push_back(conjunct);
+            continue;
+        }
+        auto predicate = compile_predicate(*conjunct, resolver);
+        if (!predicate && options.bytecode_filters) {
+            auto program = ExpressionProgram::compile(*conjunct, context, hidden);
+            if (program && program->get_type() == Type::Bool) {
+                predicate = Predicate([program = std::move(*program)](const RowTuple& tuple) { return program.matches(tuple); });
+            }
+        }
+        if (predicate) {
+            std::optional<BatchPredicate> batch;
+            if (options.vectorized_filters) {
+                batch = BatchPredicate::compile(*conjunct, context, hidden);
+            }
+            filter.conjuncts_.push_back(Conjunct{std::move(*predicate), std::move(batch)});
+        } else {
+            rest.push_back(conjunct);
+            interpreted = true;
+        }
+    }
+    return filter;
+}
+
+bool CompiledFilter::matches(const RowTuple& tuple) const {
+    for (const auto& conjunct : conjuncts_) {
+        if (!conjunct.predicate(tuple)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompiledFilter::select(const std::vector<RowTuple>& tuples, size_t begin, size_t end,
+                            std::vector<uint32_t>& selection) const {
+    selection.resize(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        selection[i - begin] = static_cast<uint32_t>(i);
+    }
+    try {
+        for (const auto& conjunct : conjuncts_) {
+            if (conjunct.batch) {
+                conjunct.batch->filter(tuples, selection);
+                continue;
+            }
+            size_t kept = 0;
+            for (uint32_t index : selection) {
+                selection[kept] = index;
+                kept += conjunct.predicate(tuples[index]);
+            }
+            selection.resize(kept);
+        }
+    } catch (const std::exception&) {
+        selection.resize(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            selection[i - begin] = static_cast<uint32_t>(i);
+        }
+        return false;
+    }
+    return true;
+}
+
+}
+}
@@ -0,0 +1,400 @@
+#include "memdb/core/CsvImporter.h"
+
+#include "memdb/core/exceptions/DatabaseException.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw exceptions::SerializationException("Failed to open CSV file: " + path);
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            ::close(fd_);
+            throw exceptions::SerializationException("Failed to stat CSV file: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd_);
+                throw exceptions::SerializationException("Failed to map CSV file: " + path);
+            }
+            ::madvise(data, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(data);
+        }
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+std::string_view strip_line_end(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+bool equals_ignore_case(std::string_view text, std::string_view word) {
+    return text.size() == word.size() && std::equal(text.begin(), text.end(), word.begin(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+}
+
+int hex_digit(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+}
+
+CsvImporter::CsvImporter(Table& table, const CsvImportOptions& options, ThreadPool* pool)
+    : table_(table), options_(options), pool_(pool) {
+    if (options_.chunk_size == 0) {
+        throw std::invalid_argument("CSV chunk size must be greater than zero.");
+    }
+    if (pool_ == nullptr) {
+        ThreadPoolOptions pool_options;
+        pool_options.num_threads = options_.num_threads;
+        own_pool_ = std::make_shared<ThreadPool>(pool_options);
+        pool_ = own_pool_.get();
+    }
+    if (options_.delimiter == options_.quote || options_.delimiter == '\n') {
+        throw std::invalid_argument("Invalid CSV delimiter.");
+    }
+    for (size_t i = 0; i < table_.get_columns().size(); ++i) {
+        field_columns_.push_back(i);
+    }
+}
+
+void CsvImporter::map_header(std::string_view header_line) {
+    std::vector<Field> fields;
+    split_line(strip_line_end(header_line), fields);
+
+    field_columns_.clear();
+    std::vector<bool> seen(table_.get_columns().size(), false);
+    for (const auto& field : fields) {
+        std::string name(field.text);
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        size_t col_index = table_.get_column_index(name);
+        if (seen[col_index]) {
+            throw std::invalid_argument("Duplicate column in CSV header: " + name);
+        }
+        seen[col_index] = true;
+        field_columns_.push_back(col_index);
+    }
+}
+
+void CsvImporter::split_line(std::string_view line, std::vector<Field>& fields) const {
+    fields.clear();
+    size_t pos = 0;
+    while (true) {
+        Field field;
+        if (pos < line.size() && line[pos] == options_.quote) {
+            field.quoted = true;
+            size_t start = ++pos;
+            while (true) {
+                size_t close = line.find(options_.quote, pos);
+                if (close == std::string_view::npos) {
+                    throw std::invalid_argument("Unterminated quoted field.");
+                }
+                if (close + 1 < line.size() && line[close + 1] == options_.quote) {
+                    field.has_escapes = true;
+                    pos = close + 2;
+                    continue;
+                }
+                field.text = line.substr(start, close - start);
+                pos = close + 1;
+                break;
+            }
+            if (pos < line.size() && line[pos] != options_.delimiter) {
+                throw std::invalid_argument("Unexpected character after quoted field.");
+            }
+        }
+        else {
+            size_t end = line.find(options_.delimiter, pos);
+            if (end == std::string_view::npos) {
+                end = line.size();
+            }
+            field.text = line.substr(pos, end - pos);
+            pos = end;
+        }
+        fields.push_back(field);
+
+        if (pos >= line.size()) {
+            break;
+        }
+        ++pos;
+    }
+}
+
+std::optional<Value> CsvImporter::convert_field(const Field& field, const Column& column) const {
+    if (field.text.empty() && !field.quoted) {
+        return std::nullopt;
+    }
+
+    const DataType& type = column.get_type();
+    switch (type.get_type()) {
+        case Type::Int32: {
+            int32_t value = 0;
+            const char* begin = field.text.data();
+            const char* end = begin + field.text.size();
+            if (end - begin > 1 && *begin == '+' && begin[1] != '-') {
+                ++begin;
+            }
+            auto [ptr, ec] = std::from_chars(begin, end, value);
+            if (ec != std::errc() || ptr != end) {
+                throw std::invalid_argument("Invalid int32 value for column \"" + column.get_name() +
+                                            "\": " + std::string(field.text));
+            }
+            return Value(value);
+        }
+        case Type::Bool:
+            if (equals_ignore_case(field.text, "true") || field.text == "1") {
+                return Value(true);
+            }
+            if (equals_ignore_case(field.text, "false") || field.text == "0") {
+                return Value(false);
+            }
+            throw std::invalid_argument("Invalid bool value for column \"" + column.get_name() +
+                                        "\": " + std::string(field.text));
+        case Type::String: {
+            std::string value;
+            if (field.has_escapes) {
+                value.reserve(field.text.size());
+                for (size_t i = 0; i < field.text.size(); ++i) {
+                    value += field.text[i];
+                    if (field.text[i] == options_.quote) {
+                        ++i;
+                    }
+                }
+            }
+            else {
+                value.assign(field.text);
+            }
+            if (value.size() > type.get_size()) {
+                throw std::invalid_argument("Value for column \"" + column.get_name() +
+                                            "\" exceeds maximum length.");
+            }
+            return Value(value);
+        }
+        case Type::Bytes: {
+            std::string_view hex = field.text;
+            if (hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+                hex.remove_prefix(2);
+            }
+            if (hex.size() % 2 != 0) {
+                throw std::invalid_argument("Invalid hex length for bytes column \"" + column.get_name() + "\".");
+            }
+            if (hex.size() / 2 > type.get_size()) {
+                throw std::invalid_argument("Value for column \"" + column.get_name() +
+                                            "\" exceeds maximum byte size.");
+            }
+            std::vector<uint8_t> bytes;
+            bytes.reserve(hex.size() / 2);
+            for (size_t i = 0; i < hex.size(); i += 2) {
+                int high = hex_digit(hex[i]);
+                int low = hex_digit(hex[i + 1]);
+                if (high < 0 || low < 0) {
+                    throw std::invalid_argument("Invalid hex digit for bytes column \"" + column.get_name() + "\".");
+                }
+                bytes.push_back(static_cast<uint8_t>((high << 4) | low));
+            }
+            return Value(bytes);
+        }
+        default:
+            throw std::invalid_argument("Unsupported column type for CSV import: " + type.to_string());
+    }
+}
+
+CsvImporter::ParsedChunk CsvImporter::parse_chunk(std::string_view chunk) const {
+    const auto& columns = table_.get_columns();
+
+    ParsedChunk parsed;
+    parsed.columns.resize(columns.size());
+    size_t estimated_rows = chunk.size() / 16 + 1;
+    for (auto& buffer : parsed.columns) {
+        buffer.reserve(estimated_rows);
+    }
+
+    std::vector<Field> fields;
+    std::vector<std::optional<Value>> row(columns.size());
+    size_t pos = 0;
+    while (pos < chunk.size()) {
+        size_t end = chunk.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = chunk.size();
+        }
+        std::string_view line = strip_line_end(chunk.substr(pos, end - pos));
+        size_t line_number = parsed.line_count++;
+        pos = end + 1;
+
+        if (line.empty()) {
+            continue;
+        }
+
+        try {
+            split_line(line, fields);
+            if (fields.size() > field_columns_.size()) {
+                throw std::invalid_argument("Too many fields: expected at most " +
+                                            std::to_string(field_columns_.size()) + ", got " +
+                                            std::to_string(fields.size()) + ".");
+            }
+            std::fill(row.begin(), row.end(), std::nullopt);
+            for (size_t i = 0; i < fields.size(); ++i) {
+                size_t col_index = field_columns_[i];
+                row[col_index] = convert_field(fields[i], columns[col_index]);
+            }
+        }
+        catch (const std::exception& e) {
+            parsed.errors.push_back(CsvImportError{line_number, e.what()});
+            continue;
+        }
+
+        for (size_t i = 0; i < columns.size(); ++i) {
+            parsed.columns[i].emplace_back(std::move(row[i]));
+        }
+        parsed.row_lines.push_back(line_number);
+    }
+
+    return parsed;
+}
+
+void CsvImporter::append_chunk(ParsedChunk& chunk, size_t first_line, CsvImportResult& result) {
+    for (const auto& error : chunk.errors) {
+        if (options_.stop_on_error) {
+            throw std::invalid_argument("CSV line " + std::to_string(first_line + error.line) + ": " + error.message);
+        }
+        result.errors.push_back(CsvImportError{first_line + error.line, error.message});
+        result.rows_rejected++;
+    }
+
+    const size_t column_count = chunk.columns.size();
+    std::vector<std::vector<std::optional<Value>>> rows(chunk.row_lines.size());
+    for (size_t r = 0; r < rows.size(); ++r) {
+        rows[r].reserve(column_count);
+        for (size_t c = 0; c < column_count; ++c) {
+            rows[r].emplace_back(std::move(chunk.columns[c][r]));
+        }
+    }
+    chunk.columns.clear();
+
+    try {
+        table_.insert_rows(rows);
+        result.rows_imported += rows.size();
+        return;
+    }
+    catch (const std::invalid_argument& e) {
+        if (options_.stop_on_error) {
+            throw;
+        }
+    }
+
+    // The batch was rejected as a whole; retry row by row to isolate the
+    // offenders. insert_row probes the table's unique value counts, so the
+    // retry costs time in the chunk size only.
+    for (size_t r = 0; r < rows.size(); ++r) {
+        try {
+            table_.insert_row(rows[r]);
+            result.rows_imported++;
+        }
+        catch (const std::invalid_argument& e) {
+            result.errors.push_back(CsvImportError{first_line + chunk.row_lines[r], e.what()});
+            result.rows_rejected++;
+        }
+    }
+}
+
+CsvImportResult CsvImporter::import_file(const std::string& path) {
+    MappedFile file(path);
+    std::string_view data = file.view();
+    CsvImportResult result;
+
+    size_t body_start = 0;
+    size_t first_line = 1;
+    if (options_.has_header && !data.empty()) {
+        size_t header_end = data.find('\n');
+        map_header(data.substr(0, header_end));
+        body_start = (header_end == std::string_view::npos) ? data.size() : header_end + 1;
+        first_line = 2;
+    }
+
+    std::vector<std::string_view> chunks;
+    for (size_t begin = body_start; begin < data.size();) {
+        size_t end = std::min(begin + options_.chunk_size, data.size());
+        if (end < data.size()) {
+            size_t newline = data.find('\n', end - 1);
+            end = (newline == std::string_view::npos) ? data.size() : newline + 1;
+        }
+        chunks.push_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+
+    size_t num_threads = options_.num_threads;
+    if (num_threads == 0) {
+        num_threads = pool_->size();
+    }
+
+    size_t bytes_processed = body_start;
+    for (size_t wave_start = 0; wave_start < chunks.size(); wave_start += num_threads) {
+        size_t wave_end = std::min(wave_start + num_threads, chunks.size());
+        std::vector<ParsedChunk> parsed(wave_end - wave_start);
+
+        pool_->run(wave_end - wave_start, [&](size_t i) {
+            parsed[i] = parse_chunk(chunks[wave_start + i]);
+        }, num_threads);
+
+        for (size_t i = wave_start; i < wave_end; ++i) {
+            ParsedChunk& chunk = parsed[i - wave_start];
+            append_chunk(chunk, first_line, result);
+            first_line += chunk.line_count;
+            bytes_processed += chunks[i].size();
+            if (options_.on_progress) {
+                options_.on_progress(result.rows_imported, bytes_processed, data.size());
+            }
+        }
+    }
+
+    std::stable_sort(result.errors.begin(), result.errors.end(),
+                     [](const CsvImportError& a, const CsvImportError& b) { return a.line < b.line; });
+    return result;
+}
+
+}
+}
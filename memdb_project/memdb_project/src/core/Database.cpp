@@ -1,4 +1,6 @@
 #include "memdb/core/Database.h"
+#include "memdb/core/CsvImporter.h"
+#include "memdb/core/Exporter.h"
 
 #include "memdb/core/exceptions/DatabaseException.h"
 
@@ -10,7 +12,10 @@ namespace core {
 
 using json = nlohmann::json;
 
-Database::Database() = default;
+Database::Database(const ThreadPoolOptions& thread_pool_options)
+    : thread_pool_(std::make_unique<ThreadPool>(thread_pool_options)) {
+    parser_.set_database(this);
+}
 
 void Database::create_table(const std::string& table_name, const std::vector<Column>& columns) {
     if (has_table(table_name)) {
@@ -93,6 +98,11 @@ RowID Database::insert_row(const std::string& table_name, const std::vector<std:
     return table->insert_row(values);
 }
 
+std::vector<RowID> Database::insert_rows(const std::string& table_name, const std::vector<std::vector<std::optional<Value>>>& rows) {
+    auto table = get_table(table_name);
+    return table->insert_rows(rows);
+}
+
 void Database::delete_row(const std::string& table_name, core::RowID row_id) {
     auto table = get_table(table_name);
     table->delete_row(row_id);
@@ -113,10 +123,19 @@ const std::unordered_map<std::string, std::shared_ptr<Table>>& Database::get_all
 }
 
 void Database::save_to_file(const std::string& filename) const {
+    std::vector<const Table*> tables;
+    for (const auto& [name, table] : tables_) {
+        tables.push_back(table.get());
+    }
+    std::vector<json> table_jsons(tables.size());
+    thread_pool_->run(tables.size(), [&](size_t i) {
+        table_jsons[i] = tables[i]->to_json();
+    });
+
     json j;
     j["tables"] = json::array();
-    for (const auto& [name, table] : tables_) {
-        j["tables"].push_back(table->to_json());
+    for (auto& table_json : table_jsons) {
+        j["tables"].push_back(std::move(table_json));
     }
     std::ofstream ofs(filename, std::ios::binary);
     if (!ofs) {
@@ -135,16 +154,38 @@ void Database::load_from_file(const std::string& filename) {
     if (!j.contains("tables")) {
         throw exceptions::SerializationException("Invalid database file format.");
     }
-    for (const auto& table_json : j["tables"]) {
-        Table table = Table::from_json(table_json);
-        auto table_ptr = std::make_shared<Table>(std::move(table));
+    const json& table_jsons = j["tables"];
+    std::vector<std::shared_ptr<Table>> tables(table_jsons.size());
+    thread_pool_->run(tables.size(), [&](size_t i) {
+        tables[i] = std::make_shared<Table>(Table::from_json(table_jsons[i]));
+    });
+    for (auto& table_ptr : tables) {
         tables_.emplace(table_ptr->get_name(), table_ptr);
     }
 }
 
+CsvImportResult Database::import_csv(const std::string& table_name, const std::string& path,
+                                     const CsvImportOptions& options) {
+    auto table = get_table(table_name);
+    CsvImporter importer(*table, options, thread_pool_.get());
+    return importer.import_file(path);
+}
+
+void Database::export_csv(const std::string& table_name, const std::string& path,
+                          const ExportOptions& options) const {
+    auto table = get_table(table_name);
+    Exporter(options, thread_pool_.get()).write_csv(*table, path);
+}
+
+void Database::export_columnar(const std::string& table_name, const std::string& path,
+                               const ExportOptions& options) const {
+    auto table = get_table(table_name);
+    Exporter(options, thread_pool_.get()).write_columnar(*table, path);
+}
+
 void Database::create_index(const std::string& table_name, const std::string& index_type, const std::vector<std::string>& columns) {
     auto table = get_table(table_name);
-    table->add_index(index_type, columns);
+    table->add_index(index_type, columns, thread_pool_.get());
 }
 
 std::string Database::to_string() const {
@@ -155,10 +196,18 @@ std::string Database::to_string() const {
     return db_str;
 }
 
-QueryResult Database::execute(const std::string& query) {
+QueryCursor Database::open_cursor(const std::string& query, const QueryOptions& options) {
+    ParsedQuery parsed_query = parser_.parse(query);
+    if (parsed_query.type != ParsedQuery::QueryType::Select) {
+        throw std::invalid_argument("Only SELECT queries can be opened as a cursor.");
+    }
+    return executor_.open_select(parsed_query, *this, options);
+}
+
+QueryResult Database::execute(const std::string& query, const QueryOptions& options) {
     try {
         auto parsed_query = parser_.parse(query);
-        return executor_.execute(parsed_query, *this);
+        return executor_.execute(parsed_query, *this, options);
     }
     catch (const std::invalid_argument& e) {
         return QueryResult(e.what());
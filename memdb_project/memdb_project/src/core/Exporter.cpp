@@ -0,0 +1,566 @@
+#include "memdb/core/Exporter.h"
+
+#include "memdb/core/exceptions/DatabaseException.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+const char kColumnarMagic[] = "MDBCOL01";
+const size_t kColumnarMagicSize = 8;
+
+void put_u8(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void put_u16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void put_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void put_u64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+class ByteReader {
+public:
+    ByteReader(const std::string& data) : data_(data), pos_(0) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(take(1)[0]); }
+
+    uint16_t u16() {
+        const char* p = take(2);
+        return static_cast<uint16_t>(static_cast<uint8_t>(p[0]) | (static_cast<uint8_t>(p[1]) << 8));
+    }
+
+    uint32_t u32() {
+        const char* p = take(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t u64() {
+        const char* p = take(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    const char* take(size_t n) {
+        if (pos_ + n > data_.size()) {
+            throw exceptions::SerializationException("Truncated columnar file.");
+        }
+        const char* p = data_.data() + pos_;
+        pos_ += n;
+        return p;
+    }
+
+    size_t remaining() const { return data_.size() - pos_; }
+
+private:
+    const std::string& data_;
+    size_t pos_;
+};
+
+// The smallest encoding of `rows` values of `type`: the validity bitmap plus
+// the fixed-width values, or the offsets of variable-width ones.
+uint64_t min_chunk_length(Type type, uint64_t rows) {
+    uint64_t validity = (rows + 7) / 8;
+    switch (type) {
+        case Type::Int32: return validity + rows * 4;
+        case Type::Bool: return validity + rows;
+        case Type::String:
+        case Type::Bytes: return validity + (rows + 1) * 4;
+        default: throw exceptions::SerializationException("Unknown column type in columnar file.");
+    }
+}
+
+std::string bytes_to_hex(const std::vector<uint8_t>& bytes) {
+    static const char hex_chars[] = "0123456789ABCDEF";
+    std::string hex_str = "0x";
+    hex_str.reserve(2 + bytes.size() * 2);
+    for (uint8_t byte : bytes) {
+        hex_str += hex_chars[(byte >> 4) & 0xF];
+        hex_str += hex_chars[byte & 0xF];
+    }
+    return hex_str;
+}
+
+}
+
+Exporter::Exporter(const ExportOptions& options, ThreadPool* pool) : options_(options), pool_(pool) {
+    if (options_.rows_per_chunk == 0) {
+        throw std::invalid_argument("Export chunk size must be greater than zero.");
+    }
+    if (pool_ == nullptr) {
+        ThreadPoolOptions pool_options;
+        pool_options.num_threads = options_.num_threads;
+        own_pool_ = std::make_shared<ThreadPool>(pool_options);
+        pool_ = own_pool_.get();
+    }
+}
+
+size_t Exporter::thread_count() const {
+    if (options_.num_threads == 0) {
+        return pool_->size();
+    }
+    return options_.num_threads;
+}
+
+Exporter::RowSource Exporter::table_source(const Table& table, size_t rows_per_chunk) {
+    auto it = std::make_shared<std::map<RowID, Row>::const_iterator>(table.get_all_rows().begin());
+    const auto* rows = &table.get_all_rows();
+    return [it, rows, rows_per_chunk](RowChunk& chunk) {
+        chunk.clear();
+        while (*it != rows->end() && chunk.size() < rows_per_chunk) {
+            chunk.push_back(&(*it)->second.get_values());
+            ++(*it);
+        }
+        return !chunk.empty();
+    };
+}
+
+Exporter::RowSource Exporter::result_source(const QueryResult& result, size_t rows_per_chunk) {
+    auto next = std::make_shared<size_t>(0);
+    const auto* data = &result.get_data();
+    return [next, data, rows_per_chunk](RowChunk& chunk) {
+        chunk.clear();
+        while (*next < data->size() && chunk.size() < rows_per_chunk) {
+            chunk.push_back(&(*data)[(*next)++]);
+        }
+        return !chunk.empty();
+    };
+}
+
+std::vector<ColumnInfo> Exporter::table_columns(const Table& table) {
+    std::vector<ColumnInfo> columns;
+    for (const auto& column : table.get_columns()) {
+        columns.emplace_back(column.get_name(), column.get_type());
+    }
+    return columns;
+}
+
+std::vector<ColumnInfo> Exporter::result_columns(const QueryResult& result) {
+    if (!result.is_ok()) {
+        throw std::invalid_argument("Cannot export a failed query result: " + result.get_error());
+    }
+
+    std::vector<ColumnInfo> columns = result.get_columns();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        Type type = columns[i].get_type();
+        bool sized = (type == Type::String || type == Type::Bytes);
+        if (type != Type::Unknown && (!sized || columns[i].type.get_size() > 0)) {
+            continue;
+        }
+
+        size_t max_size = 1;
+        for (const auto& row : result.get_data()) {
+            if (i >= row.size() || !row[i].has_value()) {
+                continue;
+            }
+            if (type == Type::Unknown) {
+                type = row[i]->get_type();
+            }
+            if (row[i]->get_type() != type) {
+                throw std::invalid_argument("Column \"" + columns[i].get_name() + "\" mixes value types.");
+            }
+            if (type == Type::String) {
+                max_size = std::max(max_size, row[i]->get_string().size());
+            } else if (type == Type::Bytes) {
+                max_size = std::max(max_size, row[i]->get_bytes().size());
+            }
+        }
+
+        if (type == Type::String || type == Type::Bytes) {
+            columns[i].type = DataType(type, max_size);
+        } else {
+            columns[i].type = DataType(type == Type::Unknown ? Type::Int32 : type);
+        }
+    }
+    return columns;
+}
+
+void Exporter::append_csv_field(std::string& out, const std::string& text, bool force_quotes) const {
+    bool needs_quotes = force_quotes ||
+        text.find_first_of(std::string{options_.delimiter, options_.quote, '\n', '\r'}) != std::string::npos;
+    if (!needs_quotes) {
+        out += text;
+        return;
+    }
+
+    out += options_.quote;
+    for (char ch : text) {
+        out += ch;
+        if (ch == options_.quote) {
+            out += ch;
+        }
+    }
+    out += options_.quote;
+}
+
+void Exporter::append_csv_row(std::string& out, const std::vector<std::optional<Value>>& row, size_t column_count) const {
+    for (size_t i = 0; i < column_count; ++i) {
+        if (i > 0) {
+            out += options_.delimiter;
+        }
+        if (i >= row.size() || !row[i].has_value()) {
+            continue;
+        }
+
+        const Value& value = *row[i];
+        switch (value.get_type()) {
+            case Type::Int32:
+                out += std::to_string(value.get_int());
+                break;
+            case Type::Bool:
+                out += value.get_bool() ? "true" : "false";
+                break;
+            case Type::String:
+                append_csv_field(out, value.get_string(), value.get_string().empty());
+                break;
+            case Type::Bytes:
+                out += bytes_to_hex(value.get_bytes());
+                break;
+            default:
+                break;
+        }
+    }
+    out += '\n';
+}
+
+void Exporter::write_csv(const Table& table, const std::string& path) const {
+    write_csv(table_columns(table), table_source(table, options_.rows_per_chunk), path);
+}
+
+void Exporter::write_csv(const QueryResult& result, const std::string& path) const {
+    write_csv(result_columns(result), result_source(result, options_.rows_per_chunk), path);
+}
+
+void Exporter::write_csv(const std::vector<ColumnInfo>& columns, const RowSource& source, const std::string& path) const {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        throw exceptions::SerializationException("Failed to open file for export: " + path);
+    }
+
+    if (options_.write_header) {
+        std::string header;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i > 0) {
+                header += options_.delimiter;
+            }
+            append_csv_field(header, columns[i].get_name(), false);
+        }
+        header += '\n';
+        ofs.write(header.data(), header.size());
+    }
+
+    const size_t wave_size = thread_count();
+    std::vector<RowChunk> chunks(wave_size);
+    std::vector<std::string> buffers(wave_size);
+    bool more = true;
+    while (more) {
+        size_t filled = 0;
+        while (filled < wave_size && (more = source(chunks[filled]))) {
+            filled++;
+        }
+
+        pool_->run(filled, [&](size_t i) {
+            buffers[i].clear();
+            buffers[i].reserve(std::min(options_.buffer_size, chunks[i].size() * 16 * columns.size()));
+            for (const auto* row : chunks[i]) {
+                append_csv_row(buffers[i], *row, columns.size());
+            }
+        }, wave_size);
+
+        for (size_t i = 0; i < filled; ++i) {
+            ofs.write(buffers[i].data(), buffers[i].size());
+        }
+    }
+
+    if (!ofs) {
+        throw exceptions::SerializationException("Failed to write export file: " + path);
+    }
+}
+
+std::string Exporter::encode_column_chunk(const RowChunk& rows, size_t column, Type type) {
+    const size_t count = rows.size();
+    std::string out;
+    out.resize((count + 7) / 8, '\0');
+    for (size_t r = 0; r < count; ++r) {
+        const auto& row = *rows[r];
+        if (column < row.size() && row[column].has_value()) {
+            out[r / 8] = static_cast<char>(out[r / 8] | (1 << (r % 8)));
+        }
+    }
+
+    auto value_at = [&](size_t r) -> const Value* {
+        const auto& row = *rows[r];
+        return (column < row.size() && row[column].has_value()) ? &*row[column] : nullptr;
+    };
+
+    switch (type) {
+        case Type::Int32:
+            out.reserve(out.size() + count * 4);
+            for (size_t r = 0; r < count; ++r) {
+                const Value* value = value_at(r);
+                put_u32(out, value ? static_cast<uint32_t>(value->get_int()) : 0);
+            }
+            break;
+        case Type::Bool:
+            out.reserve(out.size() + count);
+            for (size_t r = 0; r < count; ++r) {
+                const Value* value = value_at(r);
+                put_u8(out, (value && value->get_bool()) ? 1 : 0);
+            }
+            break;
+        case Type::String:
+        case Type::Bytes: {
+            std::string data;
+            out.reserve(out.size() + (count + 1) * 4);
+            put_u32(out, 0);
+            for (size_t r = 0; r < count; ++r) {
+                const Value* value = value_at(r);
+                if (value && type == Type::String) {
+                    data += value->get_string();
+                } else if (value) {
+                    const auto& bytes = value->get_bytes();
+                    data.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+                }
+                put_u32(out, static_cast<uint32_t>(data.size()));
+            }
+            out += data;
+            break;
+        }
+        default:
+            throw std::invalid_argument("Unsupported column type for columnar export.");
+    }
+    return out;
+}
+
+void Exporter::write_columnar(const Table& table, const std::string& path) const {
+    write_columnar(table_columns(table), table_source(table, options_.rows_per_chunk), path);
+}
+
+void Exporter::write_columnar(const QueryResult& result, const std::string& path) const {
+    write_columnar(result_columns(result), result_source(result, options_.rows_per_chunk), path);
+}
+
+void Exporter::write_columnar(const std::vector<ColumnInfo>& columns, const RowSource& source, const std::string& path) const {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        throw exceptions::SerializationException("Failed to open file for export: " + path);
+    }
+    ofs.write(kColumnarMagic, kColumnarMagicSize);
+    uint64_t offset = kColumnarMagicSize;
+
+    struct ChunkLocation {
+        uint64_t offset;
+        uint64_t length;
+    };
+    std::vector<uint32_t> group_rows;
+    std::vector<std::vector<ChunkLocation>> group_chunks;
+    uint64_t total_rows = 0;
+
+    RowChunk rows;
+    std::vector<std::string> encoded(columns.size());
+    while (source(rows)) {
+        pool_->run(columns.size(), [&](size_t c) {
+            encoded[c] = encode_column_chunk(rows, c, columns[c].get_type());
+        }, thread_count());
+
+        std::vector<ChunkLocation> locations;
+        locations.reserve(columns.size());
+        for (auto& chunk : encoded) {
+            ofs.write(chunk.data(), chunk.size());
+            locations.push_back(ChunkLocation{offset, chunk.size()});
+            offset += chunk.size();
+            std::string().swap(chunk);
+        }
+        group_rows.push_back(static_cast<uint32_t>(rows.size()));
+        group_chunks.push_back(std::move(locations));
+        total_rows += rows.size();
+    }
+
+    std::string footer;
+    put_u32(footer, static_cast<uint32_t>(columns.size()));
+    for (const auto& column : columns) {
+        put_u16(footer, static_cast<uint16_t>(column.get_name().size()));
+        footer += column.get_name();
+        put_u8(footer, static_cast<uint8_t>(column.get_type()));
+        bool sized = column.type.is_string() || column.type.is_bytes();
+        put_u32(footer, sized ? static_cast<uint32_t>(column.type.get_size()) : 0);
+    }
+    put_u64(footer, total_rows);
+    put_u32(footer, static_cast<uint32_t>(group_rows.size()));
+    for (size_t g = 0; g < group_rows.size(); ++g) {
+        put_u32(footer, group_rows[g]);
+        for (const auto& location : group_chunks[g]) {
+            put_u64(footer, location.offset);
+            put_u64(footer, location.length);
+        }
+    }
+    put_u64(footer, offset);
+    footer.append(kColumnarMagic, kColumnarMagicSize);
+    ofs.write(footer.data(), footer.size());
+
+    if (!ofs) {
+        throw exceptions::SerializationException("Failed to write export file: " + path);
+    }
+}
+
+QueryResult Exporter::read_columnar(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs) {
+        throw exceptions::SerializationException("Failed to open columnar file: " + path);
+    }
+    std::string contents(static_cast<size_t>(ifs.tellg()), '\0');
+    ifs.seekg(0);
+    ifs.read(&contents[0], contents.size());
+
+    const size_t trailer_size = 8 + kColumnarMagicSize;
+    if (contents.size() < kColumnarMagicSize + trailer_size ||
+        contents.compare(0, kColumnarMagicSize, kColumnarMagic) != 0 ||
+        contents.compare(contents.size() - kColumnarMagicSize, kColumnarMagicSize, kColumnarMagic) != 0) {
+        throw exceptions::SerializationException("Invalid columnar file format.");
+    }
+
+    std::string trailer = contents.substr(contents.size() - trailer_size, 8);
+    uint64_t footer_offset = ByteReader(trailer).u64();
+    if (footer_offset > contents.size() - trailer_size) {
+        throw exceptions::SerializationException("Invalid columnar footer offset.");
+    }
+    std::string footer = contents.substr(footer_offset, contents.size() - trailer_size - footer_offset);
+    ByteReader reader(footer);
+
+    std::vector<ColumnInfo> columns;
+    uint32_t column_count = reader.u32();
+    for (uint32_t c = 0; c < column_count; ++c) {
+        uint16_t name_size = reader.u16();
+        std::string name(reader.take(name_size), name_size);
+        Type type = static_cast<Type>(reader.u8());
+        uint32_t size = reader.u32();
+        if (type == Type::String || type == Type::Bytes) {
+            columns.emplace_back(name, DataType(type, size));
+        } else {
+            columns.emplace_back(name, DataType(type));
+        }
+    }
+
+    struct ChunkLocation {
+        uint64_t offset;
+        uint64_t length;
+    };
+    struct Group {
+        uint32_t rows;
+        std::vector<ChunkLocation> chunks;
+    };
+
+    // Check every count and location against the file before allocating for it.
+    uint64_t total_rows = reader.u64();
+    uint32_t group_count = reader.u32();
+    if (group_count > reader.remaining() / (4 + 16 * static_cast<uint64_t>(column_count))) {
+        throw exceptions::SerializationException("Truncated columnar file.");
+    }
+    std::vector<Group> groups(group_count);
+    uint64_t counted_rows = 0;
+    uint64_t chunk_end = kColumnarMagicSize;
+    for (auto& group : groups) {
+        group.rows = reader.u32();
+        if (column_count == 0 && group.rows > 0) {
+            throw exceptions::SerializationException("Invalid columnar row count.");
+        }
+        counted_rows += group.rows;
+        group.chunks.resize(column_count);
+        for (uint32_t c = 0; c < column_count; ++c) {
+            ChunkLocation& chunk = group.chunks[c];
+            chunk.offset = reader.u64();
+            chunk.length = reader.u64();
+            // Chunks are written back to back, so none may overlap another.
+            if (chunk.offset < chunk_end || chunk.offset > footer_offset || chunk.length > footer_offset - chunk.offset ||
+                chunk.length < min_chunk_length(columns[c].get_type(), group.rows)) {
+                throw exceptions::SerializationException("Invalid columnar chunk location.");
+            }
+            chunk_end = chunk.offset + chunk.length;
+        }
+    }
+    if (reader.remaining() != 0) {
+        throw exceptions::SerializationException("Invalid columnar footer size.");
+    }
+    if (counted_rows != total_rows) {
+        throw exceptions::SerializationException("Invalid columnar row count.");
+    }
+
+    std::vector<std::vector<std::optional<Value>>> data;
+    data.reserve(total_rows);
+    for (const auto& group : groups) {
+        uint32_t rows = group.rows;
+        size_t first_row = data.size();
+        data.resize(first_row + rows, std::vector<std::optional<Value>>(column_count));
+
+        for (uint32_t c = 0; c < column_count; ++c) {
+            std::string chunk = contents.substr(group.chunks[c].offset, group.chunks[c].length);
+            ByteReader chunk_reader(chunk);
+            const char* validity = chunk_reader.take((rows + 7) / 8);
+            auto is_valid = [&](size_t r) { return (validity[r / 8] >> (r % 8)) & 1; };
+
+            Type type = columns[c].get_type();
+            if (type == Type::Int32) {
+                for (uint32_t r = 0; r < rows; ++r) {
+                    int32_t value = static_cast<int32_t>(chunk_reader.u32());
+                    if (is_valid(r)) data[first_row + r][c] = Value(value);
+                }
+            } else if (type == Type::Bool) {
+                for (uint32_t r = 0; r < rows; ++r) {
+                    bool value = chunk_reader.u8() != 0;
+                    if (is_valid(r)) data[first_row + r][c] = Value(value);
+                }
+            } else if (type == Type::String || type == Type::Bytes) {
+                std::vector<uint32_t> offsets(rows + 1);
+                for (size_t r = 0; r < offsets.size(); ++r) {
+                    offsets[r] = chunk_reader.u32();
+                    if (r > 0 && offsets[r] < offsets[r - 1]) {
+                        throw exceptions::SerializationException("Invalid columnar value offsets.");
+                    }
+                }
+                const char* values = chunk_reader.take(offsets.back());
+                for (uint32_t r = 0; r < rows; ++r) {
+                    if (!is_valid(r)) continue;
+                    const char* begin = values + offsets[r];
+                    size_t length = offsets[r + 1] - offsets[r];
+                    if (type == Type::String) {
+                        data[first_row + r][c] = Value(std::string(begin, length));
+                    } else {
+                        data[first_row + r][c] = Value(std::vector<uint8_t>(begin, begin + length));
+                    }
+                }
+            } else {
+                throw exceptions::SerializationException("Unknown column type in columnar file.");
+            }
+            if (chunk_reader.remaining() != 0) {
+                throw exceptions::SerializationException("Invalid columnar chunk location.");
+            }
+        }
+    }
+
+    return QueryResult(data, columns);
+}
+
+}
+}
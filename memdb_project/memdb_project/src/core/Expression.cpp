@@ -3,6 +3,9 @@
 
 #include <stdexcept>
 #include <cmath>
+#include <functional>
+#include <optional>
+#include <vector>
 
 namespace memdb {
 namespace core {
@@ -38,6 +41,80 @@ int compare_values(const Value& left_val, const Value& right_val) {
     }
 }
 
+namespace {
+
+// Shared subtree values of the rows being evaluated on this thread; the
+// current scope owns the slots from `cache_base` on.
+thread_local std::vector<std::optional<Value>> cache_values;
+thread_local size_t cache_base = 0;
+
+template <typename Compute>
+Value evaluate_shared(size_t slot, const Compute& compute) {
+    if (const Value* cached = SubexpressionCache::find(slot)) {
+        return *cached;
+    }
+    Value value = compute();
+    SubexpressionCache::store(slot, value);
+    return value;
+}
+
+// Evaluators for operands whose types were checked by bind().
+Value add_int(const Value& left, const Value& right) {
+    return Value(left.get_int() + right.get_int());
+}
+
+Value add_string(const Value& left, const Value& right) {
+    return Value(left.get_string() + right.get_string());
+}
+
+Value subtract_int(const Value& left, const Value& right) {
+    return Value(left.get_int() - right.get_int());
+}
+
+Value multiply_int(const Value& left, const Value& right) {
+    return Value(left.get_int() * right.get_int());
+}
+
+Value divide_int(const Value& left, const Value& right) {
+    if (right.get_int() == 0) throw exceptions::TypeMismatchException("Division by zero.");
+    return Value(left.get_int() / right.get_int());
+}
+
+Value modulo_int(const Value& left, const Value& right) {
+    if (right.get_int() == 0) throw exceptions::TypeMismatchException("Modulo by zero.");
+    return Value(left.get_int() % right.get_int());
+}
+
+Value xor_bool(const Value& left, const Value& right) {
+    return Value(static_cast<bool>(left.get_bool() ^ right.get_bool()));
+}
+
+template <typename Compare>
+Value compare_int(const Value& left, const Value& right) {
+    return Value(Compare{}(left.get_int(), right.get_int()));
+}
+
+template <typename Compare>
+Value compare_string(const Value& left, const Value& right) {
+    return Value(Compare{}(left.get_string().compare(right.get_string()), 0));
+}
+
+template <typename Compare>
+Value compare_other(const Value& left, const Value& right) {
+    return Value(Compare{}(compare_values(left, right), 0));
+}
+
+template <typename Compare>
+Value (*comparison_kernel(Type type))(const Value&, const Value&) {
+    switch (type) {
+        case Type::Int32: return &compare_int<Compare>;
+        case Type::String: return &compare_string<Compare>;
+        default: return &compare_other<Compare>;
+    }
+}
+
+}
+
 LiteralExpression::LiteralExpression(const Value& value) : value_(value) {}
 
 Value LiteralExpression::evaluate(const std::unordered_map<std::string, Value>& row) const {
@@ -48,6 +125,10 @@ DataType LiteralExpression::get_type() const {
     return value_.get_type();
 }
 
+DataType LiteralExpression::bind(const std::unordered_map<std::string, DataType>&) const {
+    return get_type();
+}
+
 std::string LiteralExpression::to_string() const {
     return value_.to_string();
 }
@@ -66,17 +147,60 @@ Value VariableExpression::evaluate(const std::unordered_map<std::string, Value>&
 }
 
 DataType VariableExpression::get_type() const {
-    return Type::Unknown;
+    return type_;
+}
+
+DataType VariableExpression::bind(const std::unordered_map<std::string, DataType>& schema) const {
+    auto it = schema.find(name_);
+    if (it == schema.end()) {
+        throw exceptions::TypeMismatchException("Column not found: " + name_);
+    }
+    type_ = it->second;
+    return type_;
 }
 
 std::string VariableExpression::to_string() const {
     return name_;
 }
 
+const size_t Expression::kNotShared;
+
+SubexpressionCache::Scope::Scope(size_t slots) : previous_base_(cache_base) {
+    cache_base = cache_values.size();
+    cache_values.resize(cache_base + slots);
+}
+
+SubexpressionCache::Scope::~Scope() {
+    cache_values.resize(cache_base);
+    cache_base = previous_base_;
+}
+
+const Value* SubexpressionCache::find(size_t slot) {
+    size_t index = cache_base + slot;
+    if (index >= cache_values.size() || !cache_values[index].has_value()) {
+        return nullptr;
+    }
+    return &*cache_values[index];
+}
+
+void SubexpressionCache::store(size_t slot, const Value& value) {
+    size_t index = cache_base + slot;
+    if (index < cache_values.size()) {
+        cache_values[index] = value;
+    }
+}
+
 UnaryExpression::UnaryExpression(Operator op, std::unique_ptr<Expression> operand)
     : op_(op), operand_(std::move(operand)) {}
 
 Value UnaryExpression::evaluate(const std::unordered_map<std::string, Value>& row) const {
+    if (shared_slot_ == kNotShared) {
+        return compute(row);
+    }
+    return evaluate_shared(shared_slot_, [&] { return compute(row); });
+}
+
+Value UnaryExpression::compute(const std::unordered_map<std::string, Value>& row) const {
     Value val = operand_->evaluate(row);
     switch (op_) {
         case Operator::Not:
@@ -108,6 +232,19 @@ DataType UnaryExpression::get_type() const {
     }
 }
 
+DataType UnaryExpression::bind(const std::unordered_map<std::string, DataType>& schema) const {
+    Type operand = operand_->bind(schema).get_type();
+    if (operand != Type::Unknown) {
+        if (op_ == Operator::Not && operand != Type::Bool) {
+            throw exceptions::TypeMismatchException("Operator '!' requires Bool type.");
+        }
+        if (op_ == Operator::Length && operand != Type::String && operand != Type::Bytes) {
+            throw exceptions::TypeMismatchException("Operator '|var|' requires String or Bytes type.");
+        }
+    }
+    return get_type();
+}
+
 std::string UnaryExpression::to_string() const {
     switch (op_) {
         case Operator::Not:
@@ -123,7 +260,36 @@ BinaryExpression::BinaryExpression(Operator op, std::unique_ptr<Expression> left
     : op_(op), left_(std::move(left)), right_(std::move(right)) {}
 
 Value BinaryExpression::evaluate(const std::unordered_map<std::string, Value>& row) const {
+    if (shared_slot_ == kNotShared) {
+        return compute(row);
+    }
+    return evaluate_shared(shared_slot_, [&] { return compute(row); });
+}
+
+Value BinaryExpression::compute(const std::unordered_map<std::string, Value>& row) const {
     Value left_val = left_->evaluate(row);
+    if (kernel_ != nullptr) {
+        return kernel_(left_val, right_->evaluate(row));
+    }
+
+    // The right operand of '&&' and '||' is only evaluated when the left one
+    // does not decide the result, so it may rely on the left one holding.
+    if (op_ == Operator::And || op_ == Operator::Or) {
+        const char* message = op_ == Operator::And ? "Operator '&&' requires Bool types."
+                                                   : "Operator '||' requires Bool types.";
+        if (!bound_ && left_val.get_type() != Type::Bool) {
+            throw exceptions::TypeMismatchException(message);
+        }
+        if (left_val.get_bool() == (op_ == Operator::Or)) {
+            return left_val;
+        }
+        Value right_val = right_->evaluate(row);
+        if (!bound_ && right_val.get_type() != Type::Bool) {
+            throw exceptions::TypeMismatchException(message);
+        }
+        return right_val;
+    }
+
     Value right_val = right_->evaluate(row);
 
     switch (op_) {
@@ -198,18 +364,6 @@ Value BinaryExpression::evaluate(const std::unordered_map<std::string, Value>& r
             }
             return Value(compare_values(left_val, right_val) != 0);
 
-        case Operator::And:
-            if (left_val.get_type() != Type::Bool || right_val.get_type() != Type::Bool) {
-                throw exceptions::TypeMismatchException("Operator '&&' requires Bool types.");
-            }
-            return Value(left_val.get_bool() && right_val.get_bool());
-
-        case Operator::Or:
-            if (left_val.get_type() != Type::Bool || right_val.get_type() != Type::Bool) {
-                throw exceptions::TypeMismatchException("Operator '||' requires Bool types.");
-            }
-            return Value(left_val.get_bool() || right_val.get_bool());
-
         case Operator::Xor:
             if (left_val.get_type() != Type::Bool || right_val.get_type() != Type::Bool) {
                 throw exceptions::TypeMismatchException("Operator '^^' requires Bool types.");
@@ -221,7 +375,80 @@ Value BinaryExpression::evaluate(const std::unordered_map<std::string, Value>& r
     }
 }
 
+DataType BinaryExpression::bind(const std::unordered_map<std::string, DataType>& schema) const {
+    Type left = left_->bind(schema).get_type();
+    Type right = right_->bind(schema).get_type();
+    if (left == Type::Unknown || right == Type::Unknown) {
+        return get_type();
+    }
+
+    auto require = [&](bool valid, Type result, Kernel kernel, const std::string& message) {
+        if (!valid) {
+            throw exceptions::TypeMismatchException(message);
+        }
+        type_ = result;
+        kernel_ = kernel;
+        bound_ = true;
+    };
+    bool ints = left == Type::Int32 && right == Type::Int32;
+    bool bools = left == Type::Bool && right == Type::Bool;
+    switch (op_) {
+        case Operator::Add:
+            if (left == Type::String && right == Type::String) {
+                require(true, Type::String, &add_string, "");
+            } else {
+                require(ints, Type::Int32, &add_int, "Operator '+' not supported for given types.");
+            }
+            break;
+        case Operator::Subtract:
+            require(ints, Type::Int32, &subtract_int, "Operator '-' requires numeric types.");
+            break;
+        case Operator::Multiply:
+            require(ints, Type::Int32, &multiply_int, "Operator '*' requires numeric types.");
+            break;
+        case Operator::Divide:
+            require(ints, Type::Int32, &divide_int, "Operator '/' requires numeric types.");
+            break;
+        case Operator::Modulo:
+            require(ints, Type::Int32, &modulo_int, "Operator '%' requires integer types.");
+            break;
+        case Operator::Less:
+            require(left == right, Type::Bool, comparison_kernel<std::less<int>>(left), "Comparison requires operands of the same type.");
+            break;
+        case Operator::LessEqual:
+            require(left == right, Type::Bool, comparison_kernel<std::less_equal<int>>(left), "Comparison requires operands of the same type.");
+            break;
+        case Operator::Greater:
+            require(left == right, Type::Bool, comparison_kernel<std::greater<int>>(left), "Comparison requires operands of the same type.");
+            break;
+        case Operator::GreaterEqual:
+            require(left == right, Type::Bool, comparison_kernel<std::greater_equal<int>>(left), "Comparison requires operands of the same type.");
+            break;
+        case Operator::Equal:
+            require(left == right, Type::Bool, comparison_kernel<std::equal_to<int>>(left), "Equality comparison requires operands of the same type.");
+            break;
+        case Operator::NotEqual:
+            require(left == right, Type::Bool, comparison_kernel<std::not_equal_to<int>>(left), "Inequality comparison requires operands of the same type.");
+            break;
+        case Operator::And:
+            require(bools, Type::Bool, nullptr, "Operator '&&' requires Bool types.");
+            break;
+        case Operator::Or:
+            require(bools, Type::Bool, nullptr, "Operator '||' requires Bool types.");
+            break;
+        case Operator::Xor:
+            require(bools, Type::Bool, &xor_bool, "Operator '^^' requires Bool types.");
+            break;
+        default:
+            break;
+    }
+    return get_type();
+}
+
 DataType BinaryExpression::get_type() const {
+    if (bound_) {
+        return type_;
+    }
     switch (op_) {
         case Operator::Add:
         case Operator::Subtract:
@@ -266,5 +493,50 @@ std::string BinaryExpression::to_string() const {
     return "(" + left_->to_string() + " " + op_str + " " + right_->to_string() + ")";
 }
 
+AggregateExpression::AggregateExpression(Function function, std::unique_ptr<Expression> argument)
+    : function_(function), argument_(std::move(argument)) {}
+
+Value AggregateExpression::evaluate(const std::unordered_map<std::string, Value>& row) const {
+    auto it = row.find(to_string());
+    if (it == row.end()) {
+        throw exceptions::TypeMismatchException("NULL value for aggregate: " + to_string());
+    }
+    return it->second;
+}
+
+DataType AggregateExpression::bind(const std::unordered_map<std::string, DataType>& schema) const {
+    if (argument_) {
+        Type argument = argument_->bind(schema).get_type();
+        bool summed = function_ == Function::Sum || function_ == Function::Avg;
+        if (summed && argument != Type::Int32 && argument != Type::Unknown) {
+            throw exceptions::TypeMismatchException(to_string() + " requires an int32 argument.");
+        }
+    }
+    return get_type();
+}
+
+DataType AggregateExpression::get_type() const {
+    switch (function_) {
+        case Function::Count:
+        case Function::Sum:
+        case Function::Avg:
+            return Type::Int32;
+        default:
+            return argument_->get_type();
+    }
+}
+
+std::string AggregateExpression::to_string() const {
+    std::string argument = argument_ ? argument_->to_string() : "*";
+    switch (function_) {
+        case Function::Count: return "count(" + argument + ")";
+        case Function::Sum: return "sum(" + argument + ")";
+        case Function::Min: return "min(" + argument + ")";
+        case Function::Max: return "max(" + argument + ")";
+        case Function::Avg: return "avg(" + argument + ")";
+        default: return "unknown_aggregate(" + argument + ")";
+    }
+}
+
 } 
 } 
\ No newline at end of file
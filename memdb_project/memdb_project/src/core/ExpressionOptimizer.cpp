@@ -0,0 +1,202 @@
+#include "memdb/core/ExpressionOptimizer.h"
+
+#include "memdb/core/QueryPlanner.h"
+
+#include <algorithm>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+using Op = BinaryExpression::Operator;
+
+std::unique_ptr<Expression> make_literal(const Value& value) {
+    return std::make_unique<LiteralExpression>(value);
+}
+
+bool is_literal(const Expression& expression) {
+    return dynamic_cast<const LiteralExpression*>(&expression) != nullptr;
+}
+
+bool is_bool_literal(const Expression& expression, bool value) {
+    auto literal = dynamic_cast<const LiteralExpression*>(&expression);
+    return literal && literal->get_value().has_value() && literal->get_value().get_type() == Type::Bool &&
+           literal->get_value().get_bool() == value;
+}
+
+// Only subtrees known to produce a Bool may replace a boolean operator;
+// otherwise the operator's type error would be lost.
+bool is_boolean(const Expression& expression) {
+    return expression.get_type().get_type() == Type::Bool;
+}
+
+bool is_comparison(Op op) {
+    return op == Op::Less || op == Op::LessEqual || op == Op::Greater || op == Op::GreaterEqual ||
+           op == Op::Equal || op == Op::NotEqual;
+}
+
+Op negate_comparison(Op op) {
+    switch (op) {
+        case Op::Less: return Op::GreaterEqual;
+        case Op::LessEqual: return Op::Greater;
+        case Op::Greater: return Op::LessEqual;
+        case Op::GreaterEqual: return Op::Less;
+        case Op::Equal: return Op::NotEqual;
+        default: return Op::Equal;
+    }
+}
+
+// Replaces a subtree of literals by its value, unless evaluating it fails.
+std::unique_ptr<Expression> fold(std::unique_ptr<Expression> expression) {
+    try {
+        return make_literal(expression->evaluate({}));
+    } catch (const std::exception&) {
+        return expression;
+    }
+}
+
+std::unique_ptr<Expression> simplify_unary(const UnaryExpression& unary) {
+    auto operand = ExpressionOptimizer::simplify(*unary.get_operand());
+    if (is_literal(*operand)) {
+        return fold(std::make_unique<UnaryExpression>(unary.get_operator(), std::move(operand)));
+    }
+    if (unary.get_operator() == UnaryExpression::Operator::Not) {
+        if (auto inner = dynamic_cast<const UnaryExpression*>(operand.get())) {
+            if (inner->get_operator() == UnaryExpression::Operator::Not && is_boolean(*inner->get_operand())) {
+                return ExpressionOptimizer::clone(*inner->get_operand());
+            }
+        }
+        if (auto comparison = dynamic_cast<const BinaryExpression*>(operand.get())) {
+            if (is_comparison(comparison->get_operator())) {
+                return std::make_unique<BinaryExpression>(negate_comparison(comparison->get_operator()),
+                                                          ExpressionOptimizer::clone(*comparison->get_left()),
+                                                          ExpressionOptimizer::clone(*comparison->get_right()));
+            }
+        }
+    }
+    return std::make_unique<UnaryExpression>(unary.get_operator(), std::move(operand));
+}
+
+std::unique_ptr<Expression> simplify_binary(const BinaryExpression& binary) {
+    Op op = binary.get_operator();
+    auto left = ExpressionOptimizer::simplify(*binary.get_left());
+    auto right = ExpressionOptimizer::simplify(*binary.get_right());
+
+    if (op == Op::And || op == Op::Or) {
+        // `absorbing` decides the result on its own, `neutral` leaves it to
+        // the other operand.
+        bool absorbing = op == Op::Or;
+        if (is_bool_literal(*left, absorbing)) {
+            return left;
+        }
+        if (is_bool_literal(*left, !absorbing) && is_boolean(*right)) {
+            return right;
+        }
+        if (is_bool_literal(*right, !absorbing) && is_boolean(*left)) {
+            return left;
+        }
+        // The left operand is evaluated first, so it is only dropped when
+        // it cannot raise an error.
+        if (is_bool_literal(*right, absorbing) && is_boolean(*left) && !QueryPlanner::may_raise(left.get())) {
+            return right;
+        }
+    }
+
+    if (is_literal(*left) && is_literal(*right)) {
+        return fold(std::make_unique<BinaryExpression>(op, std::move(left), std::move(right)));
+    }
+    if (is_comparison(op) && is_literal(*left)) {
+        return std::make_unique<BinaryExpression>(QueryPlanner::mirror_comparison(op), std::move(right), std::move(left));
+    }
+
+    return std::make_unique<BinaryExpression>(op, std::move(left), std::move(right));
+}
+
+}
+
+std::unique_ptr<Expression> ExpressionOptimizer::clone(const Expression& expression) {
+    if (auto literal = dynamic_cast<const LiteralExpression*>(&expression)) {
+        return make_literal(literal->get_value());
+    }
+    if (auto variable = dynamic_cast<const VariableExpression*>(&expression)) {
+        return std::make_unique<VariableExpression>(variable->get_name());
+    }
+    if (auto unary = dynamic_cast<const UnaryExpression*>(&expression)) {
+        return std::make_unique<UnaryExpression>(unary->get_operator(), clone(*unary->get_operand()));
+    }
+    if (auto binary = dynamic_cast<const BinaryExpression*>(&expression)) {
+        return std::make_unique<BinaryExpression>(binary->get_operator(), clone(*binary->get_left()), clone(*binary->get_right()));
+    }
+    auto aggregate = dynamic_cast<const AggregateExpression*>(&expression);
+    return std::make_unique<AggregateExpression>(aggregate->get_function(),
+                                                 aggregate->get_argument() ? clone(*aggregate->get_argument()) : nullptr);
+}
+
+std::unique_ptr<Expression> ExpressionOptimizer::simplify(const Expression& expression) {
+    if (auto unary = dynamic_cast<const UnaryExpression*>(&expression)) {
+        return simplify_unary(*unary);
+    }
+    if (auto binary = dynamic_cast<const BinaryExpression*>(&expression)) {
+        return simplify_binary(*binary);
+    }
+    if (auto aggregate = dynamic_cast<const AggregateExpression*>(&expression)) {
+        return std::make_unique<AggregateExpression>(aggregate->get_function(),
+                                                     aggregate->get_argument() ? simplify(*aggregate->get_argument()) : nullptr);
+    }
+    return clone(expression);
+}
+
+bool ExpressionOptimizer::is_false(const Expression* expression) {
+    return expression != nullptr && is_bool_literal(*expression, false);
+}
+
+// True when the conjuncts include `false`, pin a column to an empty range,
+// or require a column to both equal and differ from the same literal.
+bool ExpressionOptimizer::is_contradiction(const std::vector<const Expression*>& conjuncts) {
+    std::vector<std::string> qualifiers;
+    std::vector<std::pair<const VariableExpression*, const Value*>> equal;
+    std::vector<std::pair<const VariableExpression*, const Value*>> not_equal;
+    for (const Expression* conjunct : conjuncts) {
+        if (is_false(conjunct)) {
+            return true;
+        }
+        auto binary = dynamic_cast<const BinaryExpression*>(conjunct);
+        if (!binary) {
+            continue;
+        }
+        auto variable = dynamic_cast<const VariableExpression*>(binary->get_left());
+        auto literal = dynamic_cast<const LiteralExpression*>(binary->get_right());
+        if (!variable || !literal || !literal->get_value().has_value()) {
+            continue;
+        }
+        std::string qualifier = QueryPlanner::column_qualifier(variable->get_name());
+        if (std::find(qualifiers.begin(), qualifiers.end(), qualifier) == qualifiers.end()) {
+            qualifiers.push_back(qualifier);
+        }
+        if (binary->get_operator() == Op::Equal) {
+            equal.emplace_back(variable, &literal->get_value());
+        } else if (binary->get_operator() == Op::NotEqual) {
+            not_equal.emplace_back(variable, &literal->get_value());
+        }
+    }
+
+    for (const auto& qualifier : qualifiers) {
+        for (const auto& range : QueryPlanner::literal_ranges(conjuncts, qualifier)) {
+            if (range.is_empty()) {
+                return true;
+            }
+        }
+    }
+    for (const auto& [variable, value] : not_equal) {
+        for (const auto& [other, other_value] : equal) {
+            if (variable->get_name() == other->get_name() && *value == *other_value) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}
+}
@@ -1,6 +1,7 @@
 #include "memdb/core/ExpressionParser.h"
 #include "memdb/core/exceptions/TypeMismatchException.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <limits>
 #include <numeric>
@@ -209,11 +210,41 @@ std::unique_ptr<Expression> ExpressionParser::parse_primary() {
     if (match(TokenType::Identifier)) {
         std::string name = current_token_.value;
         advance();
+        if (match(TokenType::LeftParen)) {
+            return parse_aggregate(name);
+        }
         return std::make_unique<VariableExpression>(name);
     }
 
     throw exceptions::TypeMismatchException("Unexpected token in expression.");
 }
 
+std::unique_ptr<Expression> ExpressionParser::parse_aggregate(const std::string& name) {
+    static const std::unordered_map<std::string, AggregateExpression::Function> functions = {
+        {"count", AggregateExpression::Function::Count},
+        {"sum", AggregateExpression::Function::Sum},
+        {"min", AggregateExpression::Function::Min},
+        {"max", AggregateExpression::Function::Max},
+        {"avg", AggregateExpression::Function::Avg}
+    };
+
+    std::string lower_name = name;
+    std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
+    auto function = functions.find(lower_name);
+    if (function == functions.end()) {
+        throw exceptions::TypeMismatchException("Unknown function: " + name);
+    }
+    advance();
+
+    std::unique_ptr<Expression> argument;
+    if (function->second == AggregateExpression::Function::Count && match(TokenType::Operator, "*")) {
+        advance();
+    } else {
+        argument = parse_logical_or();
+    }
+    consume(TokenType::RightParen, "Expected ')' after function argument.");
+    return std::make_unique<AggregateExpression>(function->second, std::move(argument));
+}
+
 }
 }
\ No newline at end of file
@@ -0,0 +1,793 @@
+#include "memdb/core/ExpressionProgram.h"
+
+#include "memdb/core/exceptions/DatabaseException.h"
+#include "memdb/core/exceptions/TypeMismatchException.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MEMDB_COMPUTED_GOTO 1
+#endif
+
+namespace memdb {
+namespace core {
+
+using OpCode = ExpressionProgram::OpCode;
+
+namespace {
+
+const char* const kMnemonics[] = {
+    "load.int", "load.bool", "load.string", "load.bytes", "load.imm", "load.const.string", "load.const.bytes", "move",
+    "add.int", "sub.int", "mul.int", "div.int", "mod.int", "concat", "len.string", "len.bytes", "not", "xor",
+    "lt.int", "le.int", "gt.int", "ge.int", "eq.int", "ne.int",
+    "lt.string", "le.string", "gt.string", "ge.string", "eq.string", "ne.string",
+    "lt.bytes", "le.bytes", "gt.bytes", "ge.bytes", "eq.bytes", "ne.bytes",
+    "jump.false", "jump.true", "ret"
+};
+static_assert(sizeof(kMnemonics) / sizeof(kMnemonics[0]) == static_cast<size_t>(OpCode::Return) + 1,
+              "every opcode needs a mnemonic");
+
+// The comparison opcodes of each type, in the order Less, LessEqual, Greater,
+// GreaterEqual, Equal, NotEqual.
+OpCode comparison_opcode(BinaryExpression::Operator op, Type type) {
+    OpCode first = type == Type::String ? OpCode::LessString : type == Type::Bytes ? OpCode::LessBytes : OpCode::LessInt;
+    size_t offset = static_cast<size_t>(op) - static_cast<size_t>(BinaryExpression::Operator::Less);
+    return static_cast<OpCode>(static_cast<size_t>(first) + offset);
+}
+
+const char kProgramMagic[] = "MDBPRG01";
+const size_t kProgramMagicSize = 8;
+
+void put_u8(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void put_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void put_bytes(std::string& out, const char* data, size_t size) {
+    put_u32(out, static_cast<uint32_t>(size));
+    out.append(data, size);
+}
+
+class ProgramReader {
+public:
+    explicit ProgramReader(const std::string& data) : data_(data), pos_(0) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(take(1)[0]); }
+
+    uint32_t u32() {
+        const char* p = take(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    std::string bytes() {
+        uint32_t size = u32();
+        return std::string(take(size), size);
+    }
+
+    // A count of items that each take at least `item_size` more bytes.
+    uint32_t count(size_t item_size) {
+        uint32_t n = u32();
+        if (n > (data_.size() - pos_) / item_size) {
+            throw exceptions::SerializationException("Truncated expression program.");
+        }
+        return n;
+    }
+
+    const char* take(size_t n) {
+        if (n > data_.size() - pos_) {
+            throw exceptions::SerializationException("Truncated expression program.");
+        }
+        const char* p = data_.data() + pos_;
+        pos_ += n;
+        return p;
+    }
+
+    bool at_end() const { return pos_ == data_.size(); }
+
+private:
+    const std::string& data_;
+    size_t pos_;
+};
+
+// What a register holds, as far as reading it safely is concerned: Int32
+// and Bool share `scalar`.
+enum class Kind : uint8_t { None, Scalar, String, Bytes };
+
+Kind kind_of(Type type) {
+    switch (type) {
+        case Type::Int32:
+        case Type::Bool: return Kind::Scalar;
+        case Type::String: return Kind::String;
+        case Type::Bytes: return Kind::Bytes;
+        default: return Kind::None;
+    }
+}
+
+const Value& column_value(const RowTuple& tuple, size_t slot, size_t column, const std::string& name) {
+    const Row* row = tuple[slot];
+    // The interpreter leaves NULLs out of its rows, so they raise its error.
+    if (row == nullptr || !row->get_values()[column].has_value() || !row->get_values()[column]->has_value()) {
+        throw exceptions::TypeMismatchException("Column not found: " + name);
+    }
+    return *row->get_values()[column];
+}
+
+}
+
+// Int32 and Bool values live in `scalar`; strings and byte arrays are
+// pointers into the tuple, the constant pool or the per-thread scratch
+// strings of Concat.
+struct ExpressionProgram::Register {
+    int32_t scalar = 0;
+    const std::string* string = nullptr;
+    const std::vector<uint8_t>* bytes = nullptr;
+};
+
+class ExpressionProgram::Compiler {
+public:
+    Compiler(ExpressionProgram& program, const ExecutionContext& context, const std::unordered_set<std::string>& hidden)
+        : program_(program) {
+        for (size_t slot = 0; slot < context.relation_count(); ++slot) {
+            const auto& names = context.get_names(slot);
+            for (size_t column = 0; column < names.size(); ++column) {
+                if (hidden.count(names[column]) == 0) {
+                    resolver_.emplace(names[column], ColumnSlot{slot, column, names[column]});
+                }
+            }
+        }
+    }
+
+    // Emits the code of `expression` and returns the register holding its
+    // value, or nothing when part of it cannot be compiled.
+    std::optional<uint32_t> emit(const Expression& expression) {
+        if (auto literal = dynamic_cast<const LiteralExpression*>(&expression)) {
+            return emit_literal(literal->get_value());
+        }
+        if (auto variable = dynamic_cast<const VariableExpression*>(&expression)) {
+            return emit_column(*variable);
+        }
+        if (auto unary = dynamic_cast<const UnaryExpression*>(&expression)) {
+            return emit_unary(*unary);
+        }
+        if (auto binary = dynamic_cast<const BinaryExpression*>(&expression)) {
+            return emit_binary(*binary);
+        }
+        return std::nullopt;
+    }
+
+    Type type_of(uint32_t reg) const { return types_[reg]; }
+
+    void emit_return(uint32_t reg) {
+        program_.code_.push_back(Instruction{OpCode::Return, 0, reg, 0});
+        program_.register_count_ = types_.size();
+        program_.type_ = types_[reg];
+    }
+
+private:
+    uint32_t allocate(Type type) {
+        types_.push_back(type);
+        return static_cast<uint32_t>(types_.size() - 1);
+    }
+
+    uint32_t push(OpCode op, Type type, uint32_t a = 0, uint32_t b = 0) {
+        uint32_t dst = allocate(type);
+        program_.code_.push_back(Instruction{op, dst, a, b});
+        return dst;
+    }
+
+    std::optional<uint32_t> emit_literal(const Value& value) {
+        if (!value.has_value()) {
+            return std::nullopt;
+        }
+        switch (value.get_type()) {
+            case Type::Int32:
+                return push(OpCode::LoadImmediate, Type::Int32, static_cast<uint32_t>(value.get_int()));
+            case Type::Bool:
+                return push(OpCode::LoadImmediate, Type::Bool, value.get_bool() ? 1 : 0);
+            case Type::String:
+                program_.constants_.push_back(value);
+                return push(OpCode::LoadConstString, Type::String, static_cast<uint32_t>(program_.constants_.size() - 1));
+            case Type::Bytes:
+                program_.constants_.push_back(value);
+                return push(OpCode::LoadConstBytes, Type::Bytes, static_cast<uint32_t>(program_.constants_.size() - 1));
+            default:
+                return std::nullopt;
+        }
+    }
+
+    std::optional<uint32_t> emit_column(const VariableExpression& variable) {
+        auto column = resolver_.find(variable.get_name());
+        if (column == resolver_.end()) {
+            return std::nullopt;
+        }
+        OpCode op;
+        Type type = variable.get_type().get_type();
+        switch (type) {
+            case Type::Int32: op = OpCode::LoadInt; break;
+            case Type::Bool: op = OpCode::LoadBool; break;
+            case Type::String: op = OpCode::LoadString; break;
+            case Type::Bytes: op = OpCode::LoadBytes; break;
+            default: return std::nullopt;
+        }
+        program_.columns_.push_back(column->second);
+        return push(op, type, static_cast<uint32_t>(program_.columns_.size() - 1));
+    }
+
+    std::optional<uint32_t> emit_unary(const UnaryExpression& unary) {
+        auto operand = emit(*unary.get_operand());
+        if (!operand) {
+            return std::nullopt;
+        }
+        Type type = types_[*operand];
+        if (unary.get_operator() == UnaryExpression::Operator::Not && type == Type::Bool) {
+            return push(OpCode::Not, Type::Bool, *operand);
+        }
+        if (unary.get_operator() == UnaryExpression::Operator::Length && (type == Type::String || type == Type::Bytes)) {
+            return push(type == Type::String ? OpCode::LengthString : OpCode::LengthBytes, Type::Int32, *operand);
+        }
+        return std::nullopt;
+    }
+
+    std::optional<uint32_t> emit_binary(const BinaryExpression& binary) {
+        BinaryExpression::Operator op = binary.get_operator();
+        if (op == BinaryExpression::Operator::And || op == BinaryExpression::Operator::Or) {
+            return emit_logical(binary);
+        }
+
+        auto left = emit(*binary.get_left());
+        auto right = left ? emit(*binary.get_right()) : std::nullopt;
+        if (!right) {
+            return std::nullopt;
+        }
+        Type left_type = types_[*left];
+        Type right_type = types_[*right];
+        bool ints = left_type == Type::Int32 && right_type == Type::Int32;
+
+        switch (op) {
+            case BinaryExpression::Operator::Add:
+                if (left_type == Type::String && right_type == Type::String) {
+                    return push(OpCode::Concat, Type::String, *left, *right);
+                }
+                return ints ? std::optional<uint32_t>(push(OpCode::AddInt, Type::Int32, *left, *right)) : std::nullopt;
+            case BinaryExpression::Operator::Subtract:
+                return ints ? std::optional<uint32_t>(push(OpCode::SubtractInt, Type::Int32, *left, *right)) : std::nullopt;
+            case BinaryExpression::Operator::Multiply:
+                return ints ? std::optional<uint32_t>(push(OpCode::MultiplyInt, Type::Int32, *left, *right)) : std::nullopt;
+            case BinaryExpression::Operator::Divide:
+                return ints ? std::optional<uint32_t>(push(OpCode::DivideInt, Type::Int32, *left, *right)) : std::nullopt;
+            case BinaryExpression::Operator::Modulo:
+                return ints ? std::optional<uint32_t>(push(OpCode::ModuloInt, Type::Int32, *left, *right)) : std::nullopt;
+            case BinaryExpression::Operator::Xor:
+                if (left_type != Type::Bool || right_type != Type::Bool) {
+                    return std::nullopt;
+                }
+                return push(OpCode::Xor, Type::Bool, *left, *right);
+            case BinaryExpression::Operator::Less:
+            case BinaryExpression::Operator::LessEqual:
+            case BinaryExpression::Operator::Greater:
+            case BinaryExpression::Operator::GreaterEqual:
+            case BinaryExpression::Operator::Equal:
+            case BinaryExpression::Operator::NotEqual:
+                if (left_type != right_type) {
+                    return std::nullopt;
+                }
+                return push(comparison_opcode(op, left_type), Type::Bool, *left, *right);
+            default:
+                return std::nullopt;
+        }
+    }
+
+    // left; dst = left; jump over the right operand when dst decides the
+    // result; right; dst = right.
+    std::optional<uint32_t> emit_logical(const BinaryExpression& binary) {
+        auto left = emit(*binary.get_left());
+        if (!left || types_[*left] != Type::Bool) {
+            return std::nullopt;
+        }
+        uint32_t dst = push(OpCode::Move, Type::Bool, *left);
+        OpCode jump = binary.get_operator() == BinaryExpression::Operator::And ? OpCode::JumpIfFalse : OpCode::JumpIfTrue;
+        size_t jump_at = program_.code_.size();
+        program_.code_.push_back(Instruction{jump, 0, dst, 0});
+
+        auto right = emit(*binary.get_right());
+        if (!right || types_[*right] != Type::Bool) {
+            return std::nullopt;
+        }
+        program_.code_.push_back(Instruction{OpCode::Move, dst, *right, 0});
+        program_.code_[jump_at].b = static_cast<uint32_t>(program_.code_.size());
+        return dst;
+    }
+
+    ExpressionProgram& program_;
+    std::unordered_map<std::string, ColumnSlot> resolver_;
+    std::vector<Type> types_;
+};
+
+std::optional<ExpressionProgram> ExpressionProgram::compile(const Expression& expression,
+                                                            const ExecutionContext& context,
+                                                            const std::unordered_set<std::string>& hidden) {
+    ExpressionProgram program;
+    Compiler compiler(program, context, hidden);
+    auto result = compiler.emit(expression);
+    if (!result) {
+        return std::nullopt;
+    }
+    compiler.emit_return(*result);
+    return program;
+}
+
+const ExpressionProgram::Register& ExpressionProgram::run(const RowTuple& tuple) const {
+    thread_local std::vector<Register> registers;
+    thread_local std::vector<std::string> strings;
+    if (registers.size() < register_count_) {
+        registers.resize(register_count_);
+        strings.resize(register_count_);
+    }
+    Register* r = registers.data();
+    const Instruction* code = code_.data();
+    const Instruction* pc = code;
+
+#ifdef MEMDB_COMPUTED_GOTO
+    static const void* const labels[] = {
+        &&LoadInt, &&LoadBool, &&LoadString, &&LoadBytes, &&LoadImmediate, &&LoadConstString, &&LoadConstBytes, &&Move,
+        &&AddInt, &&SubtractInt, &&MultiplyInt, &&DivideInt, &&ModuloInt, &&Concat, &&LengthString, &&LengthBytes, &&Not, &&Xor,
+        &&LessInt, &&LessEqualInt, &&GreaterInt, &&GreaterEqualInt, &&EqualInt, &&NotEqualInt,
+        &&LessString, &&LessEqualString, &&GreaterString, &&GreaterEqualString, &&EqualString, &&NotEqualString,
+        &&LessBytes, &&LessEqualBytes, &&GreaterBytes, &&GreaterEqualBytes, &&EqualBytes, &&NotEqualBytes,
+        &&JumpIfFalse, &&JumpIfTrue, &&Return
+    };
+#define VM_CASE(name) name:
+#define VM_DISPATCH() goto *labels[static_cast<size_t>(pc->op)]
+#define VM_NEXT() do { ++pc; VM_DISPATCH(); } while (false)
+    VM_DISPATCH();
+#else
+#define VM_CASE(name) case OpCode::name:
+#define VM_DISPATCH() continue
+#define VM_NEXT() do { ++pc; continue; } while (false)
+    for (;;) {
+    switch (pc->op) {
+#endif
+
+    VM_CASE(LoadInt) {
+        const ColumnSlot& column = columns_[pc->a];
+        r[pc->dst].scalar = column_value(tuple, column.slot, column.column, column.name).get_int();
+        VM_NEXT();
+    }
+    VM_CASE(LoadBool) {
+        const ColumnSlot& column = columns_[pc->a];
+        r[pc->dst].scalar = column_value(tuple, column.slot, column.column, column.name).get_bool();
+        VM_NEXT();
+    }
+    VM_CASE(LoadString) {
+        const ColumnSlot& column = columns_[pc->a];
+        r[pc->dst].string = &column_value(tuple, column.slot, column.column, column.name).get_string();
+        VM_NEXT();
+    }
+    VM_CASE(LoadBytes) {
+        const ColumnSlot& column = columns_[pc->a];
+        r[pc->dst].bytes = &column_value(tuple, column.slot, column.column, column.name).get_bytes();
+        VM_NEXT();
+    }
+    VM_CASE(LoadImmediate) {
+        r[pc->dst].scalar = static_cast<int32_t>(pc->a);
+        VM_NEXT();
+    }
+    VM_CASE(LoadConstString) {
+        r[pc->dst].string = &constants_[pc->a].get_string();
+        VM_NEXT();
+    }
+    VM_CASE(LoadConstBytes) {
+        r[pc->dst].bytes = &constants_[pc->a].get_bytes();
+        VM_NEXT();
+    }
+    VM_CASE(Move) {
+        r[pc->dst] = r[pc->a];
+        VM_NEXT();
+    }
+    VM_CASE(AddInt) {
+        r[pc->dst].scalar = r[pc->a].scalar + r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(SubtractInt) {
+        r[pc->dst].scalar = r[pc->a].scalar - r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(MultiplyInt) {
+        r[pc->dst].scalar = r[pc->a].scalar * r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(DivideInt) {
+        if (r[pc->b].scalar == 0) throw exceptions::TypeMismatchException("Division by zero.");
+        r[pc->dst].scalar = r[pc->a].scalar / r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(ModuloInt) {
+        if (r[pc->b].scalar == 0) throw exceptions::TypeMismatchException("Modulo by zero.");
+        r[pc->dst].scalar = r[pc->a].scalar % r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(Concat) {
+        std::string& result = strings[pc->dst];
+        result.assign(*r[pc->a].string);
+        result.append(*r[pc->b].string);
+        r[pc->dst].string = &result;
+        VM_NEXT();
+    }
+    VM_CASE(LengthString) {
+        r[pc->dst].scalar = static_cast<int32_t>(r[pc->a].string->size());
+        VM_NEXT();
+    }
+    VM_CASE(LengthBytes) {
+        r[pc->dst].scalar = static_cast<int32_t>(r[pc->a].bytes->size());
+        VM_NEXT();
+    }
+    VM_CASE(Not) {
+        r[pc->dst].scalar = !r[pc->a].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(Xor) {
+        r[pc->dst].scalar = r[pc->a].scalar ^ r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(LessInt) {
+        r[pc->dst].scalar = r[pc->a].scalar < r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(LessEqualInt) {
+        r[pc->dst].scalar = r[pc->a].scalar <= r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(GreaterInt) {
+        r[pc->dst].scalar = r[pc->a].scalar > r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(GreaterEqualInt) {
+        r[pc->dst].scalar = r[pc->a].scalar >= r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(EqualInt) {
+        r[pc->dst].scalar = r[pc->a].scalar == r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(NotEqualInt) {
+        r[pc->dst].scalar = r[pc->a].scalar != r[pc->b].scalar;
+        VM_NEXT();
+    }
+    VM_CASE(LessString) {
+        r[pc->dst].scalar = r[pc->a].string->compare(*r[pc->b].string) < 0;
+        VM_NEXT();
+    }
+    VM_CASE(LessEqualString) {
+        r[pc->dst].scalar = r[pc->a].string->compare(*r[pc->b].string) <= 0;
+        VM_NEXT();
+    }
+    VM_CASE(GreaterString) {
+        r[pc->dst].scalar = r[pc->a].string->compare(*r[pc->b].string) > 0;
+        VM_NEXT();
+    }
+    VM_CASE(GreaterEqualString) {
+        r[pc->dst].scalar = r[pc->a].string->compare(*r[pc->b].string) >= 0;
+        VM_NEXT();
+    }
+    VM_CASE(EqualString) {
+        r[pc->dst].scalar = *r[pc->a].string == *r[pc->b].string;
+        VM_NEXT();
+    }
+    VM_CASE(NotEqualString) {
+        r[pc->dst].scalar = *r[pc->a].string != *r[pc->b].string;
+        VM_NEXT();
+    }
+    VM_CASE(LessBytes) {
+        r[pc->dst].scalar = *r[pc->a].bytes < *r[pc->b].bytes;
+        VM_NEXT();
+    }
+    VM_CASE(LessEqualBytes) {
+        r[pc->dst].scalar = *r[pc->a].bytes <= *r[pc->b].bytes;
+        VM_NEXT();
+    }
+    VM_CASE(GreaterBytes) {
+        r[pc->dst].scalar = *r[pc->a].bytes > *r[pc->b].bytes;
+        VM_NEXT();
+    }
+    VM_CASE(GreaterEqualBytes) {
+        r[pc->dst].scalar = *r[pc->a].bytes >= *r[pc->b].bytes;
+        VM_NEXT();
+    }
+    VM_CASE(EqualBytes) {
+        r[pc->dst].scalar = *r[pc->a].bytes == *r[pc->b].bytes;
+        VM_NEXT();
+    }
+    VM_CASE(NotEqualBytes) {
+        r[pc->dst].scalar = *r[pc->a].bytes != *r[pc->b].bytes;
+        VM_NEXT();
+    }
+    VM_CASE(JumpIfFalse) {
+        if (!r[pc->a].scalar) {
+            pc = code + pc->b;
+            VM_DISPATCH();
+        }
+        VM_NEXT();
+    }
+    VM_CASE(JumpIfTrue) {
+        if (r[pc->a].scalar) {
+            pc = code + pc->b;
+            VM_DISPATCH();
+        }
+        VM_NEXT();
+    }
+    VM_CASE(Return) {
+        return r[pc->a];
+    }
+
+#ifndef MEMDB_COMPUTED_GOTO
+    }
+    }
+#endif
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef VM_NEXT
+}
+
+Value ExpressionProgram::evaluate(const RowTuple& tuple) const {
+    const Register& result = run(tuple);
+    switch (type_) {
+        case Type::Int32: return Value(result.scalar);
+        case Type::Bool: return Value(result.scalar != 0);
+        case Type::String: return Value(*result.string);
+        default: return Value(*result.bytes);
+    }
+}
+
+bool ExpressionProgram::matches(const RowTuple& tuple) const {
+    return run(tuple).scalar != 0;
+}
+
+std::string ExpressionProgram::serialize() const {
+    std::string out(kProgramMagic, kProgramMagicSize);
+    put_u8(out, static_cast<uint8_t>(type_));
+    put_u32(out, static_cast<uint32_t>(register_count_));
+    put_u32(out, static_cast<uint32_t>(columns_.size()));
+    for (const auto& column : columns_) {
+        put_u32(out, static_cast<uint32_t>(column.slot));
+        put_u32(out, static_cast<uint32_t>(column.column));
+        put_bytes(out, column.name.data(), column.name.size());
+    }
+    put_u32(out, static_cast<uint32_t>(constants_.size()));
+    for (const auto& constant : constants_) {
+        put_u8(out, static_cast<uint8_t>(constant.get_type()));
+        if (constant.get_type() == Type::String) {
+            put_bytes(out, constant.get_string().data(), constant.get_string().size());
+        } else {
+            const auto& bytes = constant.get_bytes();
+            put_bytes(out, reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+    }
+    put_u32(out, static_cast<uint32_t>(code_.size()));
+    for (const auto& instruction : code_) {
+        put_u8(out, static_cast<uint8_t>(instruction.op));
+        put_u32(out, instruction.dst);
+        put_u32(out, instruction.a);
+        put_u32(out, instruction.b);
+    }
+    return out;
+}
+
+ExpressionProgram ExpressionProgram::deserialize(const std::string& data) {
+    ProgramReader reader(data);
+    if (std::memcmp(reader.take(kProgramMagicSize), kProgramMagic, kProgramMagicSize) != 0) {
+        throw exceptions::SerializationException("Not an expression program.");
+    }
+
+    ExpressionProgram program;
+    uint8_t type = reader.u8();
+    if (type > static_cast<uint8_t>(Type::Bytes)) {
+        throw exceptions::SerializationException("Invalid expression program type.");
+    }
+    program.type_ = static_cast<Type>(type);
+    program.register_count_ = reader.u32();
+
+    uint32_t column_count = reader.count(12);
+    for (uint32_t i = 0; i < column_count; ++i) {
+        size_t slot = reader.u32();
+        size_t column = reader.u32();
+        program.columns_.push_back(ColumnSlot{slot, column, reader.bytes()});
+    }
+    uint32_t constant_count = reader.count(5);
+    for (uint32_t i = 0; i < constant_count; ++i) {
+        uint8_t constant_type = reader.u8();
+        std::string bytes = reader.bytes();
+        if (constant_type == static_cast<uint8_t>(Type::String)) {
+            program.constants_.emplace_back(bytes);
+        } else if (constant_type == static_cast<uint8_t>(Type::Bytes)) {
+            program.constants_.emplace_back(std::vector<uint8_t>(bytes.begin(), bytes.end()));
+        } else {
+            throw exceptions::SerializationException("Invalid expression program constant.");
+        }
+    }
+    uint32_t code_size = reader.count(13);
+    for (uint32_t i = 0; i < code_size; ++i) {
+        uint8_t op = reader.u8();
+        if (op > static_cast<uint8_t>(OpCode::Return)) {
+            throw exceptions::SerializationException("Invalid expression program opcode.");
+        }
+        uint32_t dst = reader.u32();
+        uint32_t a = reader.u32();
+        uint32_t b = reader.u32();
+        program.code_.push_back(Instruction{static_cast<OpCode>(op), dst, a, b});
+    }
+    if (!reader.at_end()) {
+        throw exceptions::SerializationException("Trailing bytes after expression program.");
+    }
+    program.verify();
+    return program;
+}
+
+// The dispatch loop trusts its code, so a deserialised program is checked as
+// if it were compiled: registers have one kind each and are read only where
+// every path has set them. Jumps only go forward, which makes the program a
+// DAG and lets the registers set on entry to each instruction be computed in
+// one pass.
+void ExpressionProgram::verify() const {
+    auto fail = [](const std::string& what) {
+        throw exceptions::SerializationException("Invalid expression program: " + what + ".");
+    };
+    if (code_.empty() || code_.back().op != OpCode::Return) {
+        fail("it does not end in a return");
+    }
+    // Every register is set by an instruction of its own.
+    if (register_count_ > code_.size()) {
+        fail("it has more registers than instructions");
+    }
+
+    std::vector<Kind> kinds(register_count_, Kind::None);
+    std::vector<std::vector<bool>> set(code_.size());
+    set[0].assign(register_count_, false);
+    for (size_t i = 0; i < code_.size(); ++i) {
+        if (set[i].empty()) {
+            continue;
+        }
+        const Instruction& instruction = code_[i];
+        auto read = [&](uint32_t reg, Kind kind) {
+            if (reg >= register_count_ || !set[i][reg] || kinds[reg] != kind) {
+                fail("instruction " + std::to_string(i) + " reads an unset or mistyped register");
+            }
+        };
+        auto column = [&](uint32_t index) {
+            if (index >= columns_.size()) {
+                fail("instruction " + std::to_string(i) + " reads an unknown column");
+            }
+        };
+        auto constant = [&](uint32_t index, Type type) {
+            if (index >= constants_.size() || constants_[index].get_type() != type) {
+                fail("instruction " + std::to_string(i) + " reads an unknown constant");
+            }
+        };
+
+        Kind result = Kind::None;
+        switch (instruction.op) {
+            case OpCode::LoadInt:
+            case OpCode::LoadBool: column(instruction.a); result = Kind::Scalar; break;
+            case OpCode::LoadString: column(instruction.a); result = Kind::String; break;
+            case OpCode::LoadBytes: column(instruction.a); result = Kind::Bytes; break;
+            case OpCode::LoadImmediate: result = Kind::Scalar; break;
+            case OpCode::LoadConstString: constant(instruction.a, Type::String); result = Kind::String; break;
+            case OpCode::LoadConstBytes: constant(instruction.a, Type::Bytes); result = Kind::Bytes; break;
+            case OpCode::Move:
+                if (instruction.a >= register_count_) {
+                    fail("instruction " + std::to_string(i) + " reads an unset or mistyped register");
+                }
+                result = kinds[instruction.a];
+                read(instruction.a, result);
+                break;
+            case OpCode::LengthString: read(instruction.a, Kind::String); result = Kind::Scalar; break;
+            case OpCode::LengthBytes: read(instruction.a, Kind::Bytes); result = Kind::Scalar; break;
+            case OpCode::Not: read(instruction.a, Kind::Scalar); result = Kind::Scalar; break;
+            case OpCode::Concat:
+                read(instruction.a, Kind::String);
+                read(instruction.b, Kind::String);
+                result = Kind::String;
+                break;
+            case OpCode::JumpIfFalse:
+            case OpCode::JumpIfTrue:
+                read(instruction.a, Kind::Scalar);
+                if (instruction.b <= i || instruction.b >= code_.size()) {
+                    fail("instruction " + std::to_string(i) + " does not jump forward");
+                }
+                break;
+            case OpCode::Return:
+                read(instruction.a, kind_of(type_));
+                break;
+            default: {
+                size_t op = static_cast<size_t>(instruction.op);
+                Kind operands = op >= static_cast<size_t>(OpCode::LessBytes) ? Kind::Bytes
+                              : op >= static_cast<size_t>(OpCode::LessString) ? Kind::String
+                              : Kind::Scalar;
+                read(instruction.a, operands);
+                read(instruction.b, operands);
+                result = Kind::Scalar;
+                break;
+            }
+        }
+
+        std::vector<bool> out = set[i];
+        if (result != Kind::None) {
+            if (instruction.dst >= register_count_ || (kinds[instruction.dst] != Kind::None && kinds[instruction.dst] != result)) {
+                fail("instruction " + std::to_string(i) + " writes an invalid register");
+            }
+            kinds[instruction.dst] = result;
+            out[instruction.dst] = true;
+        }
+        auto flow = [&](size_t target) {
+            if (set[target].empty()) {
+                set[target] = out;
+            } else {
+                for (size_t reg = 0; reg < register_count_; ++reg) {
+                    set[target][reg] = set[target][reg] && out[reg];
+                }
+            }
+        };
+        if (instruction.op != OpCode::Return) {
+            flow(i + 1);
+        }
+        if (instruction.op == OpCode::JumpIfFalse || instruction.op == OpCode::JumpIfTrue) {
+            flow(instruction.b);
+        }
+    }
+}
+
+std::string ExpressionProgram::to_string() const {
+    std::string text;
+    for (size_t i = 0; i < code_.size(); ++i) {
+        const Instruction& instruction = code_[i];
+        const std::string mnemonic = kMnemonics[static_cast<size_t>(instruction.op)];
+        std::string line;
+        switch (instruction.op) {
+            case OpCode::LoadInt:
+            case OpCode::LoadBool:
+            case OpCode::LoadString:
+            case OpCode::LoadBytes:
+                line = "r" + std::to_string(instruction.dst) + " = " + mnemonic + " " + columns_[instruction.a].name;
+                break;
+            case OpCode::LoadImmediate:
+                line = "r" + std::to_string(instruction.dst) + " = " + mnemonic + " " +
+                       std::to_string(static_cast<int32_t>(instruction.a));
+                break;
+            case OpCode::LoadConstString:
+            case OpCode::LoadConstBytes:
+                line = "r" + std::to_string(instruction.dst) + " = " + mnemonic + " " + constants_[instruction.a].to_string();
+                break;
+            case OpCode::Move:
+            case OpCode::LengthString:
+            case OpCode::LengthBytes:
+            case OpCode::Not:
+                line = "r" + std::to_string(instruction.dst) + " = " + mnemonic + " r" + std::to_string(instruction.a);
+                break;
+            case OpCode::JumpIfFalse:
+            case OpCode::JumpIfTrue:
+                line = mnemonic + " r" + std::to_string(instruction.a) + ", " + std::to_string(instruction.b);
+                break;
+            case OpCode::Return:
+                line = mnemonic + " r" + std::to_string(instruction.a);
+                break;
+            default:
+                line = "r" + std::to_string(instruction.dst) + " = " + mnemonic + " r" + std::to_string(instruction.a) +
+                       ", r" + std::to_string(instruction.b);
+                break;
+        }
+        text += std::to_string(i) + ": " + line + "\n";
+    }
+    return text;
+}
+
+}
+}
@@ -0,0 +1,286 @@
+#include "memdb/core/HashAggregator.h"
+
+#include "memdb/core/exceptions/TypeMismatchException.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+const size_t kEmptySlot = std::numeric_limits<size_t>::max();
+const size_t kMaxInitialSlots = 1 << 17;
+const size_t kNullKeyHash = 0x5bd1e995;
+
+size_t hash_keys(const std::vector<std::optional<Value>>& keys) {
+    size_t hash = 0;
+    for (const auto& key : keys) {
+        size_t key_hash = key.has_value() ? ValueHash{}(*key) : kNullKeyHash;
+        hash ^= key_hash + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+Value checked_int(int64_t value, const std::string& name) {
+    if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) {
+        throw exceptions::TypeMismatchException("Integer overflow in " + name + ".");
+    }
+    return Value(static_cast<int32_t>(value));
+}
+
+}
+
+HashAggregator::HashAggregator(std::vector<const Expression*> keys,
+                               std::vector<const AggregateExpression*> aggregates,
+                               std::unordered_set<std::string> columns,
+                               size_t memory_budget,
+                               size_t expected_rows)
+    : keys_(std::move(keys)), aggregates_(std::move(aggregates)), columns_(std::move(columns)),
+      memory_budget_(memory_budget) {
+    size_t group_bytes = sizeof(Group) + keys_.size() * sizeof(std::optional<Value>) +
+                         aggregates_.size() * sizeof(Accumulator) + 2 * sizeof(Slot);
+    max_groups_ = std::max<size_t>(1, memory_budget / group_bytes);
+    collapse_at_ = 2 * max_groups_;
+
+    size_t slot_count = 16;
+    size_t wanted = 2 * std::min({expected_rows, max_groups_, kMaxInitialSlots});
+    while (slot_count < wanted) {
+        slot_count *= 2;
+    }
+    slots_.assign(slot_count, Slot{0, kEmptySlot});
+}
+
+std::optional<Value> HashAggregator::evaluate(const Expression* expression,
+                                              const std::unordered_map<std::string, Value>& row) const {
+    if (auto variable = dynamic_cast<const VariableExpression*>(expression)) {
+        if (columns_.count(variable->get_name()) > 0 && row.count(variable->get_name()) == 0) {
+            return std::nullopt;
+        }
+    }
+    return expression->evaluate(row);
+}
+
+size_t HashAggregator::find_group(size_t hash, const std::vector<std::optional<Value>>& keys) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask; slots_[i].group != kEmptySlot; i = (i + 1) & mask) {
+        if (slots_[i].hash == hash && groups_[slots_[i].group].keys == keys) {
+            return slots_[i].group;
+        }
+    }
+    return kEmptySlot;
+}
+
+void HashAggregator::insert_slot(size_t hash, size_t group) {
+    size_t mask = slots_.size() - 1;
+    size_t i = hash & mask;
+    while (slots_[i].group != kEmptySlot) {
+        i = (i + 1) & mask;
+    }
+    slots_[i] = Slot{hash, group};
+}
+
+void HashAggregator::grow() {
+    std::vector<Slot> old_slots(slots_.size() * 2, Slot{0, kEmptySlot});
+    old_slots.swap(slots_);
+    for (const auto& slot : old_slots) {
+        if (slot.group != kEmptySlot) {
+            insert_slot(slot.hash, slot.group);
+        }
+    }
+}
+
+// Returns the group to accumulate `keys` into: the existing one, a new one,
+// or a one-row partial group once the aggregator is sorting.
+size_t HashAggregator::locate(std::vector<std::optional<Value>> keys) {
+    if (!sorting_) {
+        size_t hash = hash_keys(keys);
+        size_t group = find_group(hash, keys);
+        if (group != kEmptySlot) {
+            return group;
+        }
+        if (groups_.size() < max_groups_) {
+            if (2 * (groups_.size() + 1) > slots_.size()) {
+                grow();
+            }
+            group = groups_.size();
+            groups_.push_back(Group{std::move(keys), std::vector<Accumulator>(aggregates_.size())});
+            insert_slot(hash, group);
+            return group;
+        }
+        sorting_ = true;
+        std::vector<Slot>().swap(slots_);
+    }
+    groups_.push_back(Group{std::move(keys), std::vector<Accumulator>(aggregates_.size())});
+    return groups_.size() - 1;
+}
+
+void HashAggregator::add(const std::unordered_map<std::string, Value>& row) {
+    std::vector<std::optional<Value>> keys;
+    keys.reserve(keys_.size());
+    for (const Expression* key : keys_) {
+        keys.push_back(evaluate(key, row));
+    }
+
+    size_t group = locate(std::move(keys));
+    for (size_t i = 0; i < aggregates_.size(); ++i) {
+        accumulate(groups_[group].accumulators[i], *aggregates_[i], row);
+    }
+
+    if (sorting_ && groups_.size() >= collapse_at_) {
+        collapse();
+    }
+}
+
+std::unique_ptr<HashAggregator> HashAggregator::partial(size_t expected_rows) const {
+    return std::make_unique<HashAggregator>(keys_, aggregates_, columns_, memory_budget_, expected_rows);
+}
+
+void HashAggregator::merge(HashAggregator& other) {
+    for (auto& other_group : other.groups_) {
+        size_t group = locate(std::move(other_group.keys));
+        for (size_t i = 0; i < aggregates_.size(); ++i) {
+            merge(groups_[group].accumulators[i], other_group.accumulators[i], *aggregates_[i]);
+        }
+        if (sorting_ && groups_.size() >= collapse_at_) {
+            collapse();
+        }
+    }
+    std::vector<Group>().swap(other.groups_);
+    std::vector<Slot>().swap(other.slots_);
+}
+
+void HashAggregator::accumulate(Accumulator& accumulator, const AggregateExpression& aggregate,
+                                const std::unordered_map<std::string, Value>& row) const {
+    if (aggregate.get_argument() == nullptr) {
+        ++accumulator.count;
+        return;
+    }
+    std::optional<Value> value = evaluate(aggregate.get_argument(), row);
+    if (!value.has_value()) {
+        return;
+    }
+    ++accumulator.count;
+
+    switch (aggregate.get_function()) {
+        case AggregateExpression::Function::Sum:
+        case AggregateExpression::Function::Avg:
+            if (value->get_type() != Type::Int32) {
+                throw exceptions::TypeMismatchException(aggregate.to_string() + " requires an int32 argument.");
+            }
+            accumulator.sum += value->get_int();
+            break;
+        case AggregateExpression::Function::Min:
+            if (!accumulator.extreme.has_value() || *value < *accumulator.extreme) {
+                accumulator.extreme = std::move(value);
+            }
+            break;
+        case AggregateExpression::Function::Max:
+            if (!accumulator.extreme.has_value() || *accumulator.extreme < *value) {
+                accumulator.extreme = std::move(value);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void HashAggregator::merge(Accumulator& into, const Accumulator& from, const AggregateExpression& aggregate) const {
+    into.count += from.count;
+    into.sum += from.sum;
+    if (!from.extreme.has_value()) {
+        return;
+    }
+    bool replace = !into.extreme.has_value() ||
+                   (aggregate.get_function() == AggregateExpression::Function::Min && *from.extreme < *into.extreme) ||
+                   (aggregate.get_function() == AggregateExpression::Function::Max && *into.extreme < *from.extreme);
+    if (replace) {
+        into.extreme = from.extreme;
+    }
+}
+
+std::optional<Value> HashAggregator::result(const Accumulator& accumulator, const AggregateExpression& aggregate) const {
+    switch (aggregate.get_function()) {
+        case AggregateExpression::Function::Count:
+            return checked_int(accumulator.count, aggregate.to_string());
+        case AggregateExpression::Function::Sum:
+            if (accumulator.count == 0) {
+                return std::nullopt;
+            }
+            return checked_int(accumulator.sum, aggregate.to_string());
+        case AggregateExpression::Function::Avg:
+            if (accumulator.count == 0) {
+                return std::nullopt;
+            }
+            return checked_int(accumulator.sum / accumulator.count, aggregate.to_string());
+        default:
+            return accumulator.extreme;
+    }
+}
+
+void HashAggregator::collapse() {
+    std::stable_sort(groups_.begin(), groups_.end(), [](const Group& left, const Group& right) {
+        return left.keys < right.keys;
+    });
+
+    size_t last = 0;
+    for (size_t i = 1; i < groups_.size(); ++i) {
+        if (groups_[i].keys == groups_[last].keys) {
+            for (size_t a = 0; a < aggregates_.size(); ++a) {
+                merge(groups_[last].accumulators[a], groups_[i].accumulators[a], *aggregates_[a]);
+            }
+        } else if (++last != i) {
+            groups_[last] = std::move(groups_[i]);
+        }
+    }
+    if (!groups_.empty()) {
+        groups_.resize(last + 1);
+    }
+    // With more distinct groups than the budget the buffer never shrinks back
+    // below it; wait for it to double so that collapsing stays amortized.
+    collapse_at_ = std::max(2 * max_groups_, 2 * groups_.size());
+}
+
+void HashAggregator::finish() {
+    finished_ = true;
+    if (sorting_) {
+        collapse();
+    }
+    // Without GROUP BY there is exactly one group, even for no input rows.
+    if (keys_.empty() && groups_.empty()) {
+        groups_.push_back(Group{{}, std::vector<Accumulator>(aggregates_.size())});
+    }
+    std::vector<Slot>().swap(slots_);
+}
+
+bool HashAggregator::next(std::unordered_map<std::string, Value>& row) {
+    if (!finished_) {
+        finish();
+    }
+    if (position_ >= groups_.size()) {
+        return false;
+    }
+
+    const Group& group = groups_[position_++];
+    row.clear();
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (!group.keys[i].has_value()) {
+            continue;
+        }
+        if (auto variable = dynamic_cast<const VariableExpression*>(keys_[i])) {
+            row[variable->get_name()] = *group.keys[i];
+        }
+        row[keys_[i]->to_string()] = *group.keys[i];
+    }
+    for (size_t i = 0; i < aggregates_.size(); ++i) {
+        std::optional<Value> value = result(group.accumulators[i], *aggregates_[i]);
+        if (value.has_value()) {
+            row[aggregates_[i]->to_string()] = *value;
+        }
+    }
+    return true;
+}
+
+}
+}
\ No newline at end of file
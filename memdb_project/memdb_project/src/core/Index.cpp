@@ -3,6 +3,7 @@
 #include "memdb/core/exceptions/DatabaseException.h"
 
 #include <algorithm>
+#include <iterator>
 
 namespace memdb {
 namespace core {
@@ -10,39 +11,92 @@ namespace core {
 Index::Index(IndexType type, const std::vector<std::string>& columns)
     : type_(type), columns_(columns) {}
 
+std::string Index::make_key(const std::unordered_map<std::string, Value>& row) const {
+    std::string key;
+    for (const auto& col : columns_) {
+        auto it = row.find(col);
+        if (it == row.end()) {
+            throw std::invalid_argument("Column '" + col + "' not found in row for index.");
+        }
+        key += it->second.to_string() + "|";
+    }
+    return key;
+}
+
+const Value& Index::ordered_key(const std::unordered_map<std::string, Value>& row) const {
+    if (columns_.size() != 1) {
+        throw std::invalid_argument("Ordered index can only be created on a single column.");
+    }
+    auto it = row.find(columns_[0]);
+    if (it == row.end()) {
+        throw std::invalid_argument("Column '" + columns_[0] + "' not found in row for index.");
+    }
+    return it->second;
+}
+
 void Index::add_row(RowID row_id, const std::unordered_map<std::string, Value>& row) {
     if (type_ == IndexType::Unordered) {
-        std::string key;
-        for (const auto& col : columns_) {
-            if (row.find(col) == row.end()) {
-                throw std::invalid_argument("Column '" + col + "' not found in row for index.");
+        unordered_map_[make_key(row)].push_back(row_id);
+    }
+    else if (type_ == IndexType::Ordered) {
+        ordered_map_.emplace(ordered_key(row), row_id);
+    }
+}
+
+void Index::add_rows(const std::vector<RowID>& row_ids, const std::vector<std::unordered_map<std::string, Value>>& rows) {
+    if (row_ids.size() != rows.size()) {
+        throw std::invalid_argument("Row id count does not match row count for index batch.");
+    }
+
+    if (type_ == IndexType::Unordered) {
+        std::vector<std::pair<std::string, RowID>> entries;
+        entries.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            entries.emplace_back(make_key(rows[i]), row_ids[i]);
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        unordered_map_.reserve(unordered_map_.size() + entries.size());
+        for (size_t i = 0; i < entries.size();) {
+            auto& bucket = unordered_map_[entries[i].first];
+            size_t j = i;
+            while (j < entries.size() && entries[j].first == entries[i].first) {
+                bucket.push_back(entries[j].second);
+                ++j;
             }
-            key += row.at(col).to_string() + "|";
+            i = j;
         }
-        unordered_map_[key].push_back(row_id);
     }
     else if (type_ == IndexType::Ordered) {
-        if (columns_.size() != 1) {
-            throw std::invalid_argument("Ordered index can only be created on a single column.");
+        std::vector<std::pair<const Value*, RowID>> entries;
+        entries.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            entries.emplace_back(&ordered_key(rows[i]), row_ids[i]);
         }
-        const std::string& col = columns_[0];
-        if (row.find(col) == row.end()) {
-            throw std::invalid_argument("Column '" + col + "' not found in row for index.");
+        if (entries.empty()) {
+            return;
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const auto& a, const auto& b) { return *a.first < *b.first; });
+
+        // Equal keys go after the ones already stored, as with add_row, so
+        // ties stay in RowID order.
+        auto hint = ordered_map_.end();
+        const Value* hint_key = nullptr;
+        for (const auto& [key, row_id] : entries) {
+            if (hint_key == nullptr || *hint_key < *key) {
+                hint = ordered_map_.upper_bound(*key);
+                hint_key = key;
+            }
+            ordered_map_.emplace_hint(hint, *key, row_id);
         }
-        ordered_map_[row.at(col).to_string()] = row_id;
     }
 }
 
 void Index::remove_row(RowID row_id, const std::unordered_map<std::string, Value>& row) {
     if (type_ == IndexType::Unordered) {
-        std::string key;
-        for (const auto& col : columns_) {
-            if (row.find(col) == row.end()) {
-                throw std::invalid_argument("Column '" + col + "' not found in row for index.");
-            }
-            key += row.at(col).to_string() + "|";
-        }
-        auto it = unordered_map_.find(key);
+        auto it = unordered_map_.find(make_key(row));
         if (it != unordered_map_.end()) {
             it->second.erase(std::remove(it->second.begin(), it->second.end(), row_id), it->second.end());
             if (it->second.empty()) {
@@ -51,13 +105,12 @@ void Index::remove_row(RowID row_id, const std::unordered_map<std::string, Value
         }
     }
     else if (type_ == IndexType::Ordered) {
-        if (columns_.size() != 1) {
-            throw std::invalid_argument("Ordered index can only be created on a single column.");
-        }
-        const std::string& col = columns_[0];
-        auto it = ordered_map_.find(row.at(col).to_string());
-        if (it != ordered_map_.end() && it->second == row_id) {
-            ordered_map_.erase(it);
+        auto range = ordered_map_.equal_range(ordered_key(row));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == row_id) {
+                ordered_map_.erase(it);
+                break;
+            }
         }
     }
 }
@@ -88,12 +141,16 @@ std::vector<RowID> Index::search_ordered(const std::string& column,
     if (columns_.size() != 1 || columns_[0] != column) {
         return result;
     }
+    if (lower.has_value() && upper.has_value() &&
+        (*upper < *lower || (*upper == *lower && !(lower_inclusive && upper_inclusive)))) {
+        return result;
+    }
 
-    auto it_lower = lower.has_value() ? (lower_inclusive ? ordered_map_.lower_bound(lower->to_string()) 
-                                                       : ordered_map_.upper_bound(lower->to_string()))
+    auto it_lower = lower.has_value() ? (lower_inclusive ? ordered_map_.lower_bound(*lower) 
+                                                       : ordered_map_.upper_bound(*lower))
                                        : ordered_map_.begin();
-    auto it_upper = upper.has_value() ? (upper_inclusive ? ordered_map_.upper_bound(upper->to_string()) 
-                                                       : ordered_map_.lower_bound(upper->to_string()))
+    auto it_upper = upper.has_value() ? (upper_inclusive ? ordered_map_.upper_bound(*upper) 
+                                                       : ordered_map_.lower_bound(*upper))
                                        : ordered_map_.end();
 
     for (auto it = it_lower; it != it_upper; ++it) {
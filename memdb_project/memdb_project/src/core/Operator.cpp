@@ -0,0 +1,806 @@
+#include "memdb/core/Operator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+const std::string kJoinConditionError = "JOIN condition does not evaluate to a boolean.";
+const std::string kWhereClauseError = "WHERE clause does not evaluate to a boolean.";
+
+const size_t kL2CacheBytes = 256 * 1024;
+const size_t kMaxRadixBits = 10;
+const size_t kNoEntry = std::numeric_limits<size_t>::max();
+
+struct HashedEntry {
+    size_t hash;
+    size_t index;
+};
+
+// An inner entry plus its share of the bucket heads and the chain link.
+const size_t kPartitionEntryBytes = sizeof(HashedEntry) + 3 * sizeof(size_t);
+
+// Hashes `count` items in grains on the pool; every grain keeps the entries
+// whose key has no NULL, in input order.
+template <typename KeyFn>
+std::vector<std::vector<HashedEntry>> hash_entries(ThreadPool& pool, size_t workers, size_t count, size_t grain, KeyFn key) {
+    std::vector<std::vector<HashedEntry>> grains((count + grain - 1) / grain);
+    pool.parallel_for(count, grain, [&](size_t begin, size_t end) {
+        auto& entries = grains[begin / grain];
+        size_t hash = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (key(i, hash)) {
+                entries.push_back(HashedEntry{hash, i});
+            }
+        }
+    }, workers);
+    return grains;
+}
+
+// Scatters the entries into 2^bits partitions by the low bits of their hash.
+// Every grain writes through its own offsets, so entries keep their input
+// order within a partition. `bounds` receives where every partition starts.
+std::vector<HashedEntry> radix_partition(ThreadPool& pool, size_t workers, const std::vector<std::vector<HashedEntry>>& grains,
+                                         size_t bits, std::vector<size_t>& bounds) {
+    size_t partitions = size_t(1) << bits;
+    size_t mask = partitions - 1;
+    std::vector<std::vector<size_t>> offsets(grains.size(), std::vector<size_t>(partitions, 0));
+    pool.run(grains.size(), [&](size_t g) {
+        for (const auto& entry : grains[g]) {
+            ++offsets[g][entry.hash & mask];
+        }
+    }, workers);
+
+    bounds.assign(partitions + 1, 0);
+    size_t total = 0;
+    for (size_t p = 0; p < partitions; ++p) {
+        bounds[p] = total;
+        for (auto& grain_offsets : offsets) {
+            size_t count = grain_offsets[p];
+            grain_offsets[p] = total;
+            total += count;
+        }
+    }
+    bounds[partitions] = total;
+
+    std::vector<HashedEntry> partitioned(total);
+    pool.run(grains.size(), [&](size_t g) {
+        for (const auto& entry : grains[g]) {
+            partitioned[offsets[g][entry.hash & mask]++] = entry;
+        }
+    }, workers);
+    return partitioned;
+}
+
+void combine_hash(size_t& hash, const Value& value) {
+    hash ^= ValueHash{}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+bool values_equal(const std::optional<Value>& left, const std::optional<Value>& right) {
+    return left.has_value() && right.has_value() && *left == *right;
+}
+
+// The index that answers `ranges`, if one of them pins a column of the index
+// to a literal of the column's type: an unordered index whose columns are all
+// fixed by equalities, or else an ordered index over a range of its column.
+struct IndexChoice {
+    const Index* index = nullptr;
+    const ColumnRange* range = nullptr;
+    std::unordered_map<std::string, Value> equalities;
+};
+
+IndexChoice choose_index(const Table& table, const std::vector<ColumnRange>& ranges) {
+    IndexChoice choice;
+    std::vector<const ColumnRange*> usable;
+    for (const auto& range : ranges) {
+        const Value& bound = range.lower.has_value() ? *range.lower : *range.upper;
+        for (const auto& column : table.get_columns()) {
+            if (column.get_name() == range.column && column.get_type().get_type() == bound.get_type()) {
+                usable.push_back(&range);
+            }
+        }
+    }
+    if (usable.empty()) {
+        return choice;
+    }
+
+    for (const ColumnRange* range : usable) {
+        if (range->is_equality()) {
+            choice.equalities.emplace(range->column, *range->lower);
+        }
+    }
+
+    for (const auto& index : table.get_indexes()) {
+        const auto& columns = index->get_columns();
+        bool covered = std::all_of(columns.begin(), columns.end(), [&](const std::string& col) { return choice.equalities.count(col) > 0; });
+        if (covered && index->get_type() == IndexType::Unordered) {
+            choice.index = index.get();
+            choice.range = nullptr;
+            return choice;
+        }
+        if (index->get_type() != IndexType::Ordered) {
+            continue;
+        }
+        for (const ColumnRange* candidate : usable) {
+            if (candidate->column == columns[0] && (choice.range == nullptr || (candidate->is_equality() && !choice.range->is_equality()))) {
+                choice.index = index.get();
+                choice.range = candidate;
+            }
+        }
+    }
+    return choice;
+}
+
+// Reads the candidate rows through the index choose_index() picks; returns
+// false when there is none.
+bool index_scan(const Table& table, const std::vector<ColumnRange>& ranges, std::vector<RowID>& row_ids) {
+    IndexChoice choice = choose_index(table, ranges);
+    if (choice.index == nullptr) {
+        return false;
+    }
+    if (choice.range == nullptr) {
+        row_ids = choice.index->search_unordered(choice.equalities);
+    } else {
+        const ColumnRange* range = choice.range;
+        row_ids = choice.index->search_ordered(range->column, range->lower, range->lower_inclusive, range->upper, range->upper_inclusive);
+    }
+    std::sort(row_ids.begin(), row_ids.end());
+    return true;
+}
+
+}
+
+size_t ExecutionContext::add_relation(std::shared_ptr<Table> table, const std::string& qualifier) {
+    std::vector<std::string> names;
+    for (const auto& column : table->get_columns()) {
+        names.push_back(qualifier.empty() ? column.get_name() : qualifier + "." + column.get_name());
+    }
+    tables_.push_back(std::move(table));
+    qualifiers_.push_back(qualifier);
+    names_.push_back(std::move(names));
+    bound_.push_back(nullptr);
+    return tables_.size() - 1;
+}
+
+std::unordered_map<std::string, Value>& ExecutionContext::bind(const RowTuple& tuple, size_t slot) {
+    const Row* row = tuple[slot];
+    if (row == nullptr || row == bound_[slot]) {
+        return row_map_;
+    }
+
+    const auto& names = names_[slot];
+    const auto& values = row->get_values();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (values[i].has_value()) {
+            row_map_[names[i]] = *(values[i]);
+        } else {
+            row_map_.erase(names[i]);
+        }
+    }
+    bound_[slot] = row;
+    return row_map_;
+}
+
+std::unordered_map<std::string, Value>& ExecutionContext::bind(const RowTuple& tuple) {
+    for (size_t slot = 0; slot < tuple.size(); ++slot) {
+        bind(tuple, slot);
+    }
+    return row_map_;
+}
+
+void ExecutionContext::bind_into(const RowTuple& tuple, std::unordered_map<std::string, Value>& row_map) const {
+    for (size_t slot = 0; slot < tuple.size(); ++slot) {
+        if (tuple[slot] == nullptr) {
+            continue;
+        }
+        const auto& names = names_[slot];
+        const auto& values = tuple[slot]->get_values();
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (values[i].has_value()) {
+                row_map[names[i]] = *(values[i]);
+            } else {
+                row_map.erase(names[i]);
+            }
+        }
+    }
+}
+
+void ExecutionContext::set_parallelism(ThreadPool& pool, const QueryOptions& options) {
+    size_t workers = options.num_threads == 0 ? pool.size() : std::min(options.num_threads, pool.size());
+    if (workers < 2) {
+        return;
+    }
+    pool_ = &pool;
+    workers_ = workers;
+    morsel_size_ = std::max<size_t>(1, options.morsel_size);
+}
+
+bool ExecutionContext::passes(const std::vector<const Expression*>& conditions, const std::string& error_message) const {
+    return passes(row_map_, conditions, error_message);
+}
+
+bool ExecutionContext::passes(const std::unordered_map<std::string, Value>& row_map,
+                              const std::vector<const Expression*>& conditions, const std::string& error_message) {
+    for (const Expression* condition : conditions) {
+        Value condition_value = condition->evaluate(row_map);
+        if (condition_value.get_type() != Type::Bool) {
+            throw std::invalid_argument(error_message);
+        }
+        if (!condition_value.get_bool()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EmptyOperator::next(RowTuple&) {
+    return false;
+}
+
+ScanOperator::ScanOperator(ExecutionContext& context, size_t slot,
+                           std::vector<ColumnRange> ranges, std::vector<const Expression*> filters)
+    : context_(context), slot_(slot), ranges_(std::move(ranges)), filters_(std::move(filters)) {}
+
+void ScanOperator::open() {
+    opened_ = true;
+    scratch_.assign(context_.relation_count(), nullptr);
+    use_index_ = index_scan(context_.get_table(slot_), ranges_, row_ids_);
+    row_it_ = context_.get_table(slot_).get_all_rows().begin();
+    if (!use_index_) {
+        zone_ranges_ = context_.get_table(slot_).get_zone_map().resolve(ranges_);
+    }
+}
+
+bool ScanOperator::next(RowTuple& tuple) {
+    if (!opened_) {
+        open();
+    }
+    if (tuple.size() != context_.relation_count()) {
+        tuple.assign(context_.relation_count(), nullptr);
+    }
+
+    const Table& table = context_.get_table(slot_);
+    while (true) {
+        const Row* row = nullptr;
+        if (use_index_) {
+            if (position_ >= row_ids_.size()) {
+                return false;
+            }
+            row = &table.get_row(row_ids_[position_++]);
+        } else {
+            const auto& rows = table.get_all_rows();
+            if (!zone_ranges_.empty() && row_it_ != rows.end() && row_it_->first >= zone_end_) {
+                row_it_ = table.get_zone_map().seek(rows, row_it_, rows.end(), zone_ranges_);
+                if (row_it_ != rows.end()) {
+                    zone_end_ = ZoneMap::block_end(row_it_->first);
+                }
+            }
+            if (row_it_ == rows.end()) {
+                return false;
+            }
+            row = &row_it_->second;
+            ++row_it_;
+        }
+
+        if (!filters_.empty()) {
+            scratch_[slot_] = row;
+            context_.bind(scratch_, slot_);
+            if (!context_.passes(filters_, kWhereClauseError)) {
+                continue;
+            }
+        }
+        tuple[slot_] = row;
+        return true;
+    }
+}
+
+std::vector<IndexedColumn> ScanOperator::indexed_columns(const Table& table, const std::vector<ColumnRange>& ranges) {
+    IndexChoice choice = choose_index(table, ranges);
+    std::vector<IndexedColumn> columns;
+    if (choice.range != nullptr) {
+        columns.push_back(IndexedColumn{choice.range->column, false});
+    } else if (choice.index != nullptr) {
+        for (const auto& column : choice.index->get_columns()) {
+            columns.push_back(IndexedColumn{column, true});
+        }
+    }
+    return columns;
+}
+
+std::vector<const Row*> ScanOperator::collect(ExecutionContext& context, size_t slot,
+                                              const std::vector<ColumnRange>& ranges,
+                                              const std::vector<const Expression*>& filters) {
+    ScanOperator scan(context, slot, ranges, filters);
+    std::vector<const Row*> rows;
+    RowTuple tuple;
+    while (scan.next(tuple)) {
+        rows.push_back(tuple[slot]);
+    }
+    return rows;
+}
+
+OrderedIndexScanOperator::OrderedIndexScanOperator(ExecutionContext& context, size_t slot, const Index* index,
+                                                   const std::optional<ColumnRange>& range, bool descending)
+    : context_(context), slot_(slot), descending_(descending) {
+    const auto& entries = index->get_ordered_entries();
+    begin_ = entries.begin();
+    end_ = entries.end();
+    if (range.has_value() && range->lower.has_value()) {
+        begin_ = range->lower_inclusive ? entries.lower_bound(*range->lower) : entries.upper_bound(*range->lower);
+    }
+    if (range.has_value() && range->upper.has_value()) {
+        end_ = range->upper_inclusive ? entries.upper_bound(*range->upper) : entries.lower_bound(*range->upper);
+    }
+    if (range.has_value() && range->lower.has_value() && range->upper.has_value() &&
+        (*range->upper < *range->lower || (*range->upper == *range->lower && !(range->lower_inclusive && range->upper_inclusive)))) {
+        end_ = begin_;
+    }
+}
+
+bool OrderedIndexScanOperator::next(RowTuple& tuple) {
+    if (tuple.size() != context_.relation_count()) {
+        tuple.assign(context_.relation_count(), nullptr);
+    }
+    if (begin_ == end_) {
+        return false;
+    }
+    RowID row_id = descending_ ? (--end_)->second : (begin_++)->second;
+    tuple[slot_] = &context_.get_table(slot_).get_row(row_id);
+    return true;
+}
+
+FilterOperator::FilterOperator(ExecutionContext& context, std::unique_ptr<Operator> child,
+                               std::vector<const Expression*> conditions, std::string error_message)
+    : context_(context), child_(std::move(child)), conditions_(std::move(conditions)), error_message_(std::move(error_message)) {}
+
+bool FilterOperator::next(RowTuple& tuple) {
+    while (child_->next(tuple)) {
+        context_.bind(tuple);
+        if (context_.passes(conditions_, error_message_)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+JoinOperator::JoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                           std::vector<const Expression*> inner_filters, std::vector<const Expression*> conditions)
+    : context_(context), inner_slot_(inner_slot), inner_filters_(std::move(inner_filters)),
+      conditions_(std::move(conditions)), outer_(std::move(outer)) {}
+
+bool JoinOperator::next(RowTuple& tuple) {
+    while (true) {
+        while (match_position_ < matches_.size()) {
+            tuple = outer_tuple_;
+            tuple[inner_slot_] = matches_[match_position_++];
+            if (conditions_.empty()) {
+                return true;
+            }
+            context_.bind(tuple);
+            if (context_.passes(conditions_, kJoinConditionError)) {
+                return true;
+            }
+        }
+
+        if (outer_tuple_.size() != context_.relation_count()) {
+            outer_tuple_.assign(context_.relation_count(), nullptr);
+        }
+        if (!outer_->next(outer_tuple_)) {
+            return false;
+        }
+        matches_.clear();
+        match_position_ = 0;
+        find_matches(outer_tuple_, matches_);
+    }
+}
+
+bool JoinOperator::inner_passes(const Row& row) {
+    if (inner_filters_.empty()) {
+        return true;
+    }
+    if (scratch_.size() != context_.relation_count()) {
+        scratch_.assign(context_.relation_count(), nullptr);
+    }
+    scratch_[inner_slot_] = &row;
+    context_.bind(scratch_, inner_slot_);
+    return context_.passes(inner_filters_, kWhereClauseError);
+}
+
+NestedLoopJoinOperator::NestedLoopJoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                                               std::vector<ColumnRange> inner_ranges, std::vector<const Expression*> inner_filters,
+                                               std::vector<const Expression*> conditions)
+    : JoinOperator(context, std::move(outer), inner_slot, std::move(inner_filters), std::move(conditions)),
+      inner_ranges_(std::move(inner_ranges)) {}
+
+void NestedLoopJoinOperator::find_matches(const RowTuple&, std::vector<const Row*>& matches) {
+    if (!inner_rows_.has_value()) {
+        inner_rows_ = ScanOperator::collect(context_, inner_slot_, inner_ranges_, inner_filters_);
+    }
+    matches = *inner_rows_;
+}
+
+HashJoinOperator::HashJoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                                   std::vector<ColumnRange> inner_ranges, std::vector<const Expression*> inner_filters,
+                                   std::vector<const Expression*> conditions, std::vector<TupleKey> keys, bool build_outer)
+    : JoinOperator(context, std::move(outer), inner_slot, std::move(inner_filters), std::move(conditions)),
+      inner_ranges_(std::move(inner_ranges)), keys_(std::move(keys)), build_outer_(build_outer) {
+    for (const auto& key : keys_) {
+        inner_columns_.push_back(key.inner_column);
+    }
+}
+
+bool HashJoinOperator::outer_key(const RowTuple& tuple, size_t& hash) const {
+    hash = 0;
+    for (const auto& key : keys_) {
+        const auto& value = tuple[key.outer_slot]->get_values()[key.outer_column];
+        if (!value.has_value()) {
+            return false;
+        }
+        combine_hash(hash, *value);
+    }
+    return true;
+}
+
+bool HashJoinOperator::inner_key(const Row& row, size_t& hash) const {
+    hash = 0;
+    for (size_t column : inner_columns_) {
+        const auto& value = row.get_values()[column];
+        if (!value.has_value()) {
+            return false;
+        }
+        combine_hash(hash, *value);
+    }
+    return true;
+}
+
+bool HashJoinOperator::keys_match(const RowTuple& tuple, const Row& row) const {
+    for (const auto& key : keys_) {
+        if (!values_equal(tuple[key.outer_slot]->get_values()[key.outer_column], row.get_values()[key.inner_column])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HashJoinOperator::find_matches(const RowTuple& outer, std::vector<const Row*>& matches) {
+    if (!built_) {
+        std::vector<const Row*> inner_rows = ScanOperator::collect(context_, inner_slot_, inner_ranges_, inner_filters_);
+        hash_table_.reserve(inner_rows.size());
+        for (const Row* row : inner_rows) {
+            size_t hash = 0;
+            if (inner_key(*row, hash)) {
+                hash_table_[hash].push_back(row);
+            }
+        }
+        built_ = true;
+    }
+
+    size_t hash = 0;
+    if (!outer_key(outer, hash)) {
+        return;
+    }
+    auto bucket = hash_table_.find(hash);
+    if (bucket == hash_table_.end()) {
+        return;
+    }
+    for (const Row* row : bucket->second) {
+        if (keys_match(outer, *row)) {
+            matches.push_back(row);
+        }
+    }
+}
+
+void HashJoinOperator::build_on_outer() {
+    built_ = true;
+    RowTuple tuple(context_.relation_count(), nullptr);
+    std::unordered_map<size_t, std::vector<size_t>> outer_table;
+    while (outer_next(tuple)) {
+        size_t hash = 0;
+        if (outer_key(tuple, hash)) {
+            outer_table[hash].push_back(outer_tuples_.size());
+            outer_tuples_.push_back(tuple);
+        }
+    }
+
+    for (const Row* row : ScanOperator::collect(context_, inner_slot_, inner_ranges_, inner_filters_)) {
+        size_t hash = 0;
+        if (!inner_key(*row, hash)) {
+            continue;
+        }
+        auto bucket = outer_table.find(hash);
+        if (bucket == outer_table.end()) {
+            continue;
+        }
+        for (size_t outer_index : bucket->second) {
+            if (keys_match(outer_tuples_[outer_index], *row)) {
+                pairs_.emplace_back(outer_index, row);
+            }
+        }
+    }
+
+    std::sort(pairs_.begin(), pairs_.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : a.second->get_id() < b.second->get_id();
+    });
+}
+
+void HashJoinOperator::build_partitioned() {
+    built_ = true;
+    ThreadPool& pool = *context_.get_thread_pool();
+    size_t workers = context_.get_workers();
+    size_t grain = context_.get_morsel_size();
+
+    RowTuple tuple(context_.relation_count(), nullptr);
+    while (outer_next(tuple)) {
+        outer_tuples_.push_back(tuple);
+    }
+    std::vector<const Row*> inner_rows = ScanOperator::collect(context_, inner_slot_, inner_ranges_, inner_filters_);
+
+    auto outer_grains = hash_entries(pool, workers, outer_tuples_.size(), grain, [&](size_t i, size_t& hash) {
+        return outer_key(outer_tuples_[i], hash);
+    });
+    auto inner_grains = hash_entries(pool, workers, inner_rows.size(), grain, [&](size_t i, size_t& hash) {
+        return inner_key(*inner_rows[i], hash);
+    });
+
+    // At least one partition per worker, and few enough inner entries per
+    // partition for them and their buckets to stay in L2.
+    size_t inner_count = 0;
+    for (const auto& entries : inner_grains) {
+        inner_count += entries.size();
+    }
+    size_t bits = 0;
+    while (bits < kMaxRadixBits &&
+           ((size_t(1) << bits) < workers || (inner_count >> bits) * kPartitionEntryBytes > kL2CacheBytes)) {
+        ++bits;
+    }
+    size_t partitions = size_t(1) << bits;
+
+    std::vector<size_t> outer_bounds;
+    std::vector<size_t> inner_bounds;
+    std::vector<HashedEntry> outer_entries = radix_partition(pool, workers, outer_grains, bits, outer_bounds);
+    std::vector<HashedEntry> inner_entries = radix_partition(pool, workers, inner_grains, bits, inner_bounds);
+    std::vector<std::vector<HashedEntry>>().swap(outer_grains);
+    std::vector<std::vector<HashedEntry>>().swap(inner_grains);
+
+    // Each outer tuple lives in exactly one partition, so its match count is
+    // only ever written by one worker.
+    std::vector<size_t> match_offsets(outer_tuples_.size(), 0);
+    std::vector<std::vector<std::pair<size_t, const Row*>>> partition_pairs(partitions);
+    pool.run(partitions, [&](size_t p) {
+        size_t inner_begin = inner_bounds[p];
+        size_t inner_size = inner_bounds[p + 1] - inner_begin;
+        if (inner_size == 0) {
+            return;
+        }
+        size_t buckets = 1;
+        while (buckets < 2 * inner_size) {
+            buckets *= 2;
+        }
+        // Chains are linked back to front so that they list rows in inner order.
+        std::vector<size_t> heads(buckets, kNoEntry);
+        std::vector<size_t> chain(inner_size);
+        for (size_t i = inner_size; i-- > 0;) {
+            size_t bucket = (inner_entries[inner_begin + i].hash >> bits) & (buckets - 1);
+            chain[i] = heads[bucket];
+            heads[bucket] = i;
+        }
+
+        auto& pairs = partition_pairs[p];
+        for (size_t o = outer_bounds[p]; o < outer_bounds[p + 1]; ++o) {
+            const HashedEntry& outer = outer_entries[o];
+            for (size_t i = heads[(outer.hash >> bits) & (buckets - 1)]; i != kNoEntry; i = chain[i]) {
+                const HashedEntry& inner = inner_entries[inner_begin + i];
+                const Row* row = inner_rows[inner.index];
+                if (inner.hash == outer.hash && keys_match(outer_tuples_[outer.index], *row)) {
+                    pairs.emplace_back(outer.index, row);
+                    ++match_offsets[outer.index];
+                }
+            }
+        }
+    }, workers);
+
+    size_t total = 0;
+    for (auto& offset : match_offsets) {
+        size_t count = offset;
+        offset = total;
+        total += count;
+    }
+    pairs_.resize(total);
+    pool.run(partitions, [&](size_t p) {
+        for (const auto& pair : partition_pairs[p]) {
+            pairs_[match_offsets[pair.first]++] = pair;
+        }
+    }, workers);
+}
+
+bool HashJoinOperator::next(RowTuple& tuple) {
+    if (!build_outer_ && context_.get_thread_pool() == nullptr) {
+        return JoinOperator::next(tuple);
+    }
+    if (!built_) {
+        if (context_.get_thread_pool() != nullptr) {
+            build_partitioned();
+        } else {
+            build_on_outer();
+        }
+    }
+    while (pair_position_ < pairs_.size()) {
+        const auto& [outer_index, row] = pairs_[pair_position_++];
+        tuple = outer_tuples_[outer_index];
+        tuple[inner_slot_] = row;
+        if (conditions_.empty()) {
+            return true;
+        }
+        context_.bind(tuple);
+        if (context_.passes(conditions_, kJoinConditionError)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+IndexJoinOperator::IndexJoinOperator(ExecutionContext& context, std::unique_ptr<Operator> outer, size_t inner_slot,
+                                     std::vector<const Expression*> inner_filters, std::vector<const Expression*> conditions,
+                                     const Index* index, std::vector<TupleKey> keys, std::vector<TupleRange> ranges)
+    : JoinOperator(context, std::move(outer), inner_slot, std::move(inner_filters), std::move(conditions)),
+      index_(index), keys_(std::move(keys)), ranges_(std::move(ranges)) {}
+
+void IndexJoinOperator::find_matches(const RowTuple& outer, std::vector<const Row*>& matches) {
+    const Table& inner_table = context_.get_table(inner_slot_);
+    std::vector<RowID> matched_ids;
+
+    if (!keys_.empty()) {
+        for (const auto& key : keys_) {
+            const auto& value = outer[key.outer_slot]->get_values()[key.outer_column];
+            if (!value.has_value()) {
+                return;
+            }
+            probe_[inner_table.get_columns()[key.inner_column].get_name()] = *value;
+        }
+        if (index_->get_type() == IndexType::Ordered) {
+            const std::string& column = index_->get_columns()[0];
+            const Value& key = probe_.at(column);
+            matched_ids = index_->search_ordered(column, key, true, key, true);
+        } else {
+            matched_ids = index_->search_unordered(probe_);
+        }
+    } else {
+        std::optional<Value> lower;
+        std::optional<Value> upper;
+        bool lower_inclusive = true;
+        bool upper_inclusive = true;
+        for (const auto& range : ranges_) {
+            const auto& value = outer[range.outer_slot]->get_values()[range.outer_column];
+            if (!value.has_value()) {
+                return;
+            }
+            bool inclusive = range.op == BinaryExpression::Operator::GreaterEqual || range.op == BinaryExpression::Operator::LessEqual;
+            if (range.op == BinaryExpression::Operator::Greater || range.op == BinaryExpression::Operator::GreaterEqual) {
+                if (!lower || *lower < *value || (*lower == *value && !inclusive)) {
+                    lower = *value;
+                    lower_inclusive = inclusive;
+                }
+            } else if (!upper || *value < *upper || (*upper == *value && !inclusive)) {
+                upper = *value;
+                upper_inclusive = inclusive;
+            }
+        }
+        matched_ids = index_->search_ordered(index_->get_columns()[0], lower, lower_inclusive, upper, upper_inclusive);
+    }
+
+    std::sort(matched_ids.begin(), matched_ids.end());
+    for (RowID row_id : matched_ids) {
+        const Row& row = inner_table.get_row(row_id);
+        bool keys_equal = std::all_of(keys_.begin(), keys_.end(), [&](const TupleKey& key) {
+            return values_equal(outer[key.outer_slot]->get_values()[key.outer_column], row.get_values()[key.inner_column]);
+        });
+        if (keys_equal && inner_passes(row)) {
+            matches.push_back(&row);
+        }
+    }
+}
+
+MergeJoinOperator::MergeJoinOperator(ExecutionContext& context,
+                                     size_t left_slot, const Index* left_index, std::vector<const Expression*> left_filters,
+                                     size_t right_slot, const Index* right_index, std::vector<const Expression*> right_filters,
+                                     std::vector<TupleKey> keys, std::vector<const Expression*> conditions)
+    : context_(context), left_slot_(left_slot), right_slot_(right_slot),
+      left_filters_(std::move(left_filters)), right_filters_(std::move(right_filters)),
+      keys_(std::move(keys)), conditions_(std::move(conditions)),
+      left_it_(left_index->get_ordered_entries().begin()), left_end_(left_index->get_ordered_entries().end()),
+      right_it_(right_index->get_ordered_entries().begin()), right_end_(right_index->get_ordered_entries().end()),
+      scratch_(context.relation_count(), nullptr) {}
+
+bool MergeJoinOperator::side_passes(size_t slot, const std::vector<const Expression*>& filters, const Row& row) {
+    if (filters.empty()) {
+        return true;
+    }
+    scratch_[slot] = &row;
+    context_.bind(scratch_, slot);
+    return context_.passes(filters, kWhereClauseError);
+}
+
+bool MergeJoinOperator::next_group() {
+    const Table& left_table = context_.get_table(left_slot_);
+    const Table& right_table = context_.get_table(right_slot_);
+
+    while (left_it_ != left_end_ && right_it_ != right_end_) {
+        if (left_it_->first < right_it_->first) {
+            ++left_it_;
+            continue;
+        }
+        if (right_it_->first < left_it_->first) {
+            ++right_it_;
+            continue;
+        }
+
+        const Value key = left_it_->first;
+        right_group_.clear();
+        for (; right_it_ != right_end_ && right_it_->first == key; ++right_it_) {
+            const Row& row = right_table.get_row(right_it_->second);
+            if (side_passes(right_slot_, right_filters_, row)) {
+                right_group_.push_back(&row);
+            }
+        }
+        left_group_.clear();
+        for (; left_it_ != left_end_ && left_it_->first == key; ++left_it_) {
+            const Row& row = left_table.get_row(left_it_->second);
+            if (!right_group_.empty() && side_passes(left_slot_, left_filters_, row)) {
+                left_group_.push_back(&row);
+            }
+        }
+
+        left_position_ = 0;
+        right_position_ = 0;
+        if (!left_group_.empty() && !right_group_.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MergeJoinOperator::next(RowTuple& tuple) {
+    if (tuple.size() != context_.relation_count()) {
+        tuple.assign(context_.relation_count(), nullptr);
+    }
+
+    while (true) {
+        if (left_position_ >= left_group_.size()) {
+            if (!next_group()) {
+                return false;
+            }
+        }
+        if (right_position_ >= right_group_.size()) {
+            ++left_position_;
+            right_position_ = 0;
+            continue;
+        }
+
+        const Row* left = left_group_[left_position_];
+        const Row* right = right_group_[right_position_++];
+        bool keys_equal = std::all_of(keys_.begin(), keys_.end(), [&](const TupleKey& key) {
+            return values_equal(left->get_values()[key.outer_column], right->get_values()[key.inner_column]);
+        });
+        if (!keys_equal) {
+            continue;
+        }
+
+        tuple[left_slot_] = left;
+        tuple[right_slot_] = right;
+        if (conditions_.empty()) {
+            return true;
+        }
+        context_.bind(tuple);
+        if (context_.passes(conditions_, kJoinConditionError)) {
+            return true;
+        }
+    }
+}
+
+}
+}
\ No newline at end of file
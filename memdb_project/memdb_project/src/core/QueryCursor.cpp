@@ -0,0 +1,455 @@
+#include "memdb/core/QueryCursor.h"
+#include "memdb/core/QueryPlanner.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+const size_t kParallelSortThreshold = 1 << 16;
+
+// Sorts chunks of a large input on the pool's workers, then merges adjacent
+// chunks pairwise until one run is left.
+template <typename T, typename Less>
+void parallel_sort(std::vector<T>& items, Less less, ThreadPool* pool, size_t workers) {
+    size_t chunks = std::min<size_t>(workers, items.size() / (kParallelSortThreshold / 4));
+    if (pool == nullptr || items.size() < kParallelSortThreshold || chunks < 2) {
+        std::sort(items.begin(), items.end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t c = 0; c <= chunks; ++c) {
+        bounds.push_back(items.size() * c / chunks);
+    }
+
+    pool->run(chunks, [&](size_t c) {
+        std::sort(items.begin() + bounds[c], items.begin() + bounds[c + 1], less);
+    }, workers);
+
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged = { 0 };
+        for (size_t c = 0; c + 2 < bounds.size(); c += 2) {
+            merged.push_back(bounds[c + 2]);
+        }
+        if ((bounds.size() - 1) % 2 == 1) {
+            merged.push_back(bounds.back());
+        }
+        pool->run((bounds.size() - 1) / 2, [&](size_t pair) {
+            size_t c = 2 * pair;
+            std::inplace_merge(items.begin() + bounds[c], items.begin() + bounds[c + 1], items.begin() + bounds[c + 2], less);
+        }, workers);
+        bounds = std::move(merged);
+    }
+}
+
+// Calls `visit` with the index of every tuple in [begin, end) that passes
+// `filter`, which is evaluated a batch at a time.
+template <typename Visit>
+void for_each_match(const CompiledFilter& filter, const std::vector<RowTuple>& tuples, size_t begin, size_t end,
+                    Visit visit) {
+    std::vector<uint32_t> selection;
+    for (size_t batch = begin; batch < end; batch += CompiledFilter::kBatchSize) {
+        size_t batch_end = std::min(end, batch + CompiledFilter::kBatchSize);
+        bool exact = filter.select(tuples, batch, batch_end, selection);
+        for (uint32_t i : selection) {
+            if (exact || filter.matches(tuples[i])) {
+                visit(i);
+            }
+        }
+    }
+}
+
+int compare_keys(const std::optional<Value>& left, const std::optional<Value>& right) {
+    if (!left.has_value() || !right.has_value()) {
+        return static_cast<int>(right.has_value()) - static_cast<int>(left.has_value());
+    }
+    if (*left < *right) {
+        return -1;
+    }
+    return *right < *left ? 1 : 0;
+}
+
+}
+
+QueryCursor::QueryCursor(const ParsedQuery& query,
+                         std::shared_ptr<const ParsedQuery> owner,
+                         std::unique_ptr<ExecutionContext> context,
+                         std::unique_ptr<Operator> root,
+                         std::vector<ColumnInfo> columns,
+                         std::vector<const Expression*> where,
+                         bool aliases_in_where,
+                         bool presorted,
+                         std::unique_ptr<HashAggregator> aggregator,
+                         CompiledFilter filter)
+    : query_(&query), owner_(std::move(owner)), context_(std::move(context)), root_(std::move(root)),
+      columns_(std::move(columns)), where_(std::move(where)), filter_(std::move(filter)), aliases_in_where_(aliases_in_where),
+      sort_(!query.order_by.empty() && !presorted), aggregator_(std::move(aggregator)),
+      pool_(context_->get_thread_pool()), workers_(context_->get_workers()), morsel_size_(context_->get_morsel_size()) {
+    for (const auto& select_item : query_->select_items) {
+        aliases_.push_back(select_item.alias.empty() ? select_item.expression->to_string() : select_item.alias);
+
+        // Aggregates and GROUP BY keys are NULL when absent from a group's row.
+        std::string text = select_item.expression->to_string();
+        bool grouped = dynamic_cast<const AggregateExpression*>(select_item.expression.get()) != nullptr;
+        for (const auto& key : query_->group_by) {
+            grouped = grouped || key->to_string() == text;
+        }
+        grouped_items_.push_back(grouped);
+    }
+
+    // A key naming a table column reads as NULL when the column is NULL
+    // instead of failing the query.
+    for (const auto& order_item : query_->order_by) {
+        auto variable = dynamic_cast<const VariableExpression*>(order_item.expression.get());
+        bool is_column = false;
+        for (size_t slot = 0; variable && slot < context_->relation_count(); ++slot) {
+            const auto& names = context_->get_names(slot);
+            is_column = is_column || std::find(names.begin(), names.end(), variable->get_name()) != names.end();
+        }
+        key_columns_.push_back(is_column ? variable : nullptr);
+    }
+
+    std::vector<const Expression*> items;
+    for (const auto& select_item : query_->select_items) {
+        items.push_back(select_item.expression.get());
+    }
+    if (aliases_in_where_) {
+        where_items_ = QueryPlanner::where_dependencies(items, aliases_, where_);
+    }
+
+    // Subtrees repeated across the select list and the interpreted WHERE
+    // conjuncts are evaluated once per row. An alias that is not the column
+    // of the same name shadows it for the expressions after it.
+    if (!aggregator_) {
+        std::unordered_set<std::string> shadowed;
+        for (size_t i = 0; aliases_in_where_ && i < items.size(); ++i) {
+            auto variable = dynamic_cast<const VariableExpression*>(items[i]);
+            if (!variable || variable->get_name() != aliases_[i]) {
+                shadowed.insert(aliases_[i]);
+            }
+        }
+        items.insert(items.end(), where_.begin(), where_.end());
+        shared_slots_ = QueryPlanner::share_subexpressions(items, shadowed);
+    }
+}
+
+bool QueryCursor::next(std::vector<std::optional<Value>>& row) {
+    if (query_->limit.has_value() && produced_ >= *query_->limit) {
+        return false;
+    }
+    while (pull(row)) {
+        if (skipped_ < query_->offset) {
+            ++skipped_;
+            continue;
+        }
+        ++produced_;
+        return true;
+    }
+    return false;
+}
+
+bool QueryCursor::pull(std::vector<std::optional<Value>>& row) {
+    if (!sort_) {
+        return produce(row);
+    }
+    if (!sorted_) {
+        sort_rows();
+    }
+    if (sorted_position_ >= sorted_rows_.size()) {
+        return false;
+    }
+    row = std::move(sorted_rows_[sorted_position_++].values);
+    return true;
+}
+
+bool QueryCursor::produce(std::vector<std::optional<Value>>& row, std::vector<std::optional<Value>>* keys) {
+    if (aggregator_) {
+        if (!produce_group(row)) {
+            return false;
+        }
+        if (keys != nullptr) {
+            *keys = order_keys(row, group_map_);
+        }
+        return true;
+    }
+    if (pool_ != nullptr) {
+        return produce_batch(row, keys);
+    }
+
+    while (const RowTuple* tuple = next_tuple()) {
+        auto& row_map = context_->bind(*tuple);
+        if (evaluate(row_map, row)) {
+            if (keys != nullptr) {
+                *keys = order_keys(row, row_map);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool QueryCursor::evaluate(std::unordered_map<std::string, Value>& row_map, std::vector<std::optional<Value>>& row) const {
+    SubexpressionCache::Scope shared(shared_slots_);
+    const auto& select_items = query_->select_items;
+    if (aliases_in_where_) {
+        // Single-table queries evaluate the select items WHERE refers to
+        // first, and the rest only for rows that pass.
+        for (size_t i = 0; i < select_items.size(); ++i) {
+            if (where_items_[i]) {
+                row_map[aliases_[i]] = select_items[i].expression->evaluate(row_map);
+            }
+        }
+        if (!ExecutionContext::passes(row_map, where_, "WHERE clause does not evaluate to a boolean.")) {
+            return false;
+        }
+        for (size_t i = 0; i < select_items.size(); ++i) {
+            if (!where_items_[i]) {
+                row_map[aliases_[i]] = select_items[i].expression->evaluate(row_map);
+            }
+        }
+        row.clear();
+        for (const auto& alias : aliases_) {
+            row.emplace_back(row_map.at(alias));
+        }
+        return true;
+    }
+
+    if (!ExecutionContext::passes(row_map, where_, "WHERE clause does not evaluate to a boolean.")) {
+        return false;
+    }
+    row.clear();
+    for (const auto& select_item : select_items) {
+        try {
+            row.emplace_back(select_item.expression->evaluate(row_map));
+        } catch (const std::exception& e) {
+            throw std::runtime_error("Error evaluating expression in SELECT clause: " + std::string(e.what()));
+        }
+    }
+    return true;
+}
+
+bool QueryCursor::produce_batch(std::vector<std::optional<Value>>& row, std::vector<std::optional<Value>>* keys) {
+    while (batch_position_ >= batch_.size()) {
+        if (exhausted_) {
+            return false;
+        }
+        fill_batch();
+    }
+    SortedRow& produced = batch_[batch_position_++];
+    row = std::move(produced.values);
+    if (keys != nullptr) {
+        *keys = std::move(produced.keys);
+    }
+    return true;
+}
+
+// Pulls up to `capacity` tuples from the pipeline; false once the pipeline is
+// exhausted and nothing was pulled.
+bool QueryCursor::pull_tuples(size_t capacity) {
+    tuples_.clear();
+    while (tuples_.size() < capacity && root_->next(tuple_)) {
+        tuples_.push_back(tuple_);
+    }
+    exhausted_ = tuples_.size() < capacity;
+    return !tuples_.empty();
+}
+
+// Returns the next tuple that passes the compiled filter, or nullptr once
+// the pipeline is exhausted. Without ORDER BY a batch never pulls more
+// tuples than LIMIT may still return.
+const RowTuple* QueryCursor::next_tuple() {
+    for (;;) {
+        while (selection_position_ < selection_.size()) {
+            const RowTuple& tuple = tuples_[selection_[selection_position_++]];
+            if (selected_exactly_ || filter_.matches(tuple)) {
+                return &tuple;
+            }
+        }
+
+        size_t capacity = CompiledFilter::kBatchSize;
+        if (query_->limit.has_value() && !sort_ && !aggregator_) {
+            size_t wanted = *query_->limit + query_->offset - produced_ - skipped_;
+            capacity = std::max<size_t>(1, std::min(capacity, wanted));
+        }
+        if (exhausted_ || !pull_tuples(capacity)) {
+            return nullptr;
+        }
+        selected_exactly_ = filter_.select(tuples_, 0, tuples_.size(), selection_);
+        selection_position_ = 0;
+    }
+}
+
+// Evaluates each morsel of the pulled tuples on its own worker with a private
+// row map.
+void QueryCursor::fill_batch() {
+    pull_tuples(morsel_size_ * workers_);
+
+    std::vector<std::vector<SortedRow>> morsels((tuples_.size() + morsel_size_ - 1) / morsel_size_);
+    pool_->parallel_for(tuples_.size(), morsel_size_, [&](size_t begin, size_t end) {
+        auto& morsel = morsels[begin / morsel_size_];
+        std::unordered_map<std::string, Value> row_map;
+        for_each_match(filter_, tuples_, begin, end, [&](size_t i) {
+            context_->bind_into(tuples_[i], row_map);
+            SortedRow produced{{}, {}, 0};
+            if (evaluate(row_map, produced.values)) {
+                if (sort_) {
+                    produced.keys = order_keys(produced.values, row_map);
+                }
+                morsel.push_back(std::move(produced));
+            }
+        });
+    }, workers_);
+
+    batch_.clear();
+    batch_position_ = 0;
+    for (auto& morsel : morsels) {
+        std::move(morsel.begin(), morsel.end(), std::back_inserter(batch_));
+    }
+}
+
+// Every row that passes WHERE is fed to the aggregator before the first group
+// is returned; the select list is then evaluated over each group's keys and
+// aggregate results.
+bool QueryCursor::produce_group(std::vector<std::optional<Value>>& row) {
+    if (!aggregated_) {
+        aggregated_ = true;
+        if (pool_ != nullptr) {
+            aggregate_parallel();
+        } else {
+            while (const RowTuple* tuple = next_tuple()) {
+                auto& row_map = context_->bind(*tuple);
+                if (context_->passes(where_, "WHERE clause does not evaluate to a boolean.")) {
+                    aggregator_->add(row_map);
+                }
+            }
+        }
+    }
+    if (!aggregator_->next(group_map_)) {
+        return false;
+    }
+
+    const auto& select_items = query_->select_items;
+    row.clear();
+    for (size_t i = 0; i < select_items.size(); ++i) {
+        auto value = group_map_.find(select_items[i].expression->to_string());
+        if (value != group_map_.end()) {
+            row.emplace_back(value->second);
+        } else if (grouped_items_[i]) {
+            row.emplace_back(std::nullopt);
+        } else {
+            row.emplace_back(select_items[i].expression->evaluate(group_map_));
+        }
+    }
+    return true;
+}
+
+// Every morsel is pre-aggregated into a partial aggregator on a worker; the
+// partials are then merged in morsel order.
+void QueryCursor::aggregate_parallel() {
+    while (!exhausted_ && pull_tuples(morsel_size_ * workers_)) {
+        std::vector<std::unique_ptr<HashAggregator>> partials((tuples_.size() + morsel_size_ - 1) / morsel_size_);
+        pool_->parallel_for(tuples_.size(), morsel_size_, [&](size_t begin, size_t end) {
+            auto partial = aggregator_->partial(end - begin);
+            std::unordered_map<std::string, Value> row_map;
+            for_each_match(filter_, tuples_, begin, end, [&](size_t i) {
+                context_->bind_into(tuples_[i], row_map);
+                if (ExecutionContext::passes(row_map, where_, "WHERE clause does not evaluate to a boolean.")) {
+                    partial->add(row_map);
+                }
+            });
+            partials[begin / morsel_size_] = std::move(partial);
+        }, workers_);
+
+        for (auto& partial : partials) {
+            aggregator_->merge(*partial);
+        }
+    }
+}
+
+std::vector<std::optional<Value>> QueryCursor::order_keys(const std::vector<std::optional<Value>>& row,
+                                                          std::unordered_map<std::string, Value>& row_map) const {
+    if (!aliases_in_where_) {
+        for (size_t i = 0; i < aliases_.size(); ++i) {
+            if (row[i].has_value()) {
+                row_map[aliases_[i]] = *row[i];
+            } else {
+                row_map.erase(aliases_[i]);
+            }
+        }
+    }
+
+    std::vector<std::optional<Value>> keys;
+    keys.reserve(query_->order_by.size());
+    for (size_t i = 0; i < query_->order_by.size(); ++i) {
+        if (key_columns_[i] != nullptr && row_map.count(key_columns_[i]->get_name()) == 0) {
+            keys.emplace_back(std::nullopt);
+        } else {
+            keys.emplace_back(query_->order_by[i].expression->evaluate(row_map));
+        }
+    }
+    return keys;
+}
+
+// NULL keys sort before every value, and after them when descending. Ties keep
+// the order in which the pipeline produced the rows.
+bool QueryCursor::row_less(const SortedRow& left, const SortedRow& right) const {
+    for (size_t i = 0; i < left.keys.size(); ++i) {
+        int order = compare_keys(left.keys[i], right.keys[i]);
+        if (order != 0) {
+            return query_->order_by[i].descending ? order > 0 : order < 0;
+        }
+    }
+    return left.sequence < right.sequence;
+}
+
+void QueryCursor::sort_rows() {
+    sorted_ = true;
+    auto less = [this](const SortedRow& left, const SortedRow& right) { return row_less(left, right); };
+
+    std::optional<size_t> capacity;
+    if (query_->limit.has_value() && *query_->limit <= std::numeric_limits<size_t>::max() - query_->offset) {
+        capacity = *query_->limit + query_->offset;
+    }
+
+    std::vector<std::optional<Value>> row;
+    std::vector<std::optional<Value>> keys;
+    size_t sequence = 0;
+    while (produce(row, &keys)) {
+        SortedRow sorted_row{std::move(keys), std::move(row), sequence++};
+        if (!capacity.has_value()) {
+            sorted_rows_.push_back(std::move(sorted_row));
+        } else if (sorted_rows_.size() < *capacity) {
+            sorted_rows_.push_back(std::move(sorted_row));
+            std::push_heap(sorted_rows_.begin(), sorted_rows_.end(), less);
+        } else if (*capacity > 0 && less(sorted_row, sorted_rows_.front())) {
+            std::pop_heap(sorted_rows_.begin(), sorted_rows_.end(), less);
+            sorted_rows_.back() = std::move(sorted_row);
+            std::push_heap(sorted_rows_.begin(), sorted_rows_.end(), less);
+        }
+    }
+
+    if (capacity.has_value()) {
+        std::sort_heap(sorted_rows_.begin(), sorted_rows_.end(), less);
+    } else {
+        parallel_sort(sorted_rows_, less, pool_, workers_);
+    }
+}
+
+std::vector<std::vector<std::optional<Value>>> QueryCursor::fetch(size_t max_rows) {
+    std::vector<std::vector<std::optional<Value>>> rows;
+    std::vector<std::optional<Value>> row;
+    while (rows.size() < max_rows && next(row)) {
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+}
+}
\ No newline at end of file
@@ -1,10 +1,16 @@
 #include "memdb/core/Database.h"
 #include "memdb/core/QueryExecutor.h"
+#include "memdb/core/CompiledFilter.h"
+#include "memdb/core/ExpressionOptimizer.h"
 #include "memdb/core/ExpressionParser.h"
+#include "memdb/core/HashAggregator.h"
+#include "memdb/core/Operator.h"
+#include "memdb/core/QueryPlanner.h"
 
 #include "memdb/core/exceptions/DatabaseException.h"
 #include "memdb/core/exceptions/TypeMismatchException.h"
 #include "memdb/core/structs/ColumnInfo.h"
+#include "memdb/core/structs/ColumnRange.h"
 
 #include <algorithm>
 #include <iostream>
@@ -16,7 +22,291 @@ namespace core {
 
 using json = nlohmann::json;
 
-QueryResult QueryExecutor::execute(const ParsedQuery& parsed_query, Database& db) {
+namespace {
+
+const std::string kJoinConditionError = "JOIN condition does not evaluate to a boolean.";
+const std::string kWhereClauseError = "WHERE clause does not evaluate to a boolean.";
+
+// A LIMIT without ORDER BY stops pulling rows early, which operators that
+// drain their input to work in parallel would defeat.
+void set_parallelism(ExecutionContext& context, const ParsedQuery& pq, Database& db, const QueryOptions& options) {
+    if (!pq.limit.has_value() || !pq.order_by.empty()) {
+        context.set_parallelism(db.get_thread_pool(), options);
+    }
+}
+
+std::unordered_map<std::string, DataType> table_schema(const Table& table) {
+    std::unordered_map<std::string, DataType> schema;
+    for (const auto& column : table.get_columns()) {
+        schema.emplace(column.get_name(), column.get_type());
+    }
+    return schema;
+}
+
+std::unique_ptr<Expression> copy_expression(const std::unique_ptr<Expression>& expression) {
+    return expression ? ExpressionOptimizer::clone(*expression) : nullptr;
+}
+
+// bind() and the planner record types, kernels and shared subexpression slots
+// in the expression nodes, so every execution and every cursor works on its
+// own unbound copy of the query and a ParsedQuery can be run concurrently.
+std::shared_ptr<const ParsedQuery> copy_query(const ParsedQuery& pq) {
+    auto copy = std::make_shared<ParsedQuery>();
+    copy->type = pq.type;
+    copy->table_name = pq.table_name;
+    copy->table_alias = pq.table_alias;
+    copy->columns = pq.columns;
+    copy->insert_values = pq.insert_values;
+    copy->insert_named_values = pq.insert_named_values;
+    copy->insert_batch = pq.insert_batch;
+    for (const auto& select_item : pq.select_items) {
+        copy->select_items.push_back({ copy_expression(select_item.expression), select_item.alias });
+    }
+    copy->where_clause = copy_expression(pq.where_clause);
+    for (const auto& [col_name, expr] : pq.update_assignments) {
+        copy->update_assignments.emplace(col_name, copy_expression(expr));
+    }
+    copy->update_where_clause = copy_expression(pq.update_where_clause);
+    copy->delete_where_clause = copy_expression(pq.delete_where_clause);
+    copy->from_table = pq.from_table;
+    copy->index_type = pq.index_type;
+    copy->index_columns = pq.index_columns;
+    for (const auto& join : pq.joins) {
+        copy->joins.push_back({ join.table_name, join.table_alias, copy_expression(join.join_condition) });
+    }
+    for (const auto& expr : pq.group_by) {
+        copy->group_by.push_back(copy_expression(expr));
+    }
+    for (const auto& order_item : pq.order_by) {
+        copy->order_by.push_back({ copy_expression(order_item.expression), order_item.descending });
+    }
+    copy->limit = pq.limit;
+    copy->offset = pq.offset;
+    return copy;
+}
+
+// Binds a condition whose every conjunct must be boolean.
+void bind_condition(const Expression* condition, const std::unordered_map<std::string, DataType>& schema,
+                    const std::string& error_message) {
+    for (const Expression* conjunct : QueryPlanner::split_conjuncts(condition)) {
+        Type type = conjunct->bind(schema).get_type();
+        if (type != Type::Bool && type != Type::Unknown) {
+            throw std::invalid_argument(error_message);
+        }
+    }
+    if (condition != nullptr) {
+        condition->bind(schema);
+    }
+}
+
+// Resolves the types of every expression of a SELECT before any row is read,
+// so that ill-typed queries are rejected up front, and records the types of
+// the select list in `result_columns`. With `aliases_in_where` each select
+// item sees the aliases before it and WHERE sees all of them; ORDER BY always
+// sees them.
+void bind_select(const ParsedQuery& pq, const ExecutionContext& context, bool aliases_in_where,
+                 std::vector<ColumnInfo>& result_columns) {
+    std::unordered_map<std::string, DataType> schema;
+    for (size_t slot = 0; slot < context.relation_count(); ++slot) {
+        const auto& names = context.get_names(slot);
+        const auto& columns = context.get_table(slot).get_columns();
+        for (size_t i = 0; i < columns.size(); ++i) {
+            schema.emplace(names[i], columns[i].get_type());
+        }
+    }
+    for (const auto& join : pq.joins) {
+        bind_condition(join.join_condition.get(), schema, kJoinConditionError);
+    }
+    for (const auto& key : pq.group_by) {
+        key->bind(schema);
+    }
+
+    std::unordered_map<std::string, DataType> aliased = schema;
+    for (size_t i = 0; i < pq.select_items.size(); ++i) {
+        result_columns[i].type = pq.select_items[i].expression->bind(aliases_in_where ? aliased : schema);
+        aliased.insert_or_assign(result_columns[i].get_name(), result_columns[i].type);
+    }
+    bind_condition(pq.where_clause.get(), aliases_in_where ? aliased : schema, kWhereClauseError);
+    for (const auto& order_item : pq.order_by) {
+        order_item.expression->bind(aliased);
+    }
+}
+
+// Moves the conjuncts of `where` that have a compiled form into the returned
+// filter, unless the options ask for interpreted evaluation.
+CompiledFilter compile_where(const ExecutionContext& context, const QueryOptions& options,
+                             const std::unordered_set<std::string>& hidden, std::vector<const Expression*>& where) {
+    if (!options.compile_filters) {
+        return CompiledFilter();
+    }
+    std::vector<const Expression*> rest;
+    CompiledFilter filter = CompiledFilter::compile(where, context, hidden, options, rest);
+    where = std::move(rest);
+    return filter;
+}
+
+// Whether `conjunct` compares one of `columns` with a literal of its type in
+// a way the index read by the scan already guarantees for every row.
+bool answered_by_index(const Expression* conjunct, const Table& table, const std::vector<IndexedColumn>& columns) {
+    auto binary = dynamic_cast<const BinaryExpression*>(conjunct);
+    if (!binary) {
+        return false;
+    }
+    auto variable = dynamic_cast<const VariableExpression*>(binary->get_left());
+    auto literal = dynamic_cast<const LiteralExpression*>(binary->get_right());
+    if (!variable || !literal) {
+        variable = dynamic_cast<const VariableExpression*>(binary->get_right());
+        literal = dynamic_cast<const LiteralExpression*>(binary->get_left());
+    }
+    if (!variable || !literal || !literal->get_value().has_value() || !table.has_column(variable->get_name())) {
+        return false;
+    }
+    const auto& column = table.get_columns()[table.get_column_index(variable->get_name())];
+    if (column.get_type().get_type() != literal->get_value().get_type()) {
+        return false;
+    }
+
+    BinaryExpression::Operator op = binary->get_operator();
+    bool range = op == BinaryExpression::Operator::Less || op == BinaryExpression::Operator::LessEqual ||
+                 op == BinaryExpression::Operator::Greater || op == BinaryExpression::Operator::GreaterEqual;
+    return std::any_of(columns.begin(), columns.end(), [&](const IndexedColumn& indexed) {
+        return indexed.column == variable->get_name() &&
+               (op == BinaryExpression::Operator::Equal || (range && !indexed.equality_only));
+    });
+}
+
+// Whether `condition` is false or, once bound, a conjunction no row can
+// satisfy whose conjuncts cannot raise.
+bool never_holds(const Expression* condition) {
+    return ExpressionOptimizer::is_false(condition) ||
+           (condition != nullptr && !QueryPlanner::may_raise(condition) &&
+            ExpressionOptimizer::is_contradiction(QueryPlanner::split_conjuncts(condition)));
+}
+
+// Called after bind_select, so that an ill-typed contradiction is rejected
+// rather than answered with no rows.
+bool selects_nothing(const ParsedQuery& pq) {
+    return never_holds(pq.where_clause.get()) ||
+           std::any_of(pq.joins.begin(), pq.joins.end(), [](const JoinInfo& join) {
+               return never_holds(join.join_condition.get());
+           });
+}
+
+// Splits WHERE into conjuncts that mention the columns of a single table,
+// which can filter that table before it is joined, and the remainder. Each
+// list is in the order its conjuncts are to be evaluated.
+std::vector<std::vector<const Expression*>> push_down_where(const ParsedQuery& pq,
+                                                            const std::vector<std::string>& table_names,
+                                                            const std::unordered_map<std::string, DataType>& combined_schema,
+                                                            std::vector<const Expression*>& remaining) {
+    std::vector<std::vector<const Expression*>> filters(table_names.size());
+    std::unordered_set<std::string> distinct_names(table_names.begin(), table_names.end());
+    for (const Expression* conjunct : QueryPlanner::split_conjuncts(pq.where_clause.get())) {
+        std::vector<std::string> columns;
+        QueryPlanner::collect_columns(conjunct, columns);
+
+        size_t target = table_names.size();
+        for (const auto& column : columns) {
+            auto table_it = std::find(table_names.begin(), table_names.end(), QueryPlanner::column_qualifier(column));
+            size_t table = static_cast<size_t>(table_it - table_names.begin());
+            if (combined_schema.count(column) == 0 || (target != table_names.size() && target != table)) {
+                target = table_names.size();
+                break;
+            }
+            target = table;
+        }
+
+        if (target < table_names.size() && distinct_names.size() == table_names.size()) {
+            filters[target].push_back(conjunct);
+        } else {
+            remaining.push_back(conjunct);
+        }
+    }
+    for (auto& filter : filters) {
+        filter = QueryPlanner::order_conjuncts(std::move(filter));
+    }
+    remaining = QueryPlanner::order_conjuncts(std::move(remaining));
+    return filters;
+}
+
+std::vector<ColumnInfo> join_result_columns(const ParsedQuery& pq,
+                                            const std::unordered_map<std::string, DataType>& combined_schema) {
+    std::vector<ColumnInfo> result_columns;
+    for (const auto& select_item : pq.select_items) {
+        std::string aliased_name = select_item.alias.empty() ? select_item.expression->to_string() : select_item.alias;
+        auto variable = dynamic_cast<const VariableExpression*>(select_item.expression.get());
+        auto schema_it = variable ? combined_schema.find(variable->get_name()) : combined_schema.end();
+        if (schema_it != combined_schema.end()) {
+            result_columns.emplace_back(ColumnInfo(aliased_name, schema_it->second));
+        } else {
+            result_columns.emplace_back(ColumnInfo(aliased_name, select_item.expression->get_type()));
+        }
+    }
+    return result_columns;
+}
+
+// Builds the aggregation stage of a query with GROUP BY or aggregate calls in
+// its select list or ORDER BY; returns null for any other query.
+std::unique_ptr<HashAggregator> make_aggregator(const ParsedQuery& pq, const ExecutionContext& context, size_t memory_budget) {
+    std::vector<const AggregateExpression*> aggregates;
+    QueryPlanner::collect_aggregates(pq.where_clause.get(), aggregates);
+    if (!aggregates.empty()) {
+        throw std::invalid_argument("Aggregate functions are not allowed in WHERE.");
+    }
+    for (const auto& select_item : pq.select_items) {
+        QueryPlanner::collect_aggregates(select_item.expression.get(), aggregates);
+    }
+    for (const auto& order_item : pq.order_by) {
+        QueryPlanner::collect_aggregates(order_item.expression.get(), aggregates);
+    }
+    if (aggregates.empty() && pq.group_by.empty()) {
+        return nullptr;
+    }
+
+    std::vector<const Expression*> keys;
+    std::unordered_set<std::string> key_texts;
+    std::unordered_set<std::string> grouped_columns;
+    for (const auto& key : pq.group_by) {
+        keys.push_back(key.get());
+        key_texts.insert(key->to_string());
+        if (auto variable = dynamic_cast<const VariableExpression*>(key.get())) {
+            grouped_columns.insert(variable->get_name());
+        }
+    }
+    for (const auto& select_item : pq.select_items) {
+        if (key_texts.count(select_item.expression->to_string()) > 0) {
+            continue;
+        }
+        std::vector<std::string> columns;
+        QueryPlanner::collect_columns(select_item.expression.get(), columns);
+        for (const auto& column : columns) {
+            if (grouped_columns.count(column) == 0) {
+                throw std::invalid_argument("Column \"" + column + "\" must appear in GROUP BY or inside an aggregate function.");
+            }
+        }
+    }
+
+    std::unordered_set<std::string> columns;
+    size_t expected_rows = 0;
+    for (size_t slot = 0; slot < context.relation_count(); ++slot) {
+        columns.insert(context.get_names(slot).begin(), context.get_names(slot).end());
+        expected_rows = std::max(expected_rows, context.get_table(slot).get_all_rows().size());
+    }
+    return std::make_unique<HashAggregator>(std::move(keys), std::move(aggregates), std::move(columns), memory_budget, expected_rows);
+}
+
+const Index* find_ordered_index(const Table& table, const std::string& column) {
+    for (const auto& index : table.get_indexes()) {
+        if (index->get_type() == IndexType::Ordered && index->get_columns()[0] == column) {
+            return index.get();
+        }
+    }
+    return nullptr;
+}
+
+}
+
+QueryResult QueryExecutor::execute(const ParsedQuery& parsed_query, Database& db, const QueryOptions& options) {
     switch (parsed_query.type) {
         case ParsedQuery::QueryType::CreateTable:
             try {
@@ -40,6 +330,15 @@ QueryResult QueryExecutor::execute(const ParsedQuery& parsed_query, Database& db
         case ParsedQuery::QueryType::Insert:
             try {
                 std::shared_ptr<Table> table = db.get_table(parsed_query.table_name);
+                if (!parsed_query.insert_batch.empty()) {
+                    std::vector<core::RowID> new_row_ids = table->insert_rows(parsed_query.insert_batch);
+                    std::vector<std::vector<std::optional<Value>>> data;
+                    data.reserve(new_row_ids.size());
+                    for (core::RowID new_row_id : new_row_ids) {
+                        data.push_back({ Value(static_cast<int32_t>(new_row_id)) });
+                    }
+                    return QueryResult(data);
+                }
                 core::RowID new_row_id = table->insert_row(*(parsed_query.insert_values));
                 std::vector<std::vector<std::optional<Value>>> data = { { Value(static_cast<int32_t>(new_row_id)) } };
                 return QueryResult(data);
@@ -50,15 +349,15 @@ QueryResult QueryExecutor::execute(const ParsedQuery& parsed_query, Database& db
             break;
         
         case ParsedQuery::QueryType::Select:
-            return execute_select(parsed_query, db);
+            return execute_select(parsed_query, db, options);
             break;
         
         case ParsedQuery::QueryType::Update:
-            return execute_update(parsed_query, db);
+            return execute_update(*copy_query(parsed_query), db, options);
             break;
         
         case ParsedQuery::QueryType::Delete:
-            return execute_delete(parsed_query, db);
+            return execute_delete(*copy_query(parsed_query), db, options);
             break;
         
         case ParsedQuery::QueryType::CreateIndex:
@@ -70,226 +369,474 @@ QueryResult QueryExecutor::execute(const ParsedQuery& parsed_query, Database& db
     }
 }
 
-QueryResult QueryExecutor::execute_select(const ParsedQuery& pq, Database& db) {
+QueryResult QueryExecutor::execute_select(const ParsedQuery& pq, Database& db, const QueryOptions& options) {
     try {
+        QueryCursor cursor = open_select(pq, db, options);
         std::vector<std::vector<std::optional<Value>>> results;
-        std::vector<ColumnInfo> result_columns;
+        std::vector<std::optional<Value>> row;
+        while (cursor.next(row)) {
+            results.push_back(std::move(row));
+        }
+        return QueryResult(results, cursor.get_columns());
+    } catch (const exceptions::DatabaseException& e) {
+        return QueryResult(e.what());
+    } catch (const std::exception& e) {
+        return QueryResult(e.what());
+    }
+}
 
-        if (!pq.joins.empty()) {
-            auto table1 = db.get_table(pq.table_name);
-            auto table2 = db.get_table(pq.joins[0].table_name);
+QueryCursor QueryExecutor::open_select(const ParsedQuery& pq, Database& db, const QueryOptions& options) {
+    std::shared_ptr<const ParsedQuery> query = copy_query(pq);
+    if (query->joins.size() == 1) {
+        return open_join(*query, db, options, query);
+    }
+    if (query->joins.size() > 1) {
+        return open_multi_join(*query, db, options, query);
+    }
+    return open_scan(*query, db, options, query);
+}
 
-            const auto& columns1 = table1->get_columns();
-            const auto& columns2 = table2->get_columns();
+QueryCursor QueryExecutor::open_scan(const ParsedQuery& pq, Database& db, const QueryOptions& options,
+                                     std::shared_ptr<const ParsedQuery> owner) {
+    auto table = db.get_table(pq.table_name);
 
-            std::unordered_map<std::string, DataType> combined_schema;
-            for (const auto& col : columns1) {
-                std::string aliased_name = pq.table_name + "." + col.get_name();
-                combined_schema.emplace(aliased_name, col.get_type());
-            }
+    std::vector<ColumnInfo> result_columns;
+    for (const auto& select_item : pq.select_items) {
+        std::string result_col_name = select_item.alias.empty() ? select_item.expression->to_string() : select_item.alias;
+        DataType result_col_type = select_item.expression->get_type();
+        result_columns.emplace_back(ColumnInfo(result_col_name, result_col_type));
+    }
 
-            for (const auto& col : columns2) {
-                std::string aliased_name = pq.joins[0].table_name + "." + col.get_name();
-                combined_schema.emplace(aliased_name, col.get_type());
-            }
+    // WHERE sees select aliases, so a column shadowed by an alias cannot
+    // be looked up in an index.
+    std::unordered_set<std::string> shadowed;
+    for (const auto& select_item : pq.select_items) {
+        auto variable = dynamic_cast<const VariableExpression*>(select_item.expression.get());
+        if (!variable || variable->get_name() != select_item.alias) {
+            shadowed.insert(select_item.alias);
+        }
+    }
+    std::vector<const Expression*> index_conjuncts;
+    for (const Expression* conjunct : QueryPlanner::split_conjuncts(pq.where_clause.get())) {
+        std::vector<std::string> conjunct_columns;
+        QueryPlanner::collect_columns(conjunct, conjunct_columns);
+        if (std::none_of(conjunct_columns.begin(), conjunct_columns.end(), [&](const std::string& col) { return shadowed.count(col) > 0; })) {
+            index_conjuncts.push_back(conjunct);
+        }
+    }
 
-            std::unordered_set<std::string> selected_columns;
-            for (const auto& select_item : pq.select_items) {
-                std::string aliased_name = select_item.alias.empty() ? select_item.expression->to_string() : select_item.alias;
-                selected_columns.insert(aliased_name);
+    std::vector<ColumnRange> ranges = QueryPlanner::literal_ranges(index_conjuncts, "");
+    auto context = std::make_unique<ExecutionContext>();
+    set_parallelism(*context, pq, db, options);
+    size_t slot = context->add_relation(table, "");
+    auto aggregator = make_aggregator(pq, *context, aggregation_memory_budget_);
+
+    // ORDER BY a single column with an ordered index is answered by walking the
+    // index, unless another indexed column narrows the scan. Rows with a NULL
+    // key are not indexed, so the index must cover every row.
+    const Index* order_index = nullptr;
+    if (pq.order_by.size() == 1 && !aggregator) {
+        auto variable = dynamic_cast<const VariableExpression*>(pq.order_by[0].expression.get());
+        if (variable && shadowed.count(variable->get_name()) == 0) {
+            order_index = find_ordered_index(*table, variable->get_name());
+        }
+    }
+    std::optional<ColumnRange> order_range;
+    for (const auto& range : ranges) {
+        const Value& bound = range.lower.has_value() ? *range.lower : *range.upper;
+        if (order_index == nullptr || !table->has_column(range.column) ||
+            table->get_columns()[table->get_column_index(range.column)].get_type().get_type() != bound.get_type()) {
+            continue;
+        }
+        if (range.column == order_index->get_columns()[0]) {
+            order_range = range;
+            continue;
+        }
+        for (const auto& index : table->get_indexes()) {
+            if (index->get_columns()[0] == range.column) {
+                order_index = nullptr;
+                break;
             }
+        }
+    }
+    if (order_index != nullptr && order_index->get_ordered_entries().size() != table->get_all_rows().size()) {
+        order_index = nullptr;
+    }
 
-            std::vector<ColumnInfo> aliased_columns1;
-            for (const auto& col : columns1) {
-                std::string aliased_name = pq.table_name + "." + col.get_name();
-                aliased_columns1.emplace_back(ColumnInfo(aliased_name, col.get_type()));
-                if (selected_columns.find(aliased_name) != selected_columns.end()) {
-                    result_columns.emplace_back(ColumnInfo(aliased_name, col.get_type()));
-                }
-            }
+    std::unique_ptr<Operator> root;
+    std::vector<IndexedColumn> indexed;
+    if (order_index != nullptr) {
+        root = std::make_unique<OrderedIndexScanOperator>(*context, slot, order_index, order_range, pq.order_by[0].descending);
+    } else {
+        indexed = ScanOperator::indexed_columns(*table, ranges);
+        root = std::make_unique<ScanOperator>(*context, slot, std::move(ranges), std::vector<const Expression*>());
+    }
 
-            std::vector<ColumnInfo> aliased_columns2;
-            for (const auto& col : columns2) {
-                std::string aliased_name = pq.joins[0].table_name + "." + col.get_name();
-                aliased_columns2.emplace_back(ColumnInfo(aliased_name, col.get_type()));
-                if (selected_columns.find(aliased_name) != selected_columns.end()) {
-                    result_columns.emplace_back(ColumnInfo(aliased_name, col.get_type()));
-                }
-            }
+    bool aggregate = aggregator != nullptr;
+    bind_select(pq, *context, !aggregate, result_columns);
+    if (selects_nothing(pq)) {
+        root = std::make_unique<EmptyOperator>();
+    }
+    // Conjuncts the index read by the scan answers exactly need no evaluation.
+    std::vector<const Expression*> where;
+    for (const Expression* conjunct : QueryPlanner::split_conjuncts(pq.where_clause.get())) {
+        bool unshadowed = std::find(index_conjuncts.begin(), index_conjuncts.end(), conjunct) != index_conjuncts.end();
+        if (!unshadowed || !answered_by_index(conjunct, *table, indexed)) {
+            where.push_back(conjunct);
+        }
+    }
+    where = QueryPlanner::order_conjuncts(std::move(where));
+    CompiledFilter filter = compile_where(*context, options, aggregate ? std::unordered_set<std::string>() : shadowed, where);
+    return QueryCursor(pq, std::move(owner), std::move(context), std::move(root), std::move(result_columns), std::move(where),
+                       !aggregate, order_index != nullptr, std::move(aggregator), std::move(filter));
+}
 
-            for (const auto& [row_id1, row1] : table1->get_all_rows()) {
-                std::unordered_map<std::string, Value> row_map;
-                for (size_t i = 0; i < columns1.size(); ++i) {
-                    if (row1.get_values()[i].has_value()) {
-                        row_map[aliased_columns1[i].get_name()] = *(row1.get_values()[i]);
-                    }
-                }
+QueryCursor QueryExecutor::open_join(const ParsedQuery& pq, Database& db, const QueryOptions& options,
+                                     std::shared_ptr<const ParsedQuery> owner) {
+    const JoinInfo& join = pq.joins[0];
+    auto table1 = db.get_table(pq.table_name);
+    auto table2 = db.get_table(join.table_name);
 
-                for (const auto& [row_id2, row2] : table2->get_all_rows()) {
-                    std::unordered_map<std::string, Value> combined_row_map = row_map; 
-                    for (size_t i = 0; i < columns2.size(); ++i) {
-                        if (row2.get_values()[i].has_value()) {
-                            combined_row_map[aliased_columns2[i].get_name()] = *(row2.get_values()[i]);
-                        }
-                    }
+    const auto& columns1 = table1->get_columns();
+    const auto& columns2 = table2->get_columns();
 
-                    Value join_cond_value = pq.joins[0].join_condition->evaluate(combined_row_map);
+    std::unordered_map<std::string, DataType> combined_schema;
+    std::vector<std::string> aliased_names1;
+    for (const auto& col : columns1) {
+        aliased_names1.push_back(pq.table_name + "." + col.get_name());
+        combined_schema.emplace(aliased_names1.back(), col.get_type());
+    }
+    std::vector<std::string> aliased_names2;
+    for (const auto& col : columns2) {
+        aliased_names2.push_back(join.table_name + "." + col.get_name());
+        combined_schema.emplace(aliased_names2.back(), col.get_type());
+    }
 
-                    if (join_cond_value.get_type() != Type::Bool) {
-                        throw std::invalid_argument("JOIN condition does not evaluate to a boolean.");
-                    }
-                    if (join_cond_value.get_bool()) {
-                        bool where_match = true;
-                        if (pq.where_clause) {
-                            Value where_cond = pq.where_clause->evaluate(combined_row_map);
-                            if (where_cond.get_type() != Type::Bool) {
-                                throw std::invalid_argument("WHERE clause does not evaluate to a boolean.");
-                            }
-                            where_match = where_cond.get_bool();
-                        }
-                        if (where_match) {
-                            std::vector<std::optional<Value>> selected_values;
-                            for (const auto& select_item : pq.select_items) {
-                                try {
-                                    Value val = select_item.expression->evaluate(combined_row_map);
-                                    selected_values.push_back(val);
-                                } catch (const std::exception& e) {
-                                    return QueryResult("Error evaluating expression in SELECT clause: " + std::string(e.what()));
-                                }
-                            }
-                            results.push_back(selected_values);
-                        }
-                    }
-                }
-            }
-            return QueryResult(results, result_columns);
+    std::vector<ColumnInfo> result_columns = join_result_columns(pq, combined_schema);
+
+    JoinPlan plan = QueryPlanner::plan_join(join.join_condition.get(), pq.table_name, join.table_name);
+
+    // Keys over columns of different types stay ordinary predicates so that the
+    // type mismatch is still reported when the condition is evaluated.
+    auto same_type = [&](const std::string& left_column, const std::string& right_column) {
+        auto left_it = combined_schema.find(left_column);
+        auto right_it = combined_schema.find(right_column);
+        return left_it != combined_schema.end() && right_it != combined_schema.end() &&
+               left_it->second.get_type() == right_it->second.get_type();
+    };
+
+    std::vector<size_t> key_columns1;
+    std::vector<size_t> key_columns2;
+    std::vector<std::string> key_names1;
+    std::vector<std::string> key_names2;
+    std::vector<const Expression*> residual;
+    for (const auto& key : plan.keys) {
+        if (!same_type(key.left_column, key.right_column)) {
+            residual.push_back(key.condition);
+            continue;
+        }
+        key_names1.push_back(key.left_column.substr(pq.table_name.size() + 1));
+        key_names2.push_back(key.right_column.substr(join.table_name.size() + 1));
+        key_columns1.push_back(table1->get_column_index(key_names1.back()));
+        key_columns2.push_back(table2->get_column_index(key_names2.back()));
+    }
+
+    // Ordered indexes on both sides of a key allow a merge join; otherwise
+    // prefer probing an index of the inner table over building a hash table.
+    const Index* merge_index1 = nullptr;
+    const Index* merge_index2 = nullptr;
+    for (size_t i = 0; i < key_names1.size() && merge_index2 == nullptr; ++i) {
+        merge_index1 = find_ordered_index(*table1, key_names1[i]);
+        merge_index2 = merge_index1 ? find_ordered_index(*table2, key_names2[i]) : nullptr;
+    }
+
+    const Index* key_index = nullptr;
+    for (const auto& index : table2->get_indexes()) {
+        const auto& index_columns = index->get_columns();
+        bool covered = !key_names2.empty() && std::all_of(index_columns.begin(), index_columns.end(), [&](const std::string& col) {
+            return std::find(key_names2.begin(), key_names2.end(), col) != key_names2.end();
+        });
+        if (covered) {
+            key_index = index.get();
+            break;
+        }
+    }
+
+    const Index* range_index = nullptr;
+    std::vector<RangeJoinKey> range_keys;
+    for (const auto& range : plan.ranges) {
+        if (!same_type(range.left_column, range.right_column)) {
+            residual.push_back(range.condition);
+            continue;
+        }
+        std::string inner_column = range.right_column.substr(join.table_name.size() + 1);
+        if (range_index == nullptr && key_columns1.empty()) {
+            range_index = find_ordered_index(*table2, inner_column);
+        }
+        if (range_index != nullptr && range_index->get_columns()[0] == inner_column) {
+            range_keys.push_back(range);
         } else {
-            auto table = db.get_table(pq.table_name);
-            const auto& columns = table->get_columns();
+            residual.push_back(range.condition);
+        }
+    }
+    residual.insert(residual.end(), plan.residual.begin(), plan.residual.end());
 
-            std::unordered_map<std::string, DataType> table_schema;
-            for (const auto& col : columns) {
-                table_schema.emplace(col.get_name(), col.get_type());
-            }
+    std::vector<const Expression*> where_residual;
+    auto pushed_filters = push_down_where(pq, { pq.table_name, join.table_name }, combined_schema, where_residual);
+    const auto& filters1 = pushed_filters[0];
+    const auto& filters2 = pushed_filters[1];
 
-            for (const auto& select_item : pq.select_items) {
-                std::string result_col_name = select_item.alias.empty() ? select_item.expression->to_string() : select_item.alias;
-                DataType result_col_type = select_item.expression->get_type();
-                result_columns.emplace_back(ColumnInfo(result_col_name, result_col_type));
-            }
+    auto context = std::make_unique<ExecutionContext>();
+    set_parallelism(*context, pq, db, options);
+    size_t slot1 = context->add_relation(table1, pq.table_name);
+    size_t slot2 = context->add_relation(table2, join.table_name);
 
-            for (const auto& [row_id, row] : table->get_all_rows()) {
-                std::unordered_map<std::string, Value> row_map;
-                for (size_t i = 0; i < columns.size(); ++i) {
-                    if (row.get_values()[i].has_value()) {
-                        row_map[columns[i].get_name()] = *(row.get_values()[i]);
-                    }
-                }
+    std::vector<TupleKey> tuple_keys;
+    for (size_t i = 0; i < key_columns1.size(); ++i) {
+        tuple_keys.push_back(TupleKey{slot1, key_columns1[i], key_columns2[i]});
+    }
 
-                for (const auto& select_item : pq.select_items) {
-                    Value val = select_item.expression->evaluate(row_map);
-                    std::string aliased_name = select_item.alias.empty() ? select_item.expression->to_string() : select_item.alias;
-                    row_map[aliased_name] = val;
-                }
+    std::unique_ptr<Operator> root;
+    if (merge_index2 != nullptr) {
+        // Both sides are streamed in key order, so the output comes out sorted
+        // by the join key and no intermediate table is built.
+        root = std::make_unique<MergeJoinOperator>(*context, slot1, merge_index1, filters1,
+                                                   slot2, merge_index2, filters2, tuple_keys, residual);
+    } else {
+        std::unique_ptr<Operator> outer = std::make_unique<ScanOperator>(*context, slot1,
+                                                                         QueryPlanner::literal_ranges(filters1, pq.table_name), filters1);
+        if (key_index != nullptr) {
+            root = std::make_unique<IndexJoinOperator>(*context, std::move(outer), slot2, filters2, residual, key_index, tuple_keys);
+        } else if (range_index != nullptr) {
+            std::vector<TupleRange> tuple_ranges;
+            for (const auto& range : range_keys) {
+                size_t outer_column = table1->get_column_index(range.left_column.substr(pq.table_name.size() + 1));
+                tuple_ranges.push_back(TupleRange{slot1, outer_column, range.op});
+            }
+            root = std::make_unique<IndexJoinOperator>(*context, std::move(outer), slot2, filters2, residual, range_index,
+                                                       std::vector<TupleKey>(), tuple_ranges);
+        } else if (tuple_keys.empty()) {
+            root = std::make_unique<NestedLoopJoinOperator>(*context, std::move(outer), slot2,
+                                                            QueryPlanner::literal_ranges(filters2, join.table_name), filters2, residual);
+        } else {
+            // Hash join: build on the smaller table, probe with the larger one.
+            bool build_outer = table1->get_all_rows().size() < table2->get_all_rows().size();
+            root = std::make_unique<HashJoinOperator>(*context, std::move(outer), slot2,
+                                                      QueryPlanner::literal_ranges(filters2, join.table_name), filters2,
+                                                      residual, tuple_keys, build_outer);
+        }
+    }
 
-                bool match = true;
-                if (pq.where_clause) {
-                    Value cond = pq.where_clause->evaluate(row_map);
-                    if (cond.get_type() != Type::Bool) {
-                        throw std::invalid_argument("WHERE clause does not evaluate to a boolean.");
-                    }
-                    match = cond.get_bool();
-                }
+    auto aggregator = make_aggregator(pq, *context, aggregation_memory_budget_);
+    bind_select(pq, *context, false, result_columns);
+    if (selects_nothing(pq)) {
+        root = std::make_unique<EmptyOperator>();
+    }
+    CompiledFilter filter = compile_where(*context, options, {}, where_residual);
+    return QueryCursor(pq, std::move(owner), std::move(context), std::move(root), std::move(result_columns), std::move(where_residual),
+                       false, false, std::move(aggregator), std::move(filter));
+}
 
-                if (match) {
-                    std::vector<std::optional<Value>> selected_values;
-                    for (const auto& select_item : pq.select_items) {
-                        std::string aliased_name = select_item.alias.empty() ? select_item.expression->to_string() : select_item.alias;
-                        if (row_map.find(aliased_name) != row_map.end()) {
-                            selected_values.emplace_back(row_map[aliased_name]);
-                        } else {
-                            selected_values.emplace_back(std::nullopt);
-                        }
-                    }
-                    results.emplace_back(selected_values);
-                }
+QueryCursor QueryExecutor::open_multi_join(const ParsedQuery& pq, Database& db, const QueryOptions& options,
+                                           std::shared_ptr<const ParsedQuery> owner) {
+    std::vector<std::string> table_names = { pq.table_name };
+    for (const auto& join : pq.joins) {
+        table_names.push_back(join.table_name);
+    }
+    const size_t relation_count = table_names.size();
+
+    std::vector<std::shared_ptr<Table>> tables;
+    std::vector<std::vector<std::string>> aliased_names(relation_count);
+    std::unordered_map<std::string, DataType> combined_schema;
+    std::vector<JoinRelation> relations;
+    for (size_t i = 0; i < relation_count; ++i) {
+        if (std::count(table_names.begin(), table_names.end(), table_names[i]) > 1) {
+            throw std::invalid_argument("Table \"" + table_names[i] + "\" appears more than once in a multi-way JOIN.");
+        }
+        tables.push_back(db.get_table(table_names[i]));
+
+        JoinRelation relation;
+        relation.table_name = table_names[i];
+        relation.cardinality = tables[i]->get_all_rows().size();
+        for (const auto& index : tables[i]->get_indexes()) {
+            if (index->get_columns().size() == 1) {
+                relation.indexed_columns.push_back(index->get_columns()[0]);
             }
+        }
+        relations.push_back(std::move(relation));
 
-            return QueryResult(results, result_columns);
+        for (const auto& col : tables[i]->get_columns()) {
+            aliased_names[i].push_back(table_names[i] + "." + col.get_name());
+            combined_schema.emplace(aliased_names[i].back(), col.get_type());
         }
-    } catch (const exceptions::DatabaseException& e) {
-        return QueryResult(e.what());
-    } catch (const std::exception& e) {
-        return QueryResult(e.what());
     }
-}
 
-QueryResult QueryExecutor::execute_update(const ParsedQuery& pq, Database& db) {
-    try {
-        std::shared_ptr<Table> table = db.get_table(pq.table_name);
-        const auto& columns = table->get_columns();
+    std::vector<ColumnInfo> result_columns = join_result_columns(pq, combined_schema);
 
-        size_t updated_count = 0;
+    // Filtered tables are counted up front so that their cardinality after
+    // the filter drives the join order.
+    std::vector<const Expression*> where_residual;
+    auto pushed_filters = push_down_where(pq, table_names, combined_schema, where_residual);
 
-        for (auto& [row_id, row] : table->get_all_rows()) {
-            std::unordered_map<std::string, Value> row_map;
-            for (size_t i = 0; i < columns.size(); ++i) {
-                if (row.get_values()[i].has_value()) {
-                    row_map[columns[i].get_name()] = *(row.get_values()[i]);
-                }
+    auto context = std::make_unique<ExecutionContext>();
+    set_parallelism(*context, pq, db, options);
+    std::vector<std::vector<ColumnRange>> pushed_ranges(relation_count);
+    for (size_t i = 0; i < relation_count; ++i) {
+        context->add_relation(tables[i], table_names[i]);
+        pushed_ranges[i] = QueryPlanner::literal_ranges(pushed_filters[i], table_names[i]);
+    }
+    for (size_t i = 0; i < relation_count; ++i) {
+        if (!pushed_filters[i].empty()) {
+            ScanOperator scan(*context, i, pushed_ranges[i], pushed_filters[i]);
+            RowTuple tuple;
+            relations[i].cardinality = 0;
+            while (scan.next(tuple)) {
+                ++relations[i].cardinality;
             }
+        }
+    }
 
-            bool match = true;
-            if (pq.where_clause) {
-                Value cond = pq.where_clause->evaluate(row_map);
-                if (cond.get_type() != Type::Bool) {
-                    throw std::invalid_argument("WHERE clause does not evaluate to a boolean.");
-                }
-                match = cond.get_bool();
+    auto relation_of = [&](const std::string& column) {
+        std::string qualifier = QueryPlanner::column_qualifier(column);
+        return static_cast<size_t>(std::find(table_names.begin(), table_names.end(), qualifier) - table_names.begin());
+    };
+
+    // A conjunct is applied as soon as every table it mentions has been joined.
+    // Columns that cannot be attributed to a table defer it to the last step.
+    std::vector<const Expression*> conjuncts;
+    for (const auto& join : pq.joins) {
+        auto join_conjuncts = QueryPlanner::split_conjuncts(join.join_condition.get());
+        conjuncts.insert(conjuncts.end(), join_conjuncts.begin(), join_conjuncts.end());
+    }
+    std::vector<std::vector<bool>> conjunct_relations(conjuncts.size(), std::vector<bool>(relation_count, false));
+    for (size_t i = 0; i < conjuncts.size(); ++i) {
+        std::vector<std::string> columns;
+        QueryPlanner::collect_columns(conjuncts[i], columns);
+        for (const auto& column : columns) {
+            size_t relation = relation_of(column);
+            if (relation < relation_count) {
+                conjunct_relations[i][relation] = true;
+            } else {
+                conjunct_relations[i].assign(relation_count, true);
             }
+        }
+    }
 
-            if (match) {
-                std::vector<std::optional<Value>> new_values = row.get_values();
-                for (const auto& [col_name, expr] : pq.update_assignments) {
-                    size_t col_index = table->get_column_index(col_name);
-                    const Column& column = columns[col_index];
+    std::vector<EquiJoinKey> keys;
+    for (const auto& key : QueryPlanner::equi_join_keys(conjuncts)) {
+        auto left_it = combined_schema.find(key.left_column);
+        auto right_it = combined_schema.find(key.right_column);
+        if (left_it != combined_schema.end() && right_it != combined_schema.end() &&
+            left_it->second.get_type() == right_it->second.get_type()) {
+            keys.push_back(key);
+        }
+    }
 
-                    if (column.has_attribute(ColumnAttribute::AutoIncrement)) {
-                        throw std::invalid_argument("Cannot update auto-increment column \"" + col_name + "\".");
-                    }
+    std::vector<size_t> order = QueryPlanner::order_joins(relations, keys);
 
-                    Value new_val = expr->evaluate(row_map);
+    std::vector<bool> joined(relation_count, false);
+    std::vector<bool> applied(conjuncts.size(), false);
+    std::unique_ptr<Operator> root;
 
-                    if (new_val.get_type() != column.get_type().get_type()) {
-                        throw exceptions::TypeMismatchException("Type mismatch in SET assignment for column \"" + col_name + "\".");
-                    }
+    for (size_t step = 0; step < order.size(); ++step) {
+        const size_t next = order[step];
+        joined[next] = true;
+        const auto& table = tables[next];
 
-                    new_values[col_index] = new_val;
-                    row_map[col_name] = new_val;
+        std::vector<TupleKey> step_keys;
+        std::vector<std::string> inner_names;
+        std::vector<const Expression*> filters;
+        for (size_t i = 0; i < conjuncts.size(); ++i) {
+            if (applied[i]) {
+                continue;
+            }
+            bool ready = true;
+            for (size_t r = 0; r < relation_count; ++r) {
+                ready = ready && (!conjunct_relations[i][r] || joined[r]);
+            }
+            if (!ready) {
+                continue;
+            }
+            applied[i] = true;
+
+            auto key_it = std::find_if(keys.begin(), keys.end(), [&](const EquiJoinKey& key) { return key.condition == conjuncts[i]; });
+            if (step > 0 && key_it != keys.end()) {
+                size_t left = relation_of(key_it->left_column);
+                size_t right = relation_of(key_it->right_column);
+                if (left == next || right == next) {
+                    const std::string& outer_column = left == next ? key_it->right_column : key_it->left_column;
+                    const std::string& inner_column = left == next ? key_it->left_column : key_it->right_column;
+                    size_t outer = left == next ? right : left;
+                    inner_names.push_back(inner_column.substr(table_names[next].size() + 1));
+                    step_keys.push_back(TupleKey{outer,
+                                                 tables[outer]->get_column_index(outer_column.substr(table_names[outer].size() + 1)),
+                                                 table->get_column_index(inner_names.back())});
+                    continue;
                 }
-                table->validate_row_update(new_values, row_id);
+            }
+            filters.push_back(conjuncts[i]);
+        }
 
-                row.get_values() = new_values;
-                updated_count++;
+        if (step == 0) {
+            root = std::make_unique<ScanOperator>(*context, next, pushed_ranges[next], pushed_filters[next]);
+            if (!filters.empty()) {
+                root = std::make_unique<FilterOperator>(*context, std::move(root), filters, kJoinConditionError);
             }
+            continue;
+        }
+        if (step_keys.empty()) {
+            root = std::make_unique<NestedLoopJoinOperator>(*context, std::move(root), next,
+                                                            pushed_ranges[next], pushed_filters[next], filters);
+            continue;
         }
 
-        std::vector<std::vector<std::optional<Value>>> data = { { Value(static_cast<int32_t>(updated_count)) } };
-        return QueryResult(data);
+        const Index* probe_index = nullptr;
+        for (const auto& index : table->get_indexes()) {
+            const auto& index_columns = index->get_columns();
+            if (index_columns.size() == 1 && std::find(inner_names.begin(), inner_names.end(), index_columns[0]) != inner_names.end()) {
+                probe_index = index.get();
+                break;
+            }
+        }
+        if (probe_index != nullptr) {
+            root = std::make_unique<IndexJoinOperator>(*context, std::move(root), next, pushed_filters[next], filters,
+                                                       probe_index, step_keys);
+        } else {
+            root = std::make_unique<HashJoinOperator>(*context, std::move(root), next, pushed_ranges[next],
+                                                      pushed_filters[next], filters, step_keys);
+        }
     }
-    catch (const exceptions::DatabaseException& e) {
-        return QueryResult(e.what());
+
+    auto aggregator = make_aggregator(pq, *context, aggregation_memory_budget_);
+    bind_select(pq, *context, false, result_columns);
+    if (selects_nothing(pq)) {
+        root = std::make_unique<EmptyOperator>();
     }
+    CompiledFilter filter = compile_where(*context, options, {}, where_residual);
+    return QueryCursor(pq, std::move(owner), std::move(context), std::move(root), std::move(result_columns), std::move(where_residual),
+                       false, false, std::move(aggregator), std::move(filter));
 }
 
-QueryResult QueryExecutor::execute_delete(const ParsedQuery& pq, Database& db) {
+QueryResult QueryExecutor::execute_update(const ParsedQuery& pq, Database& db, const QueryOptions& options) {
     try {
         std::shared_ptr<Table> table = db.get_table(pq.table_name);
         const auto& columns = table->get_columns();
 
-        std::vector<core::RowID> rows_to_delete;
+        std::unordered_map<std::string, DataType> schema = table_schema(*table);
+        bind_condition(pq.where_clause.get(), schema, kWhereClauseError);
+        for (const auto& [col_name, expr] : pq.update_assignments) {
+            Type type = expr->bind(schema).get_type();
+            if (type != Type::Unknown && type != columns[table->get_column_index(col_name)].get_type().get_type()) {
+                throw exceptions::TypeMismatchException("Type mismatch in SET assignment for column \"" + col_name + "\".");
+            }
+        }
+
+        // WHERE is evaluated for every row before the first one is changed;
+        // an assignment only ever changes the row it is applied to.
+        std::vector<core::RowID> rows_to_update = table->find_rows(pq.where_clause, &db.get_thread_pool(), options);
 
-        for (const auto& [row_id, row] : table->get_all_rows()) {
+        for (core::RowID row_id : rows_to_update) {
+            const Row& row = table->get_row(row_id);
             std::unordered_map<std::string, Value> row_map;
             for (size_t i = 0; i < columns.size(); ++i) {
                 if (row.get_values()[i].has_value()) {
@@ -297,20 +844,41 @@ QueryResult QueryExecutor::execute_delete(const ParsedQuery& pq, Database& db) {
                 }
             }
 
-            bool match = true;
-            if (pq.delete_where_clause) {
-                Value cond = pq.delete_where_clause->evaluate(row_map);
-                if (cond.get_type() != Type::Bool) {
-                    throw std::invalid_argument("WHERE clause does not evaluate to a boolean.");
+            std::vector<std::optional<Value>> new_values = row.get_values();
+            for (const auto& [col_name, expr] : pq.update_assignments) {
+                size_t col_index = table->get_column_index(col_name);
+                const Column& column = columns[col_index];
+
+                if (column.has_attribute(ColumnAttribute::AutoIncrement)) {
+                    throw std::invalid_argument("Cannot update auto-increment column \"" + col_name + "\".");
                 }
-                match = cond.get_bool();
-            }
 
-            if (match) {
-                rows_to_delete.emplace_back(row_id);
+                Value new_val = expr->evaluate(row_map);
+
+                if (new_val.get_type() != column.get_type().get_type()) {
+                    throw exceptions::TypeMismatchException("Type mismatch in SET assignment for column \"" + col_name + "\".");
+                }
+
+                new_values[col_index] = new_val;
+                row_map[col_name] = new_val;
             }
+            table->update_row(row_id, new_values);
         }
 
+        std::vector<std::vector<std::optional<Value>>> data = { { Value(static_cast<int32_t>(rows_to_update.size())) } };
+        return QueryResult(data);
+    }
+    catch (const exceptions::DatabaseException& e) {
+        return QueryResult(e.what());
+    }
+}
+
+QueryResult QueryExecutor::execute_delete(const ParsedQuery& pq, Database& db, const QueryOptions& options) {
+    try {
+        std::shared_ptr<Table> table = db.get_table(pq.table_name);
+        bind_condition(pq.delete_where_clause.get(), table_schema(*table), kWhereClauseError);
+        std::vector<core::RowID> rows_to_delete = table->find_rows(pq.delete_where_clause, &db.get_thread_pool(), options);
+
         for (const auto& row_id : rows_to_delete) {
             table->delete_row(row_id);
         }
@@ -1,6 +1,7 @@
 #include "memdb/core/QueryParser.h"
 #include "memdb/core/Table.h"
 #include "memdb/core/Database.h"
+#include "memdb/core/ExpressionOptimizer.h"
 #include "memdb/core/ExpressionParser.h"
 
 #include "memdb/core/exceptions/DatabaseException.h"
@@ -36,11 +37,11 @@ bool QueryParser::validate_query(const std::string& query) {
 }
 
 const std::unordered_set<std::string> reservedKeywords = {
-    "create", "table", "insert", "update", "delete", "join", "where", "int32", "string", "bytes", "bool", "key", "unique", "autoincrement",  "index", "unordered", "ordered", "on", "select", "from", "values", "as"
+    "create", "table", "insert", "update", "delete", "join", "where", "int32", "string", "bytes", "bool", "key", "unique", "autoincrement",  "index", "unordered", "ordered", "on", "select", "from", "values", "as", "group", "order", "asc", "desc", "limit", "offset"
 };
 
 bool isValidIdentifier(const std::string& identifier) {
-    std::regex valid_identifier_regex("^[a-zA-Z][a-zA-Z0-9_]*$");
+    static const std::regex valid_identifier_regex("^[a-zA-Z][a-zA-Z0-9_]*$");
     bool regex_match = std::regex_match(identifier, valid_identifier_regex);
     if (!regex_match) {
         return false;
@@ -51,6 +52,12 @@ bool isValidIdentifier(const std::string& identifier) {
     return reservedKeywords.find(lower_identifier) == reservedKeywords.end();
 }
 
+// Expressions are simplified once here rather than re-evaluating their
+// constant parts for every row.
+std::unique_ptr<Expression> parse_simplified(ExpressionParser& parser) {
+    return ExpressionOptimizer::simplify(*parser.parse_expression());
+}
+
 void QueryParser::set_database(Database* db) {
     db_ = db;
 }
@@ -229,6 +236,59 @@ std::vector<std::optional<Value>> parse_values(const std::string& values_str, co
     return values;
 }
 
+std::vector<std::string> split_value_tuples(const std::string& values_str) {
+    std::vector<std::string> tuples;
+    std::string current;
+    int paren_level = 0;
+    bool in_string = false;
+
+    for (size_t i = 0; i < values_str.size(); ++i) {
+        char ch = values_str[i];
+        if (in_string) {
+            current += ch;
+            if (ch == '\\' && i + 1 < values_str.size()) {
+                current += values_str[++i];
+            } else if (ch == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+
+        if (ch == '"') {
+            in_string = true;
+            current += ch;
+        }
+        else if (ch == '(') {
+            paren_level++;
+            current += ch;
+        }
+        else if (ch == ')' && paren_level > 0) {
+            paren_level--;
+            current += ch;
+        }
+        else if (ch == ')') {
+            tuples.push_back(current);
+            current.clear();
+
+            size_t next = values_str.find_first_not_of(" \t\r\n", i + 1);
+            if (next == std::string::npos || values_str[next] != ',') {
+                throw std::invalid_argument("Expected ',' between value tuples in INSERT statement.");
+            }
+            next = values_str.find_first_not_of(" \t\r\n", next + 1);
+            if (next == std::string::npos || values_str[next] != '(') {
+                throw std::invalid_argument("Expected '(' to start value tuple in INSERT statement.");
+            }
+            i = next;
+        }
+        else {
+            current += ch;
+        }
+    }
+    tuples.push_back(current);
+
+    return tuples;
+}
+
 ParsedQuery QueryParser::parse(const std::string& query) {
     bool valid = QueryParser::validate_query(query);
     if (!valid) {
@@ -361,7 +421,7 @@ ParsedQuery QueryParser::parse(const std::string& query) {
         pq.type = ParsedQuery::QueryType::Insert;
         pq.insert_values = std::vector<std::optional<Value>>();
 
-        std::regex insert_regex(R"(^insert\s*\(([\s\S]*)\)\s*to\s+(\w+)$)", std::regex::icase);
+        static const std::regex insert_regex(R"(^insert\s*\(([\s\S]*)\)\s*to\s+(\w+)$)", std::regex::icase);
         std::smatch matches;
         if (std::regex_match(trimmed_query, matches, insert_regex)) {
             std::string values_str = matches[1];
@@ -384,7 +444,16 @@ ParsedQuery QueryParser::parse(const std::string& query) {
             try {
                 table = db_->get_table(table_name);
                 const auto& columns = table->get_columns();
-                pq.insert_values = parse_values(values_str, columns);
+                std::vector<std::string> tuples = split_value_tuples(values_str);
+                if (tuples.size() == 1) {
+                    pq.insert_values = parse_values(tuples.front(), columns);
+                } else {
+                    pq.insert_values = std::nullopt;
+                    pq.insert_batch.reserve(tuples.size());
+                    for (const auto& tuple : tuples) {
+                        pq.insert_batch.emplace_back(parse_values(tuple, columns));
+                    }
+                }
             } catch (exceptions::TableNotFoundException& e) {
                 throw std::invalid_argument("Table does not exist: " + table_name);
             }
@@ -400,7 +469,7 @@ ParsedQuery QueryParser::parse(const std::string& query) {
         std::getline(iss, rest_of_query);
         rest_of_query = command + " " + rest_of_query;
 
-        std::regex select_regex(R"(select\s+(.+?)\s+from\s+(\w+)(?:\s+join\s+(\w+)\s+on\s+(.+?))?(?:\s+where\s+(.+))?$)", std::regex::icase);        
+        static const std::regex select_regex(R"(select\s+(.+?)\s+from\s+(\w+)((?:\s+join\s+\w+\s+on\s+.+?)*)(?:\s+where\s+(.+?))?(?:\s+group\s+by\s+(.+?))?(?:\s+order\s+by\s+(.+?))?(?:\s+limit\s+(\d+)(?:\s+offset\s+(\d+))?)?$)", std::regex::icase);
         std::smatch matches;
         if (std::regex_match(rest_of_query, matches, select_regex)) {
             std::string columns_str = matches[1];
@@ -417,7 +486,7 @@ ParsedQuery QueryParser::parse(const std::string& query) {
 
             std::vector<std::string> column_defs = split_columns(columns_str);
 
-            std::regex select_col_regex(R"(^([^\s,]+(?:\s+[^\s,]+)*)(?:\s+as\s+(\w+))?$)", std::regex::icase);
+            static const std::regex select_col_regex(R"(^([^\s,]+(?:\s+[^\s,]+)*?)(?:\s+as\s+(\w+))?$)", std::regex::icase);
 
             for (const auto& col_def : column_defs) {
                 std::smatch col_matches;
@@ -432,7 +501,7 @@ ParsedQuery QueryParser::parse(const std::string& query) {
                 alias = trim(alias.empty() ? expr_str : alias); 
 
                 ExpressionParser expr_parser(expr_str);
-                auto expression = expr_parser.parse_expression();
+                auto expression = parse_simplified(expr_parser);
 
                 SelectItem select_col;
                 select_col.expression = std::move(expression);
@@ -441,21 +510,62 @@ ParsedQuery QueryParser::parse(const std::string& query) {
                 pq.select_items.emplace_back(std::move(select_col));
             }
 
-            if (matches[3].matched) {
+            std::string joins_str = matches[3].str();
+            static const std::regex join_regex(R"(\s+join\s+(\w+)\s+on\s+(.+?)(?=\s+join\s+\w+\s+on\s+|$))", std::regex::icase);
+            for (auto it = std::sregex_iterator(joins_str.begin(), joins_str.end(), join_regex); it != std::sregex_iterator(); ++it) {
                 JoinInfo join_info;
-                join_info.table_name = matches[3].str();
-                std::string join_condition_str = matches[4].str();
+                join_info.table_name = (*it)[1].str();
+                if (!isValidIdentifier(join_info.table_name) || reservedKeywords.count(join_info.table_name)) {
+                    throw std::invalid_argument("Invalid table name: " + join_info.table_name);
+                }
 
-                ExpressionParser expr_parser(join_condition_str);
-                join_info.join_condition = expr_parser.parse_expression();
+                ExpressionParser expr_parser((*it)[2].str());
+                join_info.join_condition = parse_simplified(expr_parser);
 
                 pq.joins.push_back(std::move(join_info));
             }
 
-            if (matches[5].matched) {
-                std::string where_clause_str = matches[5].str();
+            if (matches[4].matched) {
+                std::string where_clause_str = matches[4].str();
                 ExpressionParser expr_parser(where_clause_str);
-                pq.where_clause = expr_parser.parse_expression();
+                pq.where_clause = parse_simplified(expr_parser);
+            }
+
+            if (matches[5].matched) {
+                for (const auto& key_str : split_columns(matches[5].str())) {
+                    ExpressionParser expr_parser(key_str);
+                    pq.group_by.push_back(parse_simplified(expr_parser));
+                }
+            }
+
+            if (matches[6].matched) {
+                static const std::regex order_item_regex(R"(^(.+?)(?:\s+(asc|desc))?$)", std::regex::icase);
+                for (const auto& item_str : split_columns(matches[6].str())) {
+                    std::smatch item_matches;
+                    if (!std::regex_match(item_str, item_matches, order_item_regex)) {
+                        throw std::invalid_argument("Invalid ORDER BY item: " + item_str);
+                    }
+
+                    std::string direction = item_matches[2].str();
+                    std::transform(direction.begin(), direction.end(), direction.begin(), ::tolower);
+
+                    ExpressionParser expr_parser(trim(item_matches[1].str()));
+                    OrderItem order_item;
+                    order_item.expression = parse_simplified(expr_parser);
+                    order_item.descending = direction == "desc";
+                    pq.order_by.push_back(std::move(order_item));
+                }
+            }
+
+            try {
+                if (matches[7].matched) {
+                    pq.limit = std::stoull(matches[7].str());
+                }
+                if (matches[8].matched) {
+                    pq.offset = std::stoull(matches[8].str());
+                }
+            } catch (const std::out_of_range&) {
+                throw std::invalid_argument("LIMIT or OFFSET value is out of range.");
             }
         } else {
             throw std::invalid_argument("Invalid SELECT syntax.");
@@ -548,7 +658,7 @@ ParsedQuery QueryParser::parse(const std::string& query) {
             }
 
             ExpressionParser expr_parser(expr_str);
-            auto expression = expr_parser.parse_expression();
+            auto expression = parse_simplified(expr_parser);
             if (!expression) {
                 throw std::invalid_argument("Failed to parse expression for column: " + col_name);
             }
@@ -557,7 +667,7 @@ ParsedQuery QueryParser::parse(const std::string& query) {
 
         if (!condition_str.empty()) {
             ExpressionParser expr_parser(condition_str);
-            auto condition_expression = expr_parser.parse_expression();
+            auto condition_expression = parse_simplified(expr_parser);
             if (!condition_expression) {
                 throw std::invalid_argument("Failed to parse WHERE clause.");
             }
@@ -585,7 +695,7 @@ ParsedQuery QueryParser::parse(const std::string& query) {
             condition_str = condition_str.substr(first, last - first + 1);
         }
         ExpressionParser expr_parser(condition_str);
-        pq.delete_where_clause = expr_parser.parse_expression();
+        pq.delete_where_clause = parse_simplified(expr_parser);
     }
     else {
         throw std::invalid_argument("Unknown command: " + command);
@@ -0,0 +1,538 @@
+#include "memdb/core/QueryPlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+
+namespace memdb {
+namespace core {
+
+std::vector<const Expression*> QueryPlanner::split_conjuncts(const Expression* expression) {
+    std::vector<const Expression*> conjuncts;
+    if (expression == nullptr) {
+        return conjuncts;
+    }
+
+    std::vector<const Expression*> pending = { expression };
+    while (!pending.empty()) {
+        const Expression* current = pending.back();
+        pending.pop_back();
+
+        auto binary = dynamic_cast<const BinaryExpression*>(current);
+        if (binary && binary->get_operator() == BinaryExpression::Operator::And) {
+            pending.push_back(binary->get_right());
+            pending.push_back(binary->get_left());
+        } else {
+            conjuncts.push_back(current);
+        }
+    }
+    return conjuncts;
+}
+
+std::string QueryPlanner::column_qualifier(const std::string& column_name) {
+    size_t dot = column_name.find('.');
+    return dot == std::string::npos ? std::string() : column_name.substr(0, dot);
+}
+
+void QueryPlanner::collect_columns(const Expression* expression, std::vector<std::string>& columns) {
+    if (auto variable = dynamic_cast<const VariableExpression*>(expression)) {
+        columns.push_back(variable->get_name());
+    } else if (auto unary = dynamic_cast<const UnaryExpression*>(expression)) {
+        collect_columns(unary->get_operand(), columns);
+    } else if (auto binary = dynamic_cast<const BinaryExpression*>(expression)) {
+        collect_columns(binary->get_left(), columns);
+        collect_columns(binary->get_right(), columns);
+    }
+}
+
+// Aggregates are collected once per distinct call; columns inside an
+// aggregate's argument are not collected by collect_columns().
+void QueryPlanner::collect_aggregates(const Expression* expression, std::vector<const AggregateExpression*>& aggregates) {
+    if (auto aggregate = dynamic_cast<const AggregateExpression*>(expression)) {
+        bool seen = std::any_of(aggregates.begin(), aggregates.end(), [&](const AggregateExpression* other) {
+            return other->to_string() == aggregate->to_string();
+        });
+        if (!seen) {
+            aggregates.push_back(aggregate);
+        }
+    } else if (auto unary = dynamic_cast<const UnaryExpression*>(expression)) {
+        collect_aggregates(unary->get_operand(), aggregates);
+    } else if (auto binary = dynamic_cast<const BinaryExpression*>(expression)) {
+        collect_aggregates(binary->get_left(), aggregates);
+        collect_aggregates(binary->get_right(), aggregates);
+    }
+}
+
+// Gives the operator subtrees that occur more than once among `expressions`,
+// compared by their text, a common shared slot, and clears the slots of the
+// others; returns the number of slots. Subtrees reading a name in `shadowed`
+// are not shared, since the name may stand for different values in
+// different places.
+size_t QueryPlanner::share_subexpressions(const std::vector<const Expression*>& expressions,
+                                          const std::unordered_set<std::string>& shadowed) {
+    struct Occurrence {
+        const Expression* node;
+        std::string text;
+    };
+    std::vector<Occurrence> occurrences;
+    std::unordered_map<std::string, size_t> counts;
+    std::vector<const Expression*> pending(expressions.begin(), expressions.end());
+    while (!pending.empty()) {
+        const Expression* node = pending.back();
+        pending.pop_back();
+        node->set_shared_slot(Expression::kNotShared);
+        if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+            pending.push_back(unary->get_operand());
+        } else if (auto binary = dynamic_cast<const BinaryExpression*>(node)) {
+            pending.push_back(binary->get_left());
+            pending.push_back(binary->get_right());
+        } else {
+            continue;
+        }
+
+        std::vector<std::string> names;
+        collect_columns(node, names);
+        bool reads_shadowed = std::any_of(names.begin(), names.end(), [&](const std::string& name) {
+            return shadowed.count(name) > 0;
+        });
+        if (!reads_shadowed) {
+            occurrences.push_back({node, node->to_string()});
+            ++counts[occurrences.back().text];
+        }
+    }
+
+    std::unordered_map<std::string, size_t> slots;
+    for (const auto& occurrence : occurrences) {
+        if (counts[occurrence.text] > 1) {
+            auto slot = slots.emplace(occurrence.text, slots.size()).first->second;
+            occurrence.node->set_shared_slot(slot);
+        }
+    }
+    return slots.size();
+}
+
+// Select items are evaluated in order into the row map under their aliases,
+// so an item sees the aliases of the items before it and WHERE sees the last
+// item with each alias. Marks the items that must be evaluated before WHERE:
+// those whose value WHERE or another such item reads, and those that must
+// keep their place relative to one, because it overwrites a name they read
+// or they share its alias. The rest can wait until a row passes.
+std::vector<bool> QueryPlanner::where_dependencies(const std::vector<const Expression*>& items,
+                                                   const std::vector<std::string>& aliases,
+                                                   const std::vector<const Expression*>& conjuncts) {
+    std::vector<std::vector<std::string>> reads(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        collect_columns(items[i], reads[i]);
+    }
+
+    // The last item before `end` that writes `name`.
+    auto writer = [&](const std::string& name, size_t end) -> std::optional<size_t> {
+        for (size_t i = end; i-- > 0;) {
+            if (aliases[i] == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    };
+
+    std::vector<bool> needed(items.size(), false);
+    for (const auto* conjunct : conjuncts) {
+        std::vector<std::string> names;
+        collect_columns(conjunct, names);
+        for (const auto& name : names) {
+            if (auto i = writer(name, items.size())) {
+                needed[*i] = true;
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (needed[i]) {
+                for (const auto& name : reads[i]) {
+                    auto j = writer(name, i);
+                    if (j && !needed[*j]) {
+                        needed[*j] = changed = true;
+                    }
+                }
+                continue;
+            }
+            for (size_t j = i + 1; j < items.size() && !needed[i]; ++j) {
+                bool overwrites = aliases[j] == aliases[i] ||
+                                  std::find(reads[i].begin(), reads[i].end(), aliases[j]) != reads[i].end();
+                if (needed[j] && overwrites) {
+                    needed[i] = changed = true;
+                }
+            }
+        }
+    }
+    return needed;
+}
+
+BinaryExpression::Operator QueryPlanner::mirror_comparison(BinaryExpression::Operator op) {
+    switch (op) {
+        case BinaryExpression::Operator::Less: return BinaryExpression::Operator::Greater;
+        case BinaryExpression::Operator::LessEqual: return BinaryExpression::Operator::GreaterEqual;
+        case BinaryExpression::Operator::Greater: return BinaryExpression::Operator::Less;
+        case BinaryExpression::Operator::GreaterEqual: return BinaryExpression::Operator::LessEqual;
+        default: return op;
+    }
+}
+
+JoinPlan QueryPlanner::plan_join(const Expression* condition,
+                                 const std::string& left_table,
+                                 const std::string& right_table) {
+    JoinPlan plan;
+    if (left_table == right_table) {
+        plan.residual = split_conjuncts(condition);
+        return plan;
+    }
+
+    for (const Expression* conjunct : split_conjuncts(condition)) {
+        auto binary = dynamic_cast<const BinaryExpression*>(conjunct);
+        if (!binary) {
+            plan.residual.push_back(conjunct);
+            continue;
+        }
+        BinaryExpression::Operator op = binary->get_operator();
+        bool is_range = op == BinaryExpression::Operator::Less || op == BinaryExpression::Operator::LessEqual ||
+                        op == BinaryExpression::Operator::Greater || op == BinaryExpression::Operator::GreaterEqual;
+        if (op != BinaryExpression::Operator::Equal && !is_range) {
+            plan.residual.push_back(conjunct);
+            continue;
+        }
+
+        auto left = dynamic_cast<const VariableExpression*>(binary->get_left());
+        auto right = dynamic_cast<const VariableExpression*>(binary->get_right());
+        if (!left || !right) {
+            plan.residual.push_back(conjunct);
+            continue;
+        }
+
+        std::string left_qualifier = column_qualifier(left->get_name());
+        std::string right_qualifier = column_qualifier(right->get_name());
+        if (left_qualifier == left_table && right_qualifier == right_table) {
+            if (is_range) {
+                plan.ranges.push_back(RangeJoinKey{left->get_name(), right->get_name(), mirror_comparison(op), conjunct});
+            } else {
+                plan.keys.push_back(EquiJoinKey{left->get_name(), right->get_name(), conjunct});
+            }
+        } else if (left_qualifier == right_table && right_qualifier == left_table) {
+            if (is_range) {
+                plan.ranges.push_back(RangeJoinKey{right->get_name(), left->get_name(), op, conjunct});
+            } else {
+                plan.keys.push_back(EquiJoinKey{right->get_name(), left->get_name(), conjunct});
+            }
+        } else {
+            plan.residual.push_back(conjunct);
+        }
+    }
+    return plan;
+}
+
+// Collects "column op literal" conjuncts on columns of `qualifier` (or on
+// unqualified columns when it is empty), merged into one range per column.
+std::vector<ColumnRange> QueryPlanner::literal_ranges(const std::vector<const Expression*>& conjuncts,
+                                                      const std::string& qualifier) {
+    std::vector<ColumnRange> ranges;
+    for (const Expression* conjunct : conjuncts) {
+        auto binary = dynamic_cast<const BinaryExpression*>(conjunct);
+        if (!binary) {
+            continue;
+        }
+        BinaryExpression::Operator op = binary->get_operator();
+        auto variable = dynamic_cast<const VariableExpression*>(binary->get_left());
+        auto literal = dynamic_cast<const LiteralExpression*>(binary->get_right());
+        if (!variable || !literal) {
+            variable = dynamic_cast<const VariableExpression*>(binary->get_right());
+            literal = dynamic_cast<const LiteralExpression*>(binary->get_left());
+            op = mirror_comparison(op);
+        }
+        if (!variable || !literal || !literal->get_value().has_value()) {
+            continue;
+        }
+        if (column_qualifier(variable->get_name()) != qualifier) {
+            continue;
+        }
+        std::string column = qualifier.empty() ? variable->get_name() : variable->get_name().substr(qualifier.size() + 1);
+
+        bool tightens_lower = op == BinaryExpression::Operator::Equal ||
+                              op == BinaryExpression::Operator::Greater || op == BinaryExpression::Operator::GreaterEqual;
+        bool tightens_upper = op == BinaryExpression::Operator::Equal ||
+                              op == BinaryExpression::Operator::Less || op == BinaryExpression::Operator::LessEqual;
+        if (!tightens_lower && !tightens_upper) {
+            continue;
+        }
+
+        auto range = std::find_if(ranges.begin(), ranges.end(), [&](const ColumnRange& r) { return r.column == column; });
+        if (range == ranges.end()) {
+            ColumnRange added;
+            added.column = column;
+            ranges.push_back(std::move(added));
+            range = std::prev(ranges.end());
+        }
+
+        const Value& value = literal->get_value();
+        if (range->lower.has_value() && range->lower->get_type() != value.get_type()) {
+            continue;
+        }
+        if (range->upper.has_value() && range->upper->get_type() != value.get_type()) {
+            continue;
+        }
+        bool inclusive = op != BinaryExpression::Operator::Greater && op != BinaryExpression::Operator::Less;
+        if (tightens_lower && (!range->lower || *range->lower < value || (*range->lower == value && !inclusive))) {
+            range->lower = value;
+            range->lower_inclusive = inclusive;
+        }
+        if (tightens_upper && (!range->upper || value < *range->upper || (*range->upper == value && !inclusive))) {
+            range->upper = value;
+            range->upper_inclusive = inclusive;
+        }
+    }
+    return ranges;
+}
+
+std::vector<EquiJoinKey> QueryPlanner::equi_join_keys(const std::vector<const Expression*>& conjuncts) {
+    std::vector<EquiJoinKey> keys;
+    for (const Expression* conjunct : conjuncts) {
+        auto binary = dynamic_cast<const BinaryExpression*>(conjunct);
+        if (!binary || binary->get_operator() != BinaryExpression::Operator::Equal) {
+            continue;
+        }
+        auto left = dynamic_cast<const VariableExpression*>(binary->get_left());
+        auto right = dynamic_cast<const VariableExpression*>(binary->get_right());
+        if (!left || !right) {
+            continue;
+        }
+        std::string left_qualifier = column_qualifier(left->get_name());
+        std::string right_qualifier = column_qualifier(right->get_name());
+        if (!left_qualifier.empty() && !right_qualifier.empty() && left_qualifier != right_qualifier) {
+            keys.push_back(EquiJoinKey{left->get_name(), right->get_name(), conjunct});
+        }
+    }
+    return keys;
+}
+
+namespace {
+
+bool is_string_operand(const Expression* expression) {
+    if (auto literal = dynamic_cast<const LiteralExpression*>(expression)) {
+        return literal->get_value().get_type() == Type::String;
+    }
+    if (auto binary = dynamic_cast<const BinaryExpression*>(expression)) {
+        return binary->get_operator() == BinaryExpression::Operator::Add &&
+               (is_string_operand(binary->get_left()) || is_string_operand(binary->get_right()));
+    }
+    return false;
+}
+
+// Relative cost of evaluating an expression once; a column lookup is 1.
+// Strings are copied out of the row and compared byte by byte, so anything
+// touching them is charged more.
+double estimate_cost(const Expression* expression) {
+    if (dynamic_cast<const LiteralExpression*>(expression)) {
+        return 0;
+    }
+    if (dynamic_cast<const VariableExpression*>(expression)) {
+        return 1;
+    }
+    if (auto unary = dynamic_cast<const UnaryExpression*>(expression)) {
+        double operand = estimate_cost(unary->get_operand());
+        return unary->get_operator() == UnaryExpression::Operator::Length ? operand + 4 : operand + 1;
+    }
+    if (auto binary = dynamic_cast<const BinaryExpression*>(expression)) {
+        double left = estimate_cost(binary->get_left());
+        double right = estimate_cost(binary->get_right());
+        switch (binary->get_operator()) {
+            case BinaryExpression::Operator::And:
+            case BinaryExpression::Operator::Or:
+                return left + right / 2 + 1;
+            default:
+                bool strings = is_string_operand(binary->get_left()) || is_string_operand(binary->get_right());
+                return left + right + (strings ? 4 : 1);
+        }
+    }
+    return 8;
+}
+
+// Fraction of rows expected to satisfy a predicate, from the operator alone.
+double estimate_selectivity(const Expression* expression) {
+    if (auto literal = dynamic_cast<const LiteralExpression*>(expression)) {
+        return literal->get_value().get_type() == Type::Bool && !literal->get_value().get_bool() ? 0 : 1;
+    }
+    if (auto unary = dynamic_cast<const UnaryExpression*>(expression)) {
+        if (unary->get_operator() == UnaryExpression::Operator::Not) {
+            return 1 - estimate_selectivity(unary->get_operand());
+        }
+        return 0.5;
+    }
+    auto binary = dynamic_cast<const BinaryExpression*>(expression);
+    if (!binary) {
+        return 0.5;
+    }
+    switch (binary->get_operator()) {
+        case BinaryExpression::Operator::Equal:
+            return 0.1;
+        case BinaryExpression::Operator::NotEqual:
+            return 0.9;
+        case BinaryExpression::Operator::Less:
+        case BinaryExpression::Operator::LessEqual:
+        case BinaryExpression::Operator::Greater:
+        case BinaryExpression::Operator::GreaterEqual:
+            return 1.0 / 3;
+        case BinaryExpression::Operator::And:
+            return estimate_selectivity(binary->get_left()) * estimate_selectivity(binary->get_right());
+        case BinaryExpression::Operator::Or: {
+            double left = estimate_selectivity(binary->get_left());
+            double right = estimate_selectivity(binary->get_right());
+            return left + right - left * right;
+        }
+        default:
+            return 0.5;
+    }
+}
+
+}
+
+// Division and modulo by anything but a non-zero literal may throw, which is
+// often guarded by an earlier conjunct such as `x != 0`.
+bool QueryPlanner::may_raise(const Expression* expression) {
+    if (auto unary = dynamic_cast<const UnaryExpression*>(expression)) {
+        return may_raise(unary->get_operand());
+    }
+    auto binary = dynamic_cast<const BinaryExpression*>(expression);
+    if (!binary) {
+        return false;
+    }
+    if (binary->get_operator() == BinaryExpression::Operator::Divide ||
+        binary->get_operator() == BinaryExpression::Operator::Modulo) {
+        auto divisor = dynamic_cast<const LiteralExpression*>(binary->get_right());
+        if (!divisor || divisor->get_value().get_type() != Type::Int32 || divisor->get_value().get_int() == 0) {
+            return true;
+        }
+    }
+    return may_raise(binary->get_left()) || may_raise(binary->get_right());
+}
+
+// Cheap conjuncts that reject many rows go first: conjuncts are ranked by
+// cost / (1 - selectivity), the expected work spent per rejected row.
+// A conjunct that may raise keeps its place, and nothing is moved across it.
+std::vector<const Expression*> QueryPlanner::order_conjuncts(std::vector<const Expression*> conjuncts) {
+    auto rank = [](const Expression* conjunct) {
+        double rejected = 1 - estimate_selectivity(conjunct);
+        return rejected <= 0 ? std::numeric_limits<double>::infinity() : (estimate_cost(conjunct) + 1) / rejected;
+    };
+
+    auto begin = conjuncts.begin();
+    while (begin != conjuncts.end()) {
+        auto end = std::find_if(begin, conjuncts.end(), may_raise);
+        std::vector<std::pair<double, const Expression*>> ranked;
+        for (auto it = begin; it != end; ++it) {
+            ranked.emplace_back(rank(*it), *it);
+        }
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto& left, const auto& right) {
+            return left.first < right.first;
+        });
+        for (size_t i = 0; i < ranked.size(); ++i) {
+            begin[i] = ranked[i].second;
+        }
+        begin = end == conjuncts.end() ? end : end + 1;
+    }
+    return conjuncts;
+}
+
+// Greedy left-deep ordering: start from the smallest relation and keep adding
+// the relation with the cheapest estimated step. A step over an equality key
+// costs a hash build and probe, or only probes when the new relation has an
+// index on the key; relations without a key to the joined set are cross
+// products and are only picked when nothing else is left.
+std::vector<size_t> QueryPlanner::order_joins(const std::vector<JoinRelation>& relations,
+                                              const std::vector<EquiJoinKey>& keys) {
+    std::vector<size_t> order;
+    if (relations.empty()) {
+        return order;
+    }
+
+    auto relation_of = [&](const std::string& column) -> size_t {
+        std::string qualifier = column_qualifier(column);
+        for (size_t i = 0; i < relations.size(); ++i) {
+            if (relations[i].table_name == qualifier) {
+                return i;
+            }
+        }
+        return relations.size();
+    };
+
+    std::vector<bool> joined(relations.size(), false);
+    size_t first = 0;
+    for (size_t i = 1; i < relations.size(); ++i) {
+        if (relations[i].cardinality < relations[first].cardinality) {
+            first = i;
+        }
+    }
+    order.push_back(first);
+    joined[first] = true;
+    double current = static_cast<double>(relations[first].cardinality);
+
+    while (order.size() < relations.size()) {
+        size_t best = relations.size();
+        double best_cost = std::numeric_limits<double>::infinity();
+        double best_output = 0;
+
+        for (size_t candidate = 0; candidate < relations.size(); ++candidate) {
+            if (joined[candidate]) {
+                continue;
+            }
+            const JoinRelation& relation = relations[candidate];
+            double size = std::max<double>(1, relation.cardinality);
+
+            bool connected = false;
+            bool indexed = false;
+            for (const auto& key : keys) {
+                size_t left = relation_of(key.left_column);
+                size_t right = relation_of(key.right_column);
+                std::string column;
+                if (left == candidate && right < relations.size() && joined[right]) {
+                    column = key.left_column.substr(relation.table_name.size() + 1);
+                } else if (right == candidate && left < relations.size() && joined[left]) {
+                    column = key.right_column.substr(relation.table_name.size() + 1);
+                } else {
+                    continue;
+                }
+                connected = true;
+                if (std::find(relation.indexed_columns.begin(), relation.indexed_columns.end(), column) != relation.indexed_columns.end()) {
+                    indexed = true;
+                }
+            }
+
+            double cost;
+            double output;
+            if (!connected) {
+                output = current * size;
+                cost = output * 2;
+            } else {
+                output = current * size / std::max(current, size);
+                cost = indexed ? current * std::log2(size + 1) : current + size;
+            }
+            cost += output;
+
+            if (cost < best_cost) {
+                best = candidate;
+                best_cost = cost;
+                best_output = output;
+            }
+        }
+
+        order.push_back(best);
+        joined[best] = true;
+        current = std::max(1.0, best_output);
+    }
+    return order;
+}
+
+}
+}
\ No newline at end of file
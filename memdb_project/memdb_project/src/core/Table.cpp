@@ -1,15 +1,26 @@
 #include "memdb/core/Row.h"
 #include "memdb/core/Table.h"
+#include "memdb/core/ExpressionOptimizer.h"
 #include "memdb/core/QueryParser.h"
+#include "memdb/core/QueryPlanner.h"
 
 #include "memdb/core/exceptions/DatabaseException.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 namespace memdb {
 namespace core {
 
 using json = nlohmann::json;
 
-Table::Table(const std::string& name, const std::vector<Column>& columns) : name_(name), columns_(columns), next_row_id_(1) {
+namespace {
+
+const size_t kIndexBuildGrain = 16 * 1024;
+
+}
+
+Table::Table(const std::string& name, const std::vector<Column>& columns) : name_(name), columns_(columns), zones_(columns), unique_values_(columns.size()), next_row_id_(1) {
     if (name_.empty()) {
         throw std::invalid_argument("Table name cannot be empty");
     }
@@ -71,6 +82,15 @@ void Table::add_column(const Column& column) {
             row.get_values().emplace_back(std::nullopt);
         }
     }
+
+    zones_ = ZoneMap(columns_);
+    unique_values_.emplace_back();
+    for (const auto& [id, row] : rows_) {
+        zones_.add(id, row.get_values());
+        if (is_unique_column(columns_.size() - 1) && row.get_values().back().has_value()) {
+            ++unique_values_.back()[*row.get_values().back()];
+        }
+    }
 }
 
 bool Table::has_column(const std::string& column_name) const {
@@ -82,9 +102,7 @@ bool Table::has_column(const std::string& column_name) const {
     return false;
 }
 
-RowID Table::insert_row(const std::vector<std::optional<Value>>& values) {
-    validate_row(values);
-
+std::vector<std::optional<Value>> Table::complete_row(const std::vector<std::optional<Value>>& values, RowID auto_value) const {
     std::vector<std::optional<Value>> complete_values;
     complete_values.reserve(columns_.size());
 
@@ -95,7 +113,7 @@ RowID Table::insert_row(const std::vector<std::optional<Value>>& values) {
         else {
             const auto& column = columns_[i];
             if (column.has_attribute(ColumnAttribute::AutoIncrement)) {
-                complete_values.emplace_back(static_cast<int32_t>(next_row_id_));
+                complete_values.emplace_back(static_cast<int32_t>(auto_value));
             }
             else if (column.get_default_value()) {
                 complete_values.emplace_back(*(column.get_default_value()));
@@ -106,27 +124,75 @@ RowID Table::insert_row(const std::vector<std::optional<Value>>& values) {
         }
     }
 
+    return complete_values;
+}
+
+RowID Table::insert_row(const std::vector<std::optional<Value>>& values) {
+    validate_row(values);
+
+    // Defaults and auto-increment values are checked for uniqueness too, as
+    // insert_rows does.
+    std::vector<std::optional<Value>> complete_values = complete_row(values, next_row_id_);
+    check_unique_batch({ complete_values });
+
     RowID new_id = next_row_id_++;
+    index_row(new_id, complete_values);
+    zones_.add(new_id, complete_values);
+    track_unique(complete_values, true);
     rows_.emplace(new_id, Row(new_id, complete_values));
     return new_id;
 }
 
-RowID Table::insert_row(const std::vector<std::optional<Value>>& values, RowID id) {
-    validate_row(values);
+std::vector<RowID> Table::insert_rows(const std::vector<std::vector<std::optional<Value>>>& rows) {
+    validate_rows(rows);
 
-    std::vector<std::optional<Value>> complete_values = values;
+    std::vector<std::vector<std::optional<Value>>> complete_rows;
+    std::vector<RowID> row_ids;
+    complete_rows.reserve(rows.size());
+    row_ids.reserve(rows.size());
 
-    for (size_t i = 0; i < columns_.size(); ++i) {
-        const auto& column = columns_[i];
+    RowID next_id = next_row_id_;
+    for (const auto& values : rows) {
+        complete_rows.emplace_back(complete_row(values, next_id));
+        row_ids.push_back(next_id++);
+    }
 
-        if (column.has_attribute(ColumnAttribute::AutoIncrement) && !complete_values[i].has_value()) {
-            complete_values[i] = static_cast<int32_t>(next_row_id_);
-        }
-        else if (!complete_values[i].has_value() && column.get_default_value()) {
-            complete_values[i] = *(column.get_default_value());
+    check_unique_batch(complete_rows);
+
+    for (const auto& index : indexes_) {
+        std::vector<RowID> index_ids;
+        std::vector<std::unordered_map<std::string, Value>> index_rows;
+        index_ids.reserve(complete_rows.size());
+        index_rows.reserve(complete_rows.size());
+        for (size_t i = 0; i < complete_rows.size(); ++i) {
+            auto row_map = index_row_map(*index, complete_rows[i]);
+            if (row_map) {
+                index_ids.push_back(row_ids[i]);
+                index_rows.emplace_back(std::move(*row_map));
+            }
         }
+        index->add_rows(index_ids, index_rows);
     }
 
+    for (size_t i = 0; i < complete_rows.size(); ++i) {
+        zones_.add(row_ids[i], complete_rows[i]);
+        track_unique(complete_rows[i], true);
+        rows_.emplace_hint(rows_.end(), row_ids[i], Row(row_ids[i], std::move(complete_rows[i])));
+    }
+    next_row_id_ = next_id;
+
+    return row_ids;
+}
+
+RowID Table::insert_row(const std::vector<std::optional<Value>>& values, RowID id) {
+    validate_row(values);
+    if (id != 0 && rows_.count(id) > 0) {
+        throw std::invalid_argument("Row ID already exists: " + std::to_string(id));
+    }
+
+    std::vector<std::optional<Value>> complete_values = complete_row(values, next_row_id_);
+    check_unique_batch({ complete_values });
+
     RowID new_id;
     if (id != 0) {
         new_id = id;
@@ -138,59 +204,35 @@ RowID Table::insert_row(const std::vector<std::optional<Value>>& values, RowID i
         new_id = next_row_id_++;
     }
 
-    for (size_t i = 0; i < columns_.size(); ++i) {
-        const auto& column = columns_[i];
-        if (column.has_attribute(ColumnAttribute::Unique) || column.has_attribute(ColumnAttribute::Key)) {
-            if (complete_values[i].has_value()) {
-                const Value& new_val = *(complete_values[i]);
-
-                for (const auto& [existing_id, existing_row] : rows_) {
-                    if (existing_id == new_id) {
-                        continue;
-                    }
-
-                    const auto& existing_val_opt = existing_row.get_value(i);
-                    if (existing_val_opt.has_value()) {
-                        const Value& existing_val = *(existing_val_opt);
-
-                        if (new_val.get_type() != existing_val.get_type()) {
-                            continue;
-                        }
-
-                        bool equal = false;
-                        switch (new_val.get_type()) {
-                            case Type::Int32:
-                                equal = (new_val.get_int() == existing_val.get_int());
-                                break;
-                            case Type::Bool:
-                                equal = (new_val.get_bool() == existing_val.get_bool());
-                                break;
-                            case Type::String:
-                                equal = (new_val.get_string() == existing_val.get_string());
-                                break;
-                            case Type::Bytes:
-                                equal = (new_val.get_bytes() == existing_val.get_bytes());
-                                break;
-                            default:
-                                break;
-                        }
+    index_row(new_id, complete_values);
+    zones_.add(new_id, complete_values);
+    track_unique(complete_values, true);
+    rows_.emplace(new_id, Row(new_id, complete_values));
+    return new_id;
+}
 
-                        if (equal) {
-                            throw std::invalid_argument("Duplicate value for unique/key column '" + column.get_name() + "'.");
-                        }
-                    }
-                }
-            }
-        }
+void Table::update_row(RowID id, const std::vector<std::optional<Value>>& values) {
+    auto it = rows_.find(id);
+    if (it == rows_.end()) {
+        throw std::invalid_argument("Row ID not found: " + std::to_string(id));
     }
+    validate_row_update(values, id);
 
-    rows_.emplace(new_id, Row(new_id, complete_values));
-    return new_id;
+    unindex_row(id, it->second.get_values());
+    zones_.remove(id, it->second.get_values());
+    track_unique(it->second.get_values(), false);
+    it->second.get_values() = values;
+    index_row(id, it->second.get_values());
+    zones_.add(id, it->second.get_values());
+    track_unique(it->second.get_values(), true);
 }
 
 void Table::delete_row(RowID id) {
     auto it = rows_.find(id);
     if (it != rows_.end()) {
+        unindex_row(id, it->second.get_values());
+        zones_.remove(id, it->second.get_values());
+        track_unique(it->second.get_values(), false);
         rows_.erase(it);
     }
     else {
@@ -223,7 +265,7 @@ const std::map<RowID, Row>& Table::get_all_rows() const {
 }
 
 
-void Table::add_index(const std::string& index_type_str, const std::vector<std::string>& columns) {
+void Table::add_index(const std::string& index_type_str, const std::vector<std::string>& columns, ThreadPool* pool) {
     IndexType index_type;
     if (index_type_str == "ordered") {
         index_type = IndexType::Ordered;
@@ -237,50 +279,144 @@ void Table::add_index(const std::string& index_type_str, const std::vector<std::
 
     std::unique_ptr<Index> index = std::make_unique<Index>(index_type, columns);
 
+    std::vector<RowID> row_ids;
+    std::vector<const Row*> rows;
+    row_ids.reserve(rows_.size());
+    rows.reserve(rows_.size());
     for (const auto& [row_id, row] : rows_) {
-        std::unordered_map<std::string, Value> row_map;
+        row_ids.push_back(row_id);
+        rows.push_back(&row);
+    }
+    std::vector<size_t> col_indices;
+    if (!rows.empty()) {
         for (const auto& col_name : columns) {
-            size_t col_index = get_column_index(col_name);
-            if (row.get_values()[col_index].has_value()) {
-                row_map[col_name] = *(row.get_values()[col_index]);
-            }
-            else {
-                throw std::invalid_argument("Cannot index NULL value in column '" + col_name + "'.");
+            col_indices.push_back(get_column_index(col_name));
+        }
+    }
+
+    // Key maps are built in parallel; the index itself is filled in one batch.
+    std::vector<std::unordered_map<std::string, Value>> row_maps(rows.size());
+    auto build_row_maps = [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                const auto& value = rows[r]->get_values()[col_indices[c]];
+                if (!value.has_value()) {
+                    throw std::invalid_argument("Cannot index NULL value in column '" + columns[c] + "'.");
+                }
+                row_maps[r][columns[c]] = *value;
             }
         }
-        index->add_row(row_id, row_map);
+    };
+    if (pool != nullptr) {
+        pool->parallel_for(rows.size(), kIndexBuildGrain, build_row_maps);
+    } else {
+        build_row_maps(0, rows.size());
     }
+    index->add_rows(row_ids, row_maps);
 
     indexes_.emplace_back(std::move(index));
 }
 
-std::vector<RowID> Table::find_rows(const std::unique_ptr<Expression>& condition) const {
-    std::vector<RowID> matching_rows;
-    for (const auto& [row_id, row] : rows_) {
+std::vector<RowID> Table::find_rows(const std::unique_ptr<Expression>& condition, ThreadPool* pool,
+                                    const QueryOptions& options) const {
+    if (ExpressionOptimizer::is_false(condition.get())) {
+        return {};
+    }
+    std::vector<ZoneMap::Range> ranges =
+        zones_.resolve(QueryPlanner::literal_ranges(QueryPlanner::split_conjuncts(condition.get()), ""));
+    auto match_rows = [&](std::map<RowID, Row>::const_iterator begin, std::map<RowID, Row>::const_iterator end,
+                          std::vector<RowID>& matching_rows) {
         std::unordered_map<std::string, Value> row_map;
-        for (size_t i = 0; i < columns_.size(); ++i) {
-            if (row.get_values()[i].has_value()) {
-                row_map[columns_[i].get_name()] = *(row.get_values()[i]);
+        uint64_t zone_end = 0;
+        for (auto it = begin; it != end; ++it) {
+            if (!ranges.empty() && it->first >= zone_end) {
+                it = zones_.seek(rows_, it, end, ranges);
+                if (it == end) {
+                    break;
+                }
+                zone_end = ZoneMap::block_end(it->first);
+            }
+            const Row& row = it->second;
+            row_map.clear();
+            for (size_t i = 0; i < columns_.size(); ++i) {
+                if (row.get_values()[i].has_value()) {
+                    row_map[columns_[i].get_name()] = *(row.get_values()[i]);
+                }
+            }
+
+            bool match = true;
+            if (condition) {
+                Value cond = condition->evaluate(row_map);
+                if (cond.get_type() != Type::Bool) {
+                    throw std::invalid_argument("WHERE clause does not evaluate to a boolean.");
+                }
+                match = cond.get_bool();
             }
-        }
 
-        bool match = true;
-        if (condition) {
-            Value cond = condition->evaluate(row_map);
-            if (cond.get_type() != Type::Bool) {
-                throw std::invalid_argument("WHERE clause does not evaluate to a boolean.");
+            if (match) {
+                matching_rows.push_back(it->first);
             }
-            match = cond.get_bool();
         }
+    };
 
-        if (match) {
-            matching_rows.push_back(row_id);
+    std::vector<RowID> matching_rows;
+    size_t morsel_size = std::max<size_t>(1, options.morsel_size);
+    if (pool == nullptr || options.num_threads == 1 || !condition || rows_.size() <= morsel_size) {
+        match_rows(rows_.begin(), rows_.end(), matching_rows);
+        return matching_rows;
+    }
+
+    std::vector<std::map<RowID, Row>::const_iterator> bounds;
+    size_t position = 0;
+    for (auto it = rows_.begin(); it != rows_.end(); ++it, ++position) {
+        if (position % morsel_size == 0) {
+            bounds.push_back(it);
         }
     }
+    bounds.push_back(rows_.end());
 
+    std::vector<std::vector<RowID>> morsels(bounds.size() - 1);
+    pool->run(morsels.size(), [&](size_t m) {
+        match_rows(bounds[m], bounds[m + 1], morsels[m]);
+    }, options.num_threads);
+
+    matching_rows.reserve(rows_.size());
+    for (const auto& morsel : morsels) {
+        matching_rows.insert(matching_rows.end(), morsel.begin(), morsel.end());
+    }
     return matching_rows;
 }
 
+std::optional<std::unordered_map<std::string, Value>> Table::index_row_map(const Index& index, const std::vector<std::optional<Value>>& values) const {
+    std::unordered_map<std::string, Value> row_map;
+    for (const auto& col_name : index.get_columns()) {
+        size_t col_index = get_column_index(col_name);
+        if (col_index >= values.size() || !values[col_index].has_value()) {
+            return std::nullopt;
+        }
+        row_map[col_name] = *(values[col_index]);
+    }
+    return row_map;
+}
+
+void Table::index_row(RowID id, const std::vector<std::optional<Value>>& values) {
+    for (const auto& index : indexes_) {
+        auto row_map = index_row_map(*index, values);
+        if (row_map) {
+            index->add_row(id, *row_map);
+        }
+    }
+}
+
+void Table::unindex_row(RowID id, const std::vector<std::optional<Value>>& values) {
+    for (const auto& index : indexes_) {
+        auto row_map = index_row_map(*index, values);
+        if (row_map) {
+            index->remove_row(id, *row_map);
+        }
+    }
+}
+
 void Table::validate_row(const std::vector<std::optional<Value>>& values) const {
     if (values.size() > columns_.size()) {
         throw std::invalid_argument("Too many values provided for insertion.");
@@ -315,47 +451,96 @@ void Table::validate_row(const std::vector<std::optional<Value>>& values) const
     }
 
     for (size_t i = 0; i < values.size(); ++i) {
-        if (!values[i].has_value()) {
-            continue;
+        if (values[i].has_value() && is_unique_column(i) && unique_count(i, *(values[i])) > 0) {
+            throw std::invalid_argument("Duplicate value for unique/key column \"" +
+                                        columns_[i].get_name() + "\".");
         }
+    }
+}
+
+void Table::validate_rows(const std::vector<std::vector<std::optional<Value>>>& rows) const {
+    for (const auto& values : rows) {
+        if (values.size() > columns_.size()) {
+            throw std::invalid_argument("Too many values provided for insertion.");
+        }
+    }
 
+    for (size_t i = 0; i < columns_.size(); ++i) {
         const auto& column = columns_[i];
-        if (column.has_attribute(ColumnAttribute::Unique) || column.has_attribute(ColumnAttribute::Key)) {
-            const Value& new_value = *(values[i]);
-
-            for (const auto& [existing_id, existing_row] : rows_) {
-                const auto& existing_value_opt = existing_row.get_value(i);
-                if (existing_value_opt.has_value()) {
-                    const Value& existing_value = *(existing_value_opt);
-                    if (new_value.get_type() == existing_value.get_type()) {
-                        bool equal = false;
-                        switch (new_value.get_type()) {
-                            case Type::Int32:
-                                equal = (new_value.get_int() == existing_value.get_int());
-                                break;
-                            case Type::Bool:
-                                equal = (new_value.get_bool() == existing_value.get_bool());
-                                break;
-                            case Type::String:
-                                equal = (new_value.get_string() == existing_value.get_string());
-                                break;
-                            case Type::Bytes:
-                                equal = (new_value.get_bytes() == existing_value.get_bytes());
-                                break;
-                            default:
-                                break;
-                        }
-                        if (equal) {
-                            throw std::invalid_argument("Duplicate value for unique/key column \"" +
-                                                        column.get_name() + "\".");
-                        }
-                    }
+        const Type expected = column.get_type().get_type();
+        const bool sized = column.get_type().is_string() || column.get_type().is_bytes();
+        const size_t max_size = sized ? column.get_type().get_size() : 0;
+
+        for (size_t r = 0; r < rows.size(); ++r) {
+            if (i >= rows[r].size() || !rows[r][i].has_value()) {
+                continue;
+            }
+
+            const auto& value = *(rows[r][i]);
+            if (value.get_type() != expected) {
+                throw std::invalid_argument("Type mismatch for column \"" + column.get_name() +
+                                            "\" in row " + std::to_string(r + 1) +
+                                            ". Expected: " + column.get_type().to_string() +
+                                            ", Got: " + value.to_string());
+            }
+            if (sized) {
+                size_t value_size = (expected == Type::String) ? value.get_string().size() : value.get_bytes().size();
+                if (value_size > max_size) {
+                    throw std::invalid_argument("Value for column \"" + column.get_name() +
+                                                "\" in row " + std::to_string(r + 1) +
+                                                (expected == Type::String ? " exceeds maximum length." : " exceeds maximum byte size."));
                 }
             }
         }
     }
 }
 
+// Incoming values are hashed once per column and probed against the value
+// counts kept for the table, so a batch costs time in its own size only.
+void Table::check_unique_batch(const std::vector<std::vector<std::optional<Value>>>& rows) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (!is_unique_column(i)) {
+            continue;
+        }
+
+        std::unordered_set<Value, ValueHash> seen;
+        seen.reserve(rows.size());
+        for (const auto& values : rows) {
+            if (i < values.size() && values[i].has_value() &&
+                (unique_count(i, *(values[i])) > 0 || !seen.insert(*(values[i])).second)) {
+                throw std::invalid_argument("Duplicate value for unique/key column \"" +
+                                            columns_[i].get_name() + "\".");
+            }
+        }
+    }
+}
+
+bool Table::is_unique_column(size_t column) const {
+    return columns_[column].has_attribute(ColumnAttribute::Unique) || columns_[column].has_attribute(ColumnAttribute::Key);
+}
+
+size_t Table::unique_count(size_t column, const Value& value) const {
+    auto it = unique_values_[column].find(value);
+    return it == unique_values_[column].end() ? 0 : it->second;
+}
+
+void Table::track_unique(const std::vector<std::optional<Value>>& values, bool add) {
+    for (size_t i = 0; i < columns_.size() && i < values.size(); ++i) {
+        if (!is_unique_column(i) || !values[i].has_value()) {
+            continue;
+        }
+        auto& counts = unique_values_[i];
+        if (add) {
+            ++counts[*(values[i])];
+            continue;
+        }
+        auto it = counts.find(*(values[i]));
+        if (it != counts.end() && --it->second == 0) {
+            counts.erase(it);
+        }
+    }
+}
+
 void Table::validate_row_update(const std::vector<std::optional<Value>>& updated_values, RowID current_row_id) const {
     if (updated_values.size() > columns_.size()) {
         throw std::invalid_argument("Too many values provided for the row update.");
@@ -389,50 +574,16 @@ void Table::validate_row_update(const std::vector<std::optional<Value>>& updated
         }
     }
 
+    // The row's own value does not count as a duplicate.
+    auto current = rows_.find(current_row_id);
     for (size_t i = 0; i < updated_values.size(); ++i) {
-        if (!updated_values[i].has_value()) {
+        if (!updated_values[i].has_value() || !is_unique_column(i)) {
             continue;
         }
-
-        const Column& column = columns_[i];
-        if (column.has_attribute(ColumnAttribute::Unique) || column.has_attribute(ColumnAttribute::Key)) {
-            const Value& new_value = updated_values[i].value();
-
-            for (const auto& [existing_id, existing_row] : rows_) {
-                if (existing_id == current_row_id) {
-                    continue; 
-                }
-
-                const auto& existing_value_opt = existing_row.get_value(i);
-                if (!existing_value_opt.has_value()) {
-                    continue;
-                }
-
-                const Value& existing_value = existing_value_opt.value();
-
-                bool equal = false;
-                switch (new_value.get_type()) {
-                    case Type::Int32:
-                        equal = (new_value.get_int() == existing_value.get_int());
-                        break;
-                    case Type::Bool:
-                        equal = (new_value.get_bool() == existing_value.get_bool());
-                        break;
-                    case Type::String:
-                        equal = (new_value.get_string() == existing_value.get_string());
-                        break;
-                    case Type::Bytes:
-                        equal = (new_value.get_bytes() == existing_value.get_bytes());
-                        break;
-                    default:
-                        break;
-                }
-
-                if (equal) {
-                    throw std::invalid_argument("Duplicate value for unique/key column '" +
-                                                column.get_name() + "'.");
-                }
-            }
+        bool own = current != rows_.end() && current->second.get_value(i) == updated_values[i];
+        if (unique_count(i, *(updated_values[i])) > (own ? 1u : 0u)) {
+            throw std::invalid_argument("Duplicate value for unique/key column '" +
+                                        columns_[i].get_name() + "'.");
         }
     }
 }
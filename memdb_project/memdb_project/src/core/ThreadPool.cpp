@@ -0,0 +1,204 @@
+#include "memdb/core/ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+// The pool and worker index of the current thread, if it is a pool worker.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+// Progress of one run() call. Helper jobs that are dequeued after the caller
+// has finished find the batch closed and return without touching the task.
+struct Batch {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> failed_at{SIZE_MAX};
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable idle;
+    size_t active = 0;
+    bool closed = false;
+};
+
+// Indices are handed out in order, so every index below a failed one has
+// already been taken and runs to the end; only the indices above it are
+// skipped, and the lowest failure is the one kept.
+void drain(Batch& batch, size_t count, const std::function<void(size_t)>& task) {
+    for (size_t i = batch.next++; i < count && i < batch.failed_at; i = batch.next++) {
+        try {
+            task(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (i < batch.failed_at) {
+                batch.error = std::current_exception();
+                batch.failed_at = i;
+            }
+        }
+    }
+}
+
+void pin_to_cpu(std::thread& thread, size_t cpu) {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpus);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+    : size_(options.num_threads), pin_threads_(options.pin_threads) {
+    if (size_ == 0) {
+        size_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t w = 1; w < size_; ++w) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    available_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::start() {
+    std::call_once(started_, [this]() {
+        for (size_t w = 0; w < workers_.size(); ++w) {
+            threads_.emplace_back([this, w]() { work(w); });
+            if (pin_threads_) {
+                // CPU 0 is left to the threads calling run().
+                pin_to_cpu(threads_.back(), w + 1);
+            }
+        }
+    });
+}
+
+void ThreadPool::submit(std::vector<std::function<void()>> jobs) {
+    for (auto& job : jobs) {
+        size_t worker = current_pool == this ? current_worker : next_worker_++ % workers_.size();
+        std::lock_guard<std::mutex> lock(workers_[worker]->mutex);
+        workers_[worker]->jobs.push_back(std::move(job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ += static_cast<long>(jobs.size());
+    }
+    available_.notify_all();
+}
+
+bool ThreadPool::take(size_t worker, std::function<void()>& job) {
+    {
+        Worker& own = *workers_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(worker + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t worker) {
+    current_pool = this;
+    current_worker = worker;
+    while (true) {
+        std::function<void()> job;
+        if (take(worker, job)) {
+            --pending_;
+            job();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [this]() { return stopping_ || pending_ > 0; });
+        if (stopping_ && pending_ <= 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)>& task, size_t max_workers) {
+    if (max_workers == 0 || max_workers > size_) {
+        max_workers = size_;
+    }
+    size_t helpers = std::min(max_workers, count);
+    helpers = helpers > 0 ? helpers - 1 : 0;
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    start();
+    auto batch = std::make_shared<Batch>();
+    std::vector<std::function<void()>> jobs;
+    for (size_t h = 0; h < helpers; ++h) {
+        jobs.emplace_back([batch, count, &task]() {
+            {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                if (batch->closed) {
+                    return;
+                }
+                ++batch->active;
+            }
+            drain(*batch, count, task);
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            if (--batch->active == 0) {
+                batch->idle.notify_all();
+            }
+        });
+    }
+    submit(std::move(jobs));
+
+    // The caller works too, so a task may itself call run() without waiting
+    // on helpers that no free thread would pick up.
+    drain(*batch, count, task);
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->closed = true;
+    batch->idle.wait(lock, [&]() { return batch->active == 0; });
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn,
+                              size_t max_workers) {
+    grain = std::max<size_t>(1, grain);
+    run((count + grain - 1) / grain, [&](size_t range) {
+        fn(range * grain, std::min(count, (range + 1) * grain));
+    }, max_workers);
+}
+
+}
+}
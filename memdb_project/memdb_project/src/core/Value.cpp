@@ -2,6 +2,9 @@
 
 #include "memdb/core/exceptions/TypeMismatchException.h"
 
+#include <functional>
+#include <string_view>
+
 namespace memdb {
 namespace core {
 
@@ -139,5 +142,48 @@ std::string Value::to_string() const {
     }
 }
 
+bool Value::operator==(const Value& other) const {
+    return data_ == other.data_;
+}
+
+bool Value::operator!=(const Value& other) const {
+    return !(*this == other);
+}
+
+bool Value::operator<(const Value& other) const {
+    return data_ < other.data_;
+}
+
+size_t ValueHash::operator()(const Value& value) const {
+    if (!value.has_value()) {
+        return 0;
+    }
+
+    const auto& variant = value.get_variant();
+    size_t seed = variant.index();
+    size_t hash = 0;
+    switch (variant.index()) {
+        case 0:
+            hash = std::hash<int32_t>{}(std::get<int32_t>(variant));
+            break;
+        case 1:
+            hash = std::hash<bool>{}(std::get<bool>(variant));
+            break;
+        case 2:
+            hash = std::hash<std::string>{}(std::get<std::string>(variant));
+            break;
+        case 3:
+        {
+            const auto& bytes = std::get<std::vector<uint8_t>>(variant);
+            hash = std::hash<std::string_view>{}(
+                std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+            break;
+        }
+        default:
+            break;
+    }
+    return hash ^ (seed + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
 }
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "memdb/core/ZoneMap.h"
+
+#include <limits>
+
+namespace memdb {
+namespace core {
+
+namespace {
+
+bool has_bounds(Type type) {
+    return type == Type::Int32 || type == Type::String || type == Type::Bytes;
+}
+
+bool is_null(const std::optional<Value>& value) {
+    return !value.has_value() || !value->has_value();
+}
+
+}
+
+ZoneMap::ZoneMap(const std::vector<Column>& columns) {
+    for (const auto& column : columns) {
+        names_.push_back(column.get_name());
+        types_.push_back(column.get_type().get_type());
+    }
+}
+
+void ZoneMap::add(RowID id, const std::vector<std::optional<Value>>& values) {
+    Zone& zone = zones_[id / kBlockRows];
+    if (zone.rows == 0) {
+        zone.nulls.assign(types_.size(), 0);
+        zone.min.assign(types_.size(), std::nullopt);
+        zone.max.assign(types_.size(), std::nullopt);
+    }
+    ++zone.rows;
+    for (size_t i = 0; i < types_.size(); ++i) {
+        if (i >= values.size() || is_null(values[i])) {
+            ++zone.nulls[i];
+            continue;
+        }
+        if (!has_bounds(types_[i])) {
+            continue;
+        }
+        const Value& value = *values[i];
+        if (!zone.min[i] || value < *zone.min[i]) {
+            zone.min[i] = value;
+        }
+        if (!zone.max[i] || *zone.max[i] < value) {
+            zone.max[i] = value;
+        }
+    }
+}
+
+void ZoneMap::remove(RowID id, const std::vector<std::optional<Value>>& values) {
+    auto it = zones_.find(id / kBlockRows);
+    if (it == zones_.end()) {
+        return;
+    }
+    Zone& zone = it->second;
+    if (--zone.rows == 0) {
+        zones_.erase(it);
+        return;
+    }
+    for (size_t i = 0; i < types_.size(); ++i) {
+        if ((i >= values.size() || is_null(values[i])) && zone.nulls[i] > 0) {
+            --zone.nulls[i];
+        }
+    }
+}
+
+const ZoneMap::Zone* ZoneMap::get_zone(RowID block) const {
+    auto it = zones_.find(block);
+    return it == zones_.end() ? nullptr : &it->second;
+}
+
+std::vector<ZoneMap::Range> ZoneMap::resolve(const std::vector<ColumnRange>& ranges) const {
+    std::vector<Range> resolved;
+    for (const auto& range : ranges) {
+        for (size_t i = 0; i < names_.size(); ++i) {
+            if (names_[i] != range.column || !has_bounds(types_[i])) {
+                continue;
+            }
+            bool typed = (!range.lower || range.lower->get_type() == types_[i]) &&
+                         (!range.upper || range.upper->get_type() == types_[i]);
+            if (typed && (range.lower || range.upper)) {
+                resolved.push_back(Range{i, range});
+            }
+        }
+    }
+    return resolved;
+}
+
+bool ZoneMap::may_match(RowID block, const std::vector<Range>& ranges) const {
+    const Zone* zone = get_zone(block);
+    if (zone == nullptr) {
+        return true;
+    }
+    for (const auto& [column, range] : ranges) {
+        if (zone->nulls[column] > 0 || !zone->min[column] || !zone->max[column]) {
+            continue;
+        }
+        const Value& min = *zone->min[column];
+        const Value& max = *zone->max[column];
+        if (range.lower && (max < *range.lower || (max == *range.lower && !range.lower_inclusive))) {
+            return false;
+        }
+        if (range.upper && (*range.upper < min || (min == *range.upper && !range.upper_inclusive))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::map<RowID, Row>::const_iterator ZoneMap::seek(const std::map<RowID, Row>& rows,
+                                                   std::map<RowID, Row>::const_iterator it,
+                                                   std::map<RowID, Row>::const_iterator end,
+                                                   const std::vector<Range>& ranges) const {
+    while (it != end && !may_match(it->first / kBlockRows, ranges)) {
+        uint64_t next = block_end(it->first);
+        if (next > std::numeric_limits<RowID>::max() || (end != rows.end() && end->first < next)) {
+            return end;
+        }
+        it = rows.lower_bound(static_cast<RowID>(next));
+    }
+    return it;
+}
+
+}
+}
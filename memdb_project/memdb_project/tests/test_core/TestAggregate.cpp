@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "memdb/core/Database.h"
+
+#include <map>
+
+namespace {
+
+void create_sales_table(memdb::core::Database& db, int row_count) {
+    ASSERT_TRUE(db.execute("create table sales (id : int32, region: string[8], amount: int32);").is_ok());
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    const std::vector<std::string> regions = {"north", "south", "east"};
+    for (int i = 0; i < row_count; ++i) {
+        rows.push_back({memdb::core::Value(i), memdb::core::Value(regions[i % 3]), memdb::core::Value(i % 50)});
+    }
+    db.insert_rows("sales", rows);
+}
+
+}
+
+TEST(AggregateTest, GroupByWithAllAggregates) {
+    memdb::core::Database db;
+    create_sales_table(db, 300);
+
+    memdb::core::QueryResult result = db.execute("select region, count(*), sum(amount) as total, min(amount), max(amount), avg(amount) from sales group by region order by region;");
+
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    ASSERT_EQ(result.get_data().size(), 3);
+    EXPECT_EQ(result.get_columns()[2].get_name(), "total");
+
+    std::map<std::string, std::vector<int>> expected;
+    for (int i = 0; i < 300; ++i) {
+        expected[std::vector<std::string>{"north", "south", "east"}[i % 3]].push_back(i % 50);
+    }
+    const std::vector<std::string> order = {"east", "north", "south"};
+    for (size_t g = 0; g < 3; ++g) {
+        const auto& row = result.get_data()[g];
+        const auto& amounts = expected[order[g]];
+        int sum = 0;
+        for (int amount : amounts) {
+            sum += amount;
+        }
+        EXPECT_EQ(row[0]->get_string(), order[g]);
+        EXPECT_EQ(row[1]->get_int(), static_cast<int>(amounts.size()));
+        EXPECT_EQ(row[2]->get_int(), sum);
+        EXPECT_EQ(row[3]->get_int(), *std::min_element(amounts.begin(), amounts.end()));
+        EXPECT_EQ(row[4]->get_int(), *std::max_element(amounts.begin(), amounts.end()));
+        EXPECT_EQ(row[5]->get_int(), sum / static_cast<int>(amounts.size()));
+    }
+}
+
+TEST(AggregateTest, AggregatesWithoutGroupBy) {
+    memdb::core::Database db;
+    create_sales_table(db, 100);
+
+    memdb::core::QueryResult result = db.execute("select count(*), sum(amount) / count(amount) as mean from sales where amount >= 40;");
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    ASSERT_EQ(result.get_data().size(), 1);
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 20);
+    EXPECT_EQ(result.get_data()[0][1]->get_int(), 44);
+
+    result = db.execute("select count(*), sum(amount), max(region) from sales where amount > 100;");
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    ASSERT_EQ(result.get_data().size(), 1);
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 0);
+    EXPECT_FALSE(result.get_data()[0][1].has_value());
+    EXPECT_FALSE(result.get_data()[0][2].has_value());
+}
+
+TEST(AggregateTest, SortFallbackMatchesHashAggregation) {
+    memdb::core::Database db;
+    create_sales_table(db, 5000);
+    std::string query = "select amount % 37 as bucket, region, count(*), sum(id) from sales group by amount % 37, region order by bucket, region;";
+
+    memdb::core::QueryResult hashed = db.execute(query);
+    ASSERT_TRUE(hashed.is_ok()) << hashed.get_error();
+    ASSERT_EQ(hashed.get_data().size(), 37 * 3);
+
+    db.set_aggregation_memory_budget(1024);
+    memdb::core::QueryResult sorted = db.execute(query);
+    ASSERT_TRUE(sorted.is_ok()) << sorted.get_error();
+    ASSERT_EQ(sorted.get_data().size(), hashed.get_data().size());
+    for (size_t i = 0; i < sorted.get_data().size(); ++i) {
+        for (size_t c = 0; c < 4; ++c) {
+            EXPECT_EQ(*sorted.get_data()[i][c], *hashed.get_data()[i][c]);
+        }
+    }
+}
+
+TEST(AggregateTest, InvalidAggregateQueries) {
+    memdb::core::Database db;
+    create_sales_table(db, 10);
+
+    EXPECT_FALSE(db.execute("select id, count(*) from sales group by region;").is_ok());
+    EXPECT_FALSE(db.execute("select region from sales where count(*) > 1 group by region;").is_ok());
+    EXPECT_FALSE(db.execute("select sum(region) from sales;").is_ok());
+    EXPECT_FALSE(db.execute("select median(amount) from sales;").is_ok());
+}
+
+TEST(AggregateTest, GroupByOverJoin) {
+    memdb::core::Database db;
+    create_sales_table(db, 30);
+    ASSERT_TRUE(db.execute("create table regions (name : string[8], manager: string[16]);").is_ok());
+    ASSERT_TRUE(db.execute("insert (\"north\", \"Ann\"), (\"south\", \"Bob\"), (\"east\", \"Cid\") to regions;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select regions.manager, count(*) as orders from sales join regions on sales.region = regions.name where sales.amount < 15 group by regions.manager order by orders desc, regions.manager;");
+
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    ASSERT_EQ(result.get_data().size(), 3);
+    EXPECT_EQ(result.get_data()[0][0]->get_string(), "Ann");
+    EXPECT_EQ(result.get_data()[0][1]->get_int(), 5);
+    EXPECT_EQ(result.get_data()[1][1]->get_int(), 5);
+    EXPECT_EQ(result.get_data()[2][0]->get_string(), "Cid");
+    EXPECT_EQ(result.get_data()[2][1]->get_int(), 5);
+}
+TEST(AggregateTest, ParallelAggregationMatchesSerial) {
+    memdb::core::ThreadPoolOptions pool_options;
+    pool_options.num_threads = 4;
+    memdb::core::Database db(pool_options);
+    create_sales_table(db, 20000);
+
+    memdb::core::QueryOptions serial;
+    serial.num_threads = 1;
+    memdb::core::QueryOptions parallel;
+    parallel.morsel_size = 700;
+
+    const std::vector<std::string> queries = {
+        "select amount, region, count(*), sum(id), min(id), max(id), avg(amount) from sales where id % 3 != 1 group by amount, region;",
+        "select count(*), sum(amount), max(region) from sales;",
+        "select id % 997 as bucket, count(*) from sales group by id % 997 order by bucket desc;"
+    };
+    for (const auto& query : queries) {
+        memdb::core::QueryResult expected = db.execute(query, serial);
+        memdb::core::QueryResult actual = db.execute(query, parallel);
+        ASSERT_TRUE(expected.is_ok()) << query << ": " << expected.get_error();
+        ASSERT_TRUE(actual.is_ok()) << query << ": " << actual.get_error();
+        EXPECT_EQ(actual.get_data(), expected.get_data()) << query;
+    }
+
+    db.set_aggregation_memory_budget(4096);
+    memdb::core::QueryResult expected = db.execute(queries[2], serial);
+    memdb::core::QueryResult actual = db.execute(queries[2], parallel);
+    ASSERT_TRUE(actual.is_ok()) << actual.get_error();
+    EXPECT_EQ(actual.get_data(), expected.get_data());
+    EXPECT_EQ(actual.get_data().size(), 997);
+}
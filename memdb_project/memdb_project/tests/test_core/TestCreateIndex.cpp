@@ -292,3 +292,71 @@ TEST(CreateIndexTest, CompositeIndexUsage) {
         EXPECT_EQ(row[2]->get_string(), "Sub2");
     }
 }
+
+TEST(CreateIndexTest, ParallelIndexBuildMatchesScan) {
+    memdb::core::ThreadPoolOptions pool_options;
+    pool_options.num_threads = 4;
+    memdb::core::Database db(pool_options);
+    ASSERT_TRUE(db.execute("create table items (id : int32, price: int32, label: string[8]);").is_ok());
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    for (int i = 0; i < 50000; ++i) {
+        rows.push_back({memdb::core::Value(i), memdb::core::Value((i * 7919) % 1000), memdb::core::Value("l" + std::to_string(i % 20))});
+    }
+    db.insert_rows("items", rows);
+
+    const std::vector<std::string> queries = {
+        "select id from items where price >= 500 && price < 510;",
+        "select id from items where label = \"l7\" && price = 7;"
+    };
+    std::vector<memdb::core::QueryResult> scanned;
+    for (const auto& query : queries) {
+        scanned.push_back(db.execute(query));
+        ASSERT_TRUE(scanned.back().is_ok());
+    }
+
+    ASSERT_TRUE(db.execute("create ordered index on items by price;").is_ok());
+    ASSERT_TRUE(db.execute("create unordered index on items by label;").is_ok());
+    ASSERT_EQ(db.get_table("items")->get_indexes()[0]->get_ordered_entries().size(), 50000);
+
+    for (size_t q = 0; q < queries.size(); ++q) {
+        memdb::core::QueryResult indexed = db.execute(queries[q]);
+        ASSERT_TRUE(indexed.is_ok());
+        EXPECT_EQ(indexed.get_data(), scanned[q].get_data()) << queries[q];
+    }
+}
+
+TEST(CreateIndexTest, ConjunctsAnsweredByIndexMatchScan) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table items (id : int32, price: int32, label: string[8]);").is_ok());
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    for (int i = 0; i < 2000; ++i) {
+        rows.push_back({memdb::core::Value(i), memdb::core::Value((i * 7919) % 1000), memdb::core::Value("l" + std::to_string(i % 20))});
+    }
+    db.insert_rows("items", rows);
+
+    // Comparisons the index guarantees are not evaluated again; ranges on the
+    // unordered index and columns shadowed by an alias still are.
+    const std::vector<std::string> queries = {
+        "select id from items where price > 500 && price <= 510;",
+        "select id from items where 7 = price && label = \"l13\";",
+        "select id from items where label = \"l3\" && price < 100 && id > 1000;",
+        "select id from items where label > \"l3\" && label < \"l5\";",
+        "select id, label as price from items where price = \"l3\";",
+        "select id, price + 1 as price from items where price = 8;"
+    };
+    std::vector<memdb::core::QueryResult> scanned;
+    for (const auto& query : queries) {
+        scanned.push_back(db.execute(query));
+        ASSERT_TRUE(scanned.back().is_ok()) << query << ": " << scanned.back().get_error();
+        EXPECT_FALSE(scanned.back().get_data().empty()) << query;
+    }
+
+    ASSERT_TRUE(db.execute("create ordered index on items by price;").is_ok());
+    ASSERT_TRUE(db.execute("create unordered index on items by label;").is_ok());
+
+    for (size_t q = 0; q < queries.size(); ++q) {
+        memdb::core::QueryResult indexed = db.execute(queries[q]);
+        ASSERT_TRUE(indexed.is_ok()) << queries[q];
+        EXPECT_EQ(indexed.get_data(), scanned[q].get_data()) << queries[q];
+    }
+}
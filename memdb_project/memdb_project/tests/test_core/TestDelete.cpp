@@ -539,4 +539,28 @@ TEST(DeleteTest, DeleteWithConstraintViolationsInPostDelete) {
                            << "customer_id=" << std::get<1>(expected) << ", "
                            << "amount=" << std::get<2>(expected);
     }
-}
\ No newline at end of file
+}
+TEST(DeleteTest, DeleteManyRowsInParallel) {
+    memdb::core::ThreadPoolOptions pool_options;
+    pool_options.num_threads = 4;
+    memdb::core::Database db(pool_options);
+    ASSERT_TRUE(db.execute("create table items (id : int32, quantity: int32);").is_ok());
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    for (int i = 0; i < 10000; ++i) {
+        rows.push_back({memdb::core::Value(i), memdb::core::Value(i % 10)});
+    }
+    db.insert_rows("items", rows);
+
+    memdb::core::QueryOptions options;
+    options.morsel_size = 256;
+    memdb::core::QueryResult result = db.execute("delete items where quantity = 4 || id >= 9000;", options);
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 1900);
+
+    result = db.execute("select id from items;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_data().size(), 8100);
+
+    result = db.execute("delete items where quantity;", options);
+    EXPECT_FALSE(result.is_ok());
+}
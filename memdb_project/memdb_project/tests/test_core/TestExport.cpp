@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "memdb/core/Database.h"
+#include "memdb/core/Exporter.h"
+#include "memdb/core/exceptions/DatabaseException.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+void fill_users(memdb::core::Database& db) {
+    ASSERT_TRUE(db.execute("create table users ({key, autoincrement} id : int32, login: string[16], hash: bytes[4], is_admin: bool);").is_ok());
+    ASSERT_TRUE(db.execute("insert (, \"alice\", 0xdeadbeef, true), (, \"bob, jr\", 0x00, false), (, \"say \\\"hi\\\"\", , true), (, \"\", 0x, false) to users;").is_ok());
+}
+
+}
+
+TEST(ExportTest, TableToCsv) {
+    memdb::core::Database db;
+    fill_users(db);
+
+    std::string path = temp_path("memdb_export_users.csv");
+    db.export_csv("users", path);
+
+    EXPECT_EQ(read_file(path),
+              "id,login,hash,is_admin\n"
+              "1,alice,0xDEADBEEF,true\n"
+              "2,\"bob, jr\",0x00,false\n"
+              "3,\"say \"\"hi\"\"\",,true\n"
+              "4,\"\",0x,false\n");
+    std::filesystem::remove(path);
+}
+
+TEST(ExportTest, CsvRoundTripThroughImporter) {
+    memdb::core::Database db;
+    fill_users(db);
+
+    memdb::core::ExportOptions options;
+    options.rows_per_chunk = 1;
+    options.num_threads = 3;
+    std::string path = temp_path("memdb_export_roundtrip.csv");
+    db.export_csv("users", path, options);
+
+    memdb::core::Database copy;
+    ASSERT_TRUE(copy.execute("create table users ({key, autoincrement} id : int32, login: string[16], hash: bytes[4], is_admin: bool);").is_ok());
+    memdb::core::CsvImportResult imported = copy.import_csv("users", path);
+    EXPECT_EQ(imported.rows_imported, 4);
+    EXPECT_TRUE(imported.errors.empty());
+
+    const auto& original_rows = db.get_table("users")->get_all_rows();
+    const auto& copied_rows = copy.get_table("users")->get_all_rows();
+    ASSERT_EQ(original_rows.size(), copied_rows.size());
+    for (const auto& [row_id, row] : original_rows) {
+        const auto& copied = copied_rows.at(row_id).get_values();
+        for (size_t i = 0; i < row.get_values().size(); ++i) {
+            EXPECT_EQ(row.get_values()[i], copied[i]) << "row " << row_id << ", column " << i;
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ExportTest, ColumnarRoundTrip) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table events ({key} id : int32, kind: string[8], payload: bytes[2], ok: bool);").is_ok());
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    for (int i = 0; i < 2500; ++i) {
+        std::optional<memdb::core::Value> payload;
+        if (i % 7 != 0) {
+            payload = memdb::core::Value(std::vector<uint8_t>{ static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8) });
+        }
+        rows.push_back({ memdb::core::Value(i), memdb::core::Value("k" + std::to_string(i % 5)), payload, memdb::core::Value(i % 2 == 0) });
+    }
+    db.insert_rows("events", rows);
+
+    memdb::core::ExportOptions options;
+    options.rows_per_chunk = 1000;
+    std::string path = temp_path("memdb_export_events.mdbc");
+    db.export_columnar("events", path, options);
+
+    memdb::core::QueryResult loaded = memdb::core::Exporter::read_columnar(path);
+    ASSERT_TRUE(loaded.is_ok());
+    ASSERT_EQ(loaded.get_columns().size(), 4);
+    EXPECT_EQ(loaded.get_columns()[1].get_name(), "kind");
+    EXPECT_EQ(loaded.get_columns()[1].type.to_string(), "string[8]");
+    EXPECT_EQ(loaded.get_columns()[2].type.to_string(), "bytes[2]");
+    ASSERT_EQ(loaded.get_data().size(), rows.size());
+    for (size_t r = 0; r < rows.size(); ++r) {
+        for (size_t c = 0; c < rows[r].size(); ++c) {
+            EXPECT_EQ(loaded.get_data()[r][c], rows[r][c]) << "row " << r << ", column " << c;
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ExportTest, QueryResultExport) {
+    memdb::core::Database db;
+    fill_users(db);
+
+    memdb::core::QueryResult result = db.execute("select login, |login| as len from users where is_admin;");
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+
+    memdb::core::Exporter exporter;
+    std::string csv_path = temp_path("memdb_export_query.csv");
+    exporter.write_csv(result, csv_path);
+    EXPECT_EQ(read_file(csv_path), "login,len\nalice,5\n\"say \"\"hi\"\"\",8\n");
+
+    std::string columnar_path = temp_path("memdb_export_query.mdbc");
+    exporter.write_columnar(result, columnar_path);
+    memdb::core::QueryResult loaded = memdb::core::Exporter::read_columnar(columnar_path);
+    ASSERT_EQ(loaded.get_data().size(), 2);
+    EXPECT_EQ(loaded.get_columns()[1].get_type(), memdb::core::Type::Int32);
+    EXPECT_EQ(loaded.get_data()[1][0]->get_string(), "say \"hi\"");
+    EXPECT_EQ(loaded.get_data()[1][1]->get_int(), 8);
+
+    std::filesystem::remove(csv_path);
+    std::filesystem::remove(columnar_path);
+}
+
+TEST(ExportTest, InvalidColumnarFile) {
+    std::string path = temp_path("memdb_export_invalid.mdbc");
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << "not a columnar file";
+    }
+    EXPECT_THROW(memdb::core::Exporter::read_columnar(path), memdb::core::exceptions::SerializationException);
+    std::filesystem::remove(path);
+}
+
+TEST(ExportTest, CorruptColumnarChunksAreRejected) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table words (word : string[4]);").is_ok());
+    ASSERT_TRUE(db.execute("insert (\"ab\"), (\"cd\") to words;").is_ok());
+    std::string path = temp_path("memdb_export_corrupt.mdbc");
+    db.export_columnar("words", path, memdb::core::ExportOptions());
+    const std::string original = read_file(path);
+
+    auto read_patched = [&](size_t position, uint64_t value, size_t width) {
+        std::string contents = original;
+        for (size_t i = 0; i < width; ++i) {
+            contents[position + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        return memdb::core::Exporter::read_columnar(path);
+    };
+
+    // The chunk holds one validity byte, then the offsets 0, 2 and 4.
+    EXPECT_THROW(read_patched(8 + 1 + 4, 5, 4), memdb::core::exceptions::SerializationException);
+
+    // The footer stores the chunk offset and length right before the trailer.
+    size_t location = original.size() - 16 - 8 - 16;
+    EXPECT_THROW(read_patched(location + 8, UINT64_MAX, 8), memdb::core::exceptions::SerializationException);
+
+    ASSERT_EQ(read_patched(0, 'M', 1).get_data().size(), 2);
+    std::filesystem::remove(path);
+}
+
+TEST(ExportTest, CorruptColumnarFooterIsRejected) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table words (word : string[4]);").is_ok());
+    ASSERT_TRUE(db.execute("insert (\"ab\"), (\"cd\") to words;").is_ok());
+    std::string path = temp_path("memdb_export_corrupt_footer.mdbc");
+    db.export_columnar("words", path, memdb::core::ExportOptions());
+    const std::string original = read_file(path);
+
+    auto read_patched = [&](size_t position, uint64_t value, size_t width) {
+        std::string contents = original;
+        for (size_t i = 0; i < width; ++i) {
+            contents[position + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        return memdb::core::Exporter::read_columnar(path);
+    };
+
+    // The footer describes the column in 15 bytes, then holds the total row
+    // count, the group count, and the one group's row count and chunk location.
+    size_t footer = original.size() - 16 - 47;
+    size_t total_rows = footer + 15;
+    size_t group_count = total_rows + 8;
+    size_t group_rows = group_count + 4;
+    size_t chunk_offset = group_rows + 4;
+    for (uint64_t rows : {uint64_t{3}, uint64_t{1} << 40, UINT64_MAX}) {
+        EXPECT_THROW(read_patched(total_rows, rows, 8), memdb::core::exceptions::SerializationException) << rows;
+    }
+    EXPECT_THROW(read_patched(group_count, UINT32_MAX, 4), memdb::core::exceptions::SerializationException);
+    EXPECT_THROW(read_patched(group_count, 0, 4), memdb::core::exceptions::SerializationException);
+    for (uint64_t rows : {uint64_t{1}, uint64_t{3}, uint64_t{UINT32_MAX}}) {
+        EXPECT_THROW(read_patched(group_rows, rows, 4), memdb::core::exceptions::SerializationException) << rows;
+    }
+    EXPECT_THROW(read_patched(chunk_offset, 0, 8), memdb::core::exceptions::SerializationException);
+
+    ASSERT_EQ(read_patched(0, 'M', 1).get_data().size(), 2);
+    std::filesystem::remove(path);
+}
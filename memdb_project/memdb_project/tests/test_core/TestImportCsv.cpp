@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "memdb/core/Database.h"
+#include "memdb/core/QueryParser.h"
+#include "memdb/core/exceptions/DatabaseException.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+std::string write_csv(const std::string& name, const std::string& contents) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << contents;
+    return path.string();
+}
+
+}
+
+TEST(ImportCsvTest, ImportWithHeader) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table users ({key, autoincrement} id : int32, login: string[16], hash: bytes[4], is_admin: bool = false);").is_ok());
+
+    std::string path = write_csv("memdb_import_header.csv",
+        "is_admin,login,hash\n"
+        "true,alice,0xdeadbeef\n"
+        ",\"bob, jr\",00ff\r\n"
+        "false,\"say \"\"hi\"\"\",\n");
+
+    memdb::core::CsvImportResult result = db.import_csv("users", path);
+    EXPECT_EQ(result.rows_imported, 3);
+    EXPECT_EQ(result.rows_rejected, 0);
+    EXPECT_TRUE(result.errors.empty());
+
+    auto table = db.get_table("users");
+    ASSERT_EQ(table->get_all_rows().size(), 3);
+    EXPECT_EQ(table->get_row(1).get_value(0)->get_int(), 1);
+    EXPECT_EQ(table->get_row(1).get_value(1)->get_string(), "alice");
+    EXPECT_EQ(table->get_row(1).get_value(2)->get_bytes(), std::vector<uint8_t>({0xde, 0xad, 0xbe, 0xef}));
+    EXPECT_EQ(table->get_row(1).get_value(3)->get_bool(), true);
+    EXPECT_EQ(table->get_row(2).get_value(1)->get_string(), "bob, jr");
+    EXPECT_EQ(table->get_row(2).get_value(3)->get_bool(), false);
+    EXPECT_EQ(table->get_row(3).get_value(1)->get_string(), "say \"hi\"");
+    EXPECT_FALSE(table->get_row(3).get_value(2).has_value());
+
+    std::filesystem::remove(path);
+}
+
+TEST(ImportCsvTest, ParallelChunksPreserveFileOrder) {
+    memdb::core::ThreadPoolOptions pool_options;
+    pool_options.num_threads = 4;
+    memdb::core::Database db(pool_options);
+    ASSERT_TRUE(db.execute("create table numbers ({key} n : int32, label: string[16]);").is_ok());
+
+    std::string contents;
+    const int num_records = 5000;
+    for (int i = 0; i < num_records; ++i) {
+        contents += std::to_string(i) + ",row" + std::to_string(i) + "\n";
+    }
+    std::string path = write_csv("memdb_import_parallel.csv", contents);
+
+    memdb::core::CsvImportOptions options;
+    options.has_header = false;
+    options.num_threads = 4;
+    options.chunk_size = 256;
+
+    size_t progress_calls = 0;
+    size_t last_rows = 0;
+    size_t last_bytes = 0;
+    options.on_progress = [&](size_t rows, size_t bytes, size_t total) {
+        EXPECT_GE(rows, last_rows);
+        EXPECT_GE(bytes, last_bytes);
+        EXPECT_LE(bytes, total);
+        last_rows = rows;
+        last_bytes = bytes;
+        progress_calls++;
+    };
+
+    memdb::core::CsvImportResult result = db.import_csv("numbers", path, options);
+    EXPECT_EQ(result.rows_imported, num_records);
+    EXPECT_GT(progress_calls, 1);
+    EXPECT_EQ(last_bytes, contents.size());
+
+    auto table = db.get_table("numbers");
+    ASSERT_EQ(table->get_all_rows().size(), num_records);
+    int expected = 0;
+    for (const auto& [row_id, row] : table->get_all_rows()) {
+        EXPECT_EQ(row.get_value(0)->get_int(), expected);
+        EXPECT_EQ(row.get_value(1)->get_string(), "row" + std::to_string(expected));
+        expected++;
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(ImportCsvTest, ReportsErrorRows) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table items ({unique} code : string[4], qty: int32);").is_ok());
+
+    std::string path = write_csv("memdb_import_errors.csv",
+        "code,qty\n"
+        "a,1\n"
+        "b,two\n"
+        "toolong,3\n"
+        "a,4\n"
+        "c,5,6\n"
+        "d,6\n");
+
+    memdb::core::CsvImportOptions options;
+    options.chunk_size = 8;
+    memdb::core::CsvImportResult result = db.import_csv("items", path, options);
+
+    EXPECT_EQ(result.rows_imported, 2);
+    EXPECT_EQ(result.rows_rejected, 4);
+    ASSERT_EQ(result.errors.size(), 4);
+    EXPECT_EQ(result.errors[0].line, 3);
+    EXPECT_THAT(result.errors[0].message, testing::HasSubstr("Invalid int32 value"));
+    EXPECT_EQ(result.errors[1].line, 4);
+    EXPECT_EQ(result.errors[2].line, 5);
+    EXPECT_THAT(result.errors[2].message, testing::HasSubstr("Duplicate value"));
+    EXPECT_EQ(result.errors[3].line, 6);
+    EXPECT_EQ(db.get_table("items")->get_all_rows().size(), 2);
+
+    std::filesystem::remove(path);
+}
+
+TEST(ImportCsvTest, ParsesSignsAndBoolsStrictly) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table flags (n : int32, active: bool);").is_ok());
+
+    std::string path = write_csv("memdb_import_fields.csv",
+        "n,active\n"
+        "+5,TRUE\n"
+        "-5,False\n"
+        "+-5,true\n"
+        "+,false\n"
+        "7,yes\n");
+
+    memdb::core::CsvImportResult result = db.import_csv("flags", path, memdb::core::CsvImportOptions());
+
+    EXPECT_EQ(result.rows_imported, 2);
+    ASSERT_EQ(result.errors.size(), 3);
+    EXPECT_EQ(result.errors[0].line, 4);
+    EXPECT_THAT(result.errors[0].message, testing::HasSubstr("Invalid int32 value"));
+    EXPECT_EQ(result.errors[1].line, 5);
+    EXPECT_THAT(result.errors[2].message, testing::HasSubstr("Invalid bool value"));
+
+    const auto& rows = db.get_table("flags")->get_all_rows();
+    ASSERT_EQ(rows.size(), 2);
+    EXPECT_EQ(rows.begin()->second.get_value(0)->get_int(), 5);
+    EXPECT_TRUE(rows.begin()->second.get_value(1)->get_bool());
+    EXPECT_FALSE(std::next(rows.begin())->second.get_value(1)->get_bool());
+
+    std::filesystem::remove(path);
+}
+
+TEST(ImportCsvTest, StopOnError) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table items (code : string[4], qty: int32);").is_ok());
+
+    std::string path = write_csv("memdb_import_stop.csv", "code,qty\na,1\nb,x\n");
+
+    memdb::core::CsvImportOptions options;
+    options.stop_on_error = true;
+    try {
+        db.import_csv("items", path, options);
+        FAIL() << "Expected exception for malformed row.";
+    } catch (const std::invalid_argument& e) {
+        EXPECT_THAT(e.what(), testing::HasSubstr("CSV line 3"));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(ImportCsvTest, MissingFileAndUnknownColumn) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table items (code : string[4], qty: int32);").is_ok());
+
+    EXPECT_THROW(db.import_csv("items", "/nonexistent/memdb.csv"), memdb::core::exceptions::SerializationException);
+
+    std::string path = write_csv("memdb_import_unknown.csv", "code,price\na,1\n");
+    EXPECT_THROW(db.import_csv("items", path), std::invalid_argument);
+    std::filesystem::remove(path);
+}
@@ -4,6 +4,8 @@
 #include "memdb/core/Database.h"
 #include "memdb/core/Table.h"
 
+#include <type_traits>
+
 TEST(InsertTest, SuccessfulInsert) {
     memdb::core::Database db;
     memdb::core::QueryParser parser;
@@ -446,3 +448,193 @@ TEST(InsertTest, InsertEmptyStringsAndBytes) {
     EXPECT_EQ(row.get_value(1)->get_string(), "");
     EXPECT_EQ(row.get_value(2)->get_bytes(), std::vector<uint8_t>({0x00, 0x00}));
 }
+
+
+TEST(InsertTest, MultiRowInsert) {
+    memdb::core::Database db;
+    memdb::core::QueryParser parser;
+    parser.set_database(&db);
+
+    std::string create_query = "create table users ({key, autoincrement} id : int32, name: string[32], is_admin: bool = false);";
+    memdb::core::ParsedQuery pq_create = parser.parse(create_query);
+    db.create_table(pq_create.table_name, pq_create.columns);
+
+    std::string insert_query = "insert (, \"Alice\", true), (, \"Bob (admin)\"), (name = \"Carol\") to users;";
+    memdb::core::ParsedQuery pq_insert = parser.parse(insert_query);
+    EXPECT_FALSE(pq_insert.insert_values.has_value());
+    ASSERT_EQ(pq_insert.insert_batch.size(), 3);
+
+    memdb::core::QueryResult result = db.execute(insert_query);
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    ASSERT_EQ(result.get_data().size(), 3);
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 1);
+    EXPECT_EQ(result.get_data()[2][0]->get_int(), 3);
+
+    auto table = db.get_table("users");
+    ASSERT_EQ(table->get_all_rows().size(), 3);
+    EXPECT_EQ(table->get_row(1).get_value(2)->get_bool(), true);
+    EXPECT_EQ(table->get_row(2).get_value(1)->get_string(), "Bob (admin)");
+    EXPECT_EQ(table->get_row(2).get_value(2)->get_bool(), false);
+    EXPECT_EQ(table->get_row(3).get_value(0)->get_int(), 3);
+}
+
+TEST(InsertTest, MultiRowInsertInvalidSeparator) {
+    memdb::core::Database db;
+    memdb::core::QueryParser parser;
+    parser.set_database(&db);
+
+    std::string create_query = "create table users (id : int32, name: string[32]);";
+    memdb::core::ParsedQuery pq_create = parser.parse(create_query);
+    db.create_table(pq_create.table_name, pq_create.columns);
+
+    EXPECT_THROW(parser.parse("insert (1, \"Alice\") (2, \"Bob\") to users;"), std::invalid_argument);
+}
+
+TEST(InsertTest, BulkInsertRows) {
+    memdb::core::Database db;
+    memdb::core::QueryParser parser;
+    parser.set_database(&db);
+
+    std::string create_query = "create table items ({key, autoincrement} id : int32, {unique} code: string[8], qty: int32 = 1);";
+    memdb::core::ParsedQuery pq_create = parser.parse(create_query);
+    db.create_table(pq_create.table_name, pq_create.columns);
+
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    for (int i = 0; i < 1000; ++i) {
+        rows.push_back({ std::nullopt, memdb::core::Value("c" + std::to_string(i)) });
+    }
+
+    std::vector<memdb::core::RowID> ids;
+    ASSERT_NO_THROW(ids = db.insert_rows("items", rows));
+    ASSERT_EQ(ids.size(), 1000);
+    EXPECT_EQ(ids.front(), 1);
+    EXPECT_EQ(ids.back(), 1000);
+
+    auto table = db.get_table("items");
+    ASSERT_EQ(table->get_all_rows().size(), 1000);
+    EXPECT_EQ(table->get_row(500).get_value(0)->get_int(), 500);
+    EXPECT_EQ(table->get_row(500).get_value(1)->get_string(), "c499");
+    EXPECT_EQ(table->get_row(500).get_value(2)->get_int(), 1);
+
+    memdb::core::RowID next_id = db.insert_row("items", { std::nullopt, memdb::core::Value(std::string("next")) });
+    EXPECT_EQ(next_id, 1001);
+}
+
+TEST(InsertTest, BulkInsertIsAtomic) {
+    memdb::core::Database db;
+    memdb::core::QueryParser parser;
+    parser.set_database(&db);
+
+    std::string create_query = "create table users ({key, autoincrement} id : int32, {unique} email: string[50]);";
+    memdb::core::ParsedQuery pq_create = parser.parse(create_query);
+    db.create_table(pq_create.table_name, pq_create.columns);
+    db.insert_row("users", { std::nullopt, memdb::core::Value(std::string("alice@example.com")) });
+
+    std::vector<std::vector<std::optional<memdb::core::Value>>> duplicate_in_batch = {
+        { std::nullopt, memdb::core::Value(std::string("bob@example.com")) },
+        { std::nullopt, memdb::core::Value(std::string("bob@example.com")) }
+    };
+    try {
+        db.insert_rows("users", duplicate_in_batch);
+        FAIL() << "Expected exception for duplicate value inside the batch.";
+    } catch (const std::invalid_argument& e) {
+        EXPECT_THAT(e.what(), testing::HasSubstr("Duplicate value for unique/key column \"email\""));
+    }
+
+    std::vector<std::vector<std::optional<memdb::core::Value>>> duplicate_existing = {
+        { std::nullopt, memdb::core::Value(std::string("carol@example.com")) },
+        { std::nullopt, memdb::core::Value(std::string("alice@example.com")) }
+    };
+    EXPECT_THROW(db.insert_rows("users", duplicate_existing), std::invalid_argument);
+
+    std::vector<std::vector<std::optional<memdb::core::Value>>> wrong_type = {
+        { std::nullopt, memdb::core::Value(std::string("dave@example.com")) },
+        { std::nullopt, memdb::core::Value(42) }
+    };
+    EXPECT_THROW(db.insert_rows("users", wrong_type), std::invalid_argument);
+
+    EXPECT_EQ(db.get_table("users")->get_all_rows().size(), 1);
+}
+
+TEST(InsertTest, BulkInsertTracksUniqueValuesAcrossUpdatesAndDeletes) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table users ({key, autoincrement} id : int32, {unique} email: string[50]);").is_ok());
+    ASSERT_TRUE(db.execute("insert (, \"a@x\"), (, \"b@x\"), (, \"c@x\") to users;").is_ok());
+
+    auto email = [](const std::string& value) {
+        return std::vector<std::optional<memdb::core::Value>>{ std::nullopt, memdb::core::Value(value) };
+    };
+    ASSERT_TRUE(db.execute("delete users where email = \"a@x\";").is_ok());
+    ASSERT_TRUE(db.execute("update users set email = \"d@x\" where email = \"b@x\";").is_ok());
+    EXPECT_NO_THROW(db.insert_rows("users", { email("a@x"), email("b@x") }));
+    EXPECT_THROW(db.insert_rows("users", { email("e@x"), email("d@x") }), std::invalid_argument);
+    EXPECT_THROW(db.insert_rows("users", { email("c@x") }), std::invalid_argument);
+    EXPECT_EQ(db.get_table("users")->get_all_rows().size(), 4);
+}
+
+TEST(InsertTest, BulkInsertMaintainsIndexes) {
+    memdb::core::Database db;
+    memdb::core::QueryParser parser;
+    parser.set_database(&db);
+
+    std::string create_query = "create table products ({key, autoincrement} id : int32, category: string[20], price: int32);";
+    memdb::core::ParsedQuery pq_create = parser.parse(create_query);
+    db.create_table(pq_create.table_name, pq_create.columns);
+    ASSERT_TRUE(db.execute("create unordered index on products by category;").is_ok());
+
+    ASSERT_TRUE(db.execute("insert (, \"Books\", 10), (, \"Games\", 20), (, \"Books\", 30) to products;").is_ok());
+
+    auto table = db.get_table("products");
+    ASSERT_EQ(table->get_indexes().size(), 1);
+    std::vector<memdb::core::RowID> books = table->get_indexes()[0]->search_unordered({ { "category", memdb::core::Value(std::string("Books")) } });
+    EXPECT_THAT(books, testing::ElementsAre(1, 3));
+
+    table->delete_row(1);
+    books = table->get_indexes()[0]->search_unordered({ { "category", memdb::core::Value(std::string("Books")) } });
+    EXPECT_THAT(books, testing::ElementsAre(3));
+}
+
+TEST(InsertTest, InsertWithExistingRowIdLeavesIndexesUnchanged) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table t (id : int32, v: int32);").is_ok());
+    ASSERT_TRUE(db.execute("create ordered index on t by v;").is_ok());
+
+    auto table = db.get_table("t");
+    EXPECT_EQ(table->insert_row({ memdb::core::Value(1), memdb::core::Value(10) }, 7), 7);
+    EXPECT_THROW(table->insert_row({ memdb::core::Value(2), memdb::core::Value(20) }, 7), std::invalid_argument);
+
+    EXPECT_TRUE(db.execute("select id from t where v = 20;").get_data().empty());
+    auto result = db.execute("select id from t where v > 0;");
+    ASSERT_EQ(result.get_data().size(), 1);
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 1);
+    EXPECT_EQ(table->get_indexes()[0]->get_ordered_entries().size(), 1);
+}
+
+TEST(InsertTest, BulkInsertKeepsTiesInRowIdOrder) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table t (id : int32, v: int32);").is_ok());
+    ASSERT_TRUE(db.execute("create ordered index on t by v;").is_ok());
+    ASSERT_TRUE(db.execute("insert (1, 5) to t;").is_ok());
+    ASSERT_TRUE(db.execute("insert (2, 3), (3, 5), (4, 5) to t;").is_ok());
+
+    std::vector<memdb::core::RowID> order;
+    for (const auto& [key, row_id] : db.get_table("t")->get_indexes()[0]->get_ordered_entries()) {
+        order.push_back(row_id);
+    }
+    EXPECT_THAT(order, testing::ElementsAre(2, 1, 3, 4));
+}
+
+TEST(InsertTest, SingleAndBulkInsertsCheckDefaultsForUniqueness) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table t (id : int32, {unique} code: int32 = 7);").is_ok());
+    ASSERT_TRUE(db.execute("insert (id = 1) to t;").is_ok());
+    EXPECT_FALSE(db.execute("insert (id = 2) to t;").is_ok());
+    EXPECT_THROW(db.insert_rows("t", { { memdb::core::Value(3) } }), std::invalid_argument);
+    EXPECT_EQ(db.get_table("t")->get_all_rows().size(), 1);
+}
+
+TEST(InsertTest, DatabaseIsNeitherCopiedNorMoved) {
+    static_assert(!std::is_copy_constructible_v<memdb::core::Database>, "the parser points at its database");
+    static_assert(!std::is_move_constructible_v<memdb::core::Database>, "the parser points at its database");
+    static_assert(!std::is_move_assignable_v<memdb::core::Database>, "the parser points at its database");
+}
@@ -0,0 +1,342 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "memdb/core/Database.h"
+#include "memdb/core/QueryParser.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+void create_join_tables(memdb::core::Database& db, int user_count, int orders_per_user) {
+    ASSERT_TRUE(db.execute("create table users ({key} id : int32, name: string[32]);").is_ok());
+    ASSERT_TRUE(db.execute("create table orders ({key} order_id : int32, user_id: int32, amount: int32);").is_ok());
+
+    std::vector<std::vector<std::optional<memdb::core::Value>>> users;
+    for (int i = 0; i < user_count; ++i) {
+        users.push_back({memdb::core::Value(i), memdb::core::Value("user" + std::to_string(i))});
+    }
+    db.insert_rows("users", users);
+
+    std::vector<std::vector<std::optional<memdb::core::Value>>> orders;
+    for (int i = 0; i < user_count * orders_per_user; ++i) {
+        orders.push_back({memdb::core::Value(i), memdb::core::Value(i % user_count), memdb::core::Value(i % 100)});
+    }
+    db.insert_rows("orders", orders);
+}
+
+}
+
+TEST(JoinTest, EquiJoinOnLargeTables) {
+    memdb::core::Database db;
+    create_join_tables(db, 2000, 5);
+
+    memdb::core::QueryResult result = db.execute("select users.name, orders.order_id from users join orders on users.id = orders.user_id;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 10000);
+    for (const auto& row : result.get_data()) {
+        int order_id = row[1]->get_int();
+        EXPECT_EQ(row[0]->get_string(), "user" + std::to_string(order_id % 2000));
+    }
+}
+
+TEST(JoinTest, OutputOrderMatchesTableOrder) {
+    memdb::core::Database db;
+    create_join_tables(db, 3, 2);
+
+    memdb::core::QueryResult result = db.execute("select users.id, orders.order_id from users join orders on orders.user_id = users.id;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 6);
+    std::vector<std::pair<int, int>> expected = {{0, 0}, {0, 3}, {1, 1}, {1, 4}, {2, 2}, {2, 5}};
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(result.get_data()[i][0]->get_int(), expected[i].first);
+        EXPECT_EQ(result.get_data()[i][1]->get_int(), expected[i].second);
+    }
+}
+
+TEST(JoinTest, ResidualPredicateIsAppliedAfterProbe) {
+    memdb::core::Database db;
+    create_join_tables(db, 10, 10);
+
+    memdb::core::QueryResult result = db.execute("select users.id, orders.amount from users join orders on users.id = orders.user_id && orders.amount >= 90 where users.id < 5;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 5);
+    for (const auto& row : result.get_data()) {
+        EXPECT_LT(row[0]->get_int(), 5);
+        EXPECT_GE(row[1]->get_int(), 90);
+    }
+}
+
+TEST(JoinTest, NonEquiJoinFallsBackToNestedLoop) {
+    memdb::core::Database db;
+    create_join_tables(db, 4, 1);
+
+    memdb::core::QueryResult result = db.execute("select users.id, orders.order_id from users join orders on users.id < orders.user_id;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 6);
+    ASSERT_EQ(result.get_columns().size(), 2);
+    EXPECT_EQ(result.get_columns()[0].get_name(), "users.id");
+    EXPECT_EQ(result.get_columns()[1].get_name(), "orders.order_id");
+}
+
+TEST(JoinTest, MismatchedKeyTypesAreReported) {
+    memdb::core::Database db;
+    create_join_tables(db, 2, 1);
+
+    memdb::core::QueryResult result = db.execute("select users.id from users join orders on users.name = orders.user_id;");
+
+    EXPECT_FALSE(result.is_ok());
+}
+
+TEST(JoinTest, UnorderedIndexOnInnerTableIsProbed) {
+    memdb::core::Database db;
+    create_join_tables(db, 50, 4);
+    ASSERT_TRUE(db.execute("create unordered index on users by id;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select orders.order_id, users.name from orders join users on orders.user_id = users.id where orders.order_id < 60;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 60);
+    for (size_t i = 0; i < result.get_data().size(); ++i) {
+        EXPECT_EQ(result.get_data()[i][0]->get_int(), static_cast<int>(i));
+        EXPECT_EQ(result.get_data()[i][1]->get_string(), "user" + std::to_string(i % 50));
+    }
+}
+
+TEST(JoinTest, OrderedIndexOnInnerTableIsProbed) {
+    memdb::core::Database db;
+    create_join_tables(db, 20, 3);
+    ASSERT_TRUE(db.execute("create ordered index on orders by user_id;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select users.id, orders.order_id from users join orders on users.id = orders.user_id;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 60);
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 0);
+    EXPECT_EQ(result.get_data()[0][1]->get_int(), 0);
+    EXPECT_EQ(result.get_data()[1][0]->get_int(), 0);
+    EXPECT_EQ(result.get_data()[1][1]->get_int(), 20);
+    EXPECT_EQ(result.get_data()[2][1]->get_int(), 40);
+}
+
+TEST(JoinTest, RangeJoinUsesOrderedIndex) {
+    memdb::core::Database db;
+    create_join_tables(db, 12, 1);
+    ASSERT_TRUE(db.execute("create ordered index on orders by user_id;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select users.id, orders.user_id from users join orders on orders.user_id > users.id && orders.user_id <= users.id + 2 && users.id >= 8;");
+
+    ASSERT_TRUE(result.is_ok());
+    std::vector<std::pair<int, int>> expected = {{8, 9}, {8, 10}, {9, 10}, {9, 11}, {10, 11}};
+    ASSERT_EQ(result.get_data().size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(result.get_data()[i][0]->get_int(), expected[i].first);
+        EXPECT_EQ(result.get_data()[i][1]->get_int(), expected[i].second);
+    }
+}
+
+TEST(JoinTest, MergeJoinOverOrderedIndexesReturnsKeyOrder) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table accounts (code : int32, owner: string[16]);").is_ok());
+    ASSERT_TRUE(db.execute("create table ledger (entry : int32, code: int32);").is_ok());
+    ASSERT_TRUE(db.execute("insert (30, \"carol\"), (10, \"alice\"), (20, \"bob\"), (40, \"dave\") to accounts;").is_ok());
+    ASSERT_TRUE(db.execute("insert (1, 20), (2, 10), (3, 30), (4, 20), (5, 50) to ledger;").is_ok());
+    ASSERT_TRUE(db.execute("create ordered index on accounts by code;").is_ok());
+    ASSERT_TRUE(db.execute("create ordered index on ledger by code;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select accounts.owner, ledger.entry from accounts join ledger on ledger.code = accounts.code;");
+
+    ASSERT_TRUE(result.is_ok());
+    std::vector<std::pair<std::string, int>> expected = {{"alice", 2}, {"bob", 1}, {"bob", 4}, {"carol", 3}};
+    ASSERT_EQ(result.get_data().size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(result.get_data()[i][0]->get_string(), expected[i].first);
+        EXPECT_EQ(result.get_data()[i][1]->get_int(), expected[i].second);
+    }
+}
+
+TEST(JoinTest, FourWayJoin) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table regions (region_id : int32, region: string[16]);").is_ok());
+    ASSERT_TRUE(db.execute("create table customers (customer_id : int32, region_id: int32, name: string[16]);").is_ok());
+    ASSERT_TRUE(db.execute("create table orders (order_id : int32, customer_id: int32, product_id: int32);").is_ok());
+    ASSERT_TRUE(db.execute("create table products (product_id : int32, title: string[16]);").is_ok());
+    ASSERT_TRUE(db.execute("insert (1, \"north\"), (2, \"south\") to regions;").is_ok());
+    ASSERT_TRUE(db.execute("insert (10, 1, \"alice\"), (11, 2, \"bob\"), (12, 1, \"carol\") to customers;").is_ok());
+    ASSERT_TRUE(db.execute("insert (100, 10, 7), (101, 11, 8), (102, 12, 7), (103, 10, 9) to orders;").is_ok());
+    ASSERT_TRUE(db.execute("insert (7, \"pen\"), (8, \"ink\"), (9, \"pad\") to products;").is_ok());
+    ASSERT_TRUE(db.execute("create unordered index on products by product_id;").is_ok());
+
+    memdb::core::QueryResult result = db.execute(
+        "select orders.order_id, customers.name, regions.region, products.title from orders "
+        "join customers on orders.customer_id = customers.customer_id "
+        "join regions on customers.region_id = regions.region_id "
+        "join products on products.product_id = orders.product_id "
+        "where regions.region = \"north\";");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_columns().size(), 4);
+    std::vector<std::vector<std::string>> rows;
+    for (const auto& row : result.get_data()) {
+        rows.push_back({std::to_string(row[0]->get_int()), row[1]->get_string(), row[2]->get_string(), row[3]->get_string()});
+    }
+    std::sort(rows.begin(), rows.end());
+    std::vector<std::vector<std::string>> expected = {
+        {"100", "alice", "north", "pen"},
+        {"102", "carol", "north", "pen"},
+        {"103", "alice", "north", "pad"}
+    };
+    EXPECT_EQ(rows, expected);
+}
+
+TEST(JoinTest, ThreeWayJoinWithCrossTableCondition) {
+    memdb::core::Database db;
+    ASSERT_TRUE(db.execute("create table a (x : int32);").is_ok());
+    ASSERT_TRUE(db.execute("create table b (y : int32);").is_ok());
+    ASSERT_TRUE(db.execute("create table c (z : int32);").is_ok());
+    ASSERT_TRUE(db.execute("insert (1), (2), (3) to a;").is_ok());
+    ASSERT_TRUE(db.execute("insert (2), (3), (4) to b;").is_ok());
+    ASSERT_TRUE(db.execute("insert (5), (6), (7) to c;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select a.x, b.y, c.z from a join b on a.x < b.y join c on c.z = a.x + b.y;");
+
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_data().size(), 4);
+    for (const auto& row : result.get_data()) {
+        EXPECT_LT(row[0]->get_int(), row[1]->get_int());
+        EXPECT_EQ(row[2]->get_int(), row[0]->get_int() + row[1]->get_int());
+    }
+}
+
+TEST(JoinTest, WherePredicatesArePushedBelowJoin) {
+    memdb::core::Database db;
+    create_join_tables(db, 100, 3);
+    ASSERT_TRUE(db.execute("create ordered index on orders by amount;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select users.name, orders.order_id from users join orders on users.id = orders.user_id where orders.amount >= 95 && users.id >= 97 && orders.order_id != users.id;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 6);
+    for (const auto& row : result.get_data()) {
+        int order_id = row[1]->get_int();
+        EXPECT_GE(order_id, 100);
+        EXPECT_GE(order_id % 100, 97);
+        EXPECT_EQ(row[0]->get_string(), "user" + std::to_string(order_id % 100));
+    }
+}
+
+TEST(JoinTest, PushedPredicateOnMultiWayJoin) {
+    memdb::core::Database db;
+    create_join_tables(db, 30, 2);
+    ASSERT_TRUE(db.execute("create table notes (user_id : int32, note: string[16]);").is_ok());
+    ASSERT_TRUE(db.execute("insert (3, \"vip\"), (4, \"new\"), (33, \"gone\") to notes;").is_ok());
+
+    memdb::core::QueryResult result = db.execute("select users.id, orders.order_id, notes.note from users join orders on orders.user_id = users.id join notes on notes.user_id = users.id where notes.note = \"vip\";");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 2);
+    for (const auto& row : result.get_data()) {
+        EXPECT_EQ(row[0]->get_int(), 3);
+        EXPECT_EQ(row[2]->get_string(), "vip");
+    }
+}
+
+TEST(JoinTest, CursorOverJoinMatchesExecute) {
+    memdb::core::Database db;
+    create_join_tables(db, 50, 4);
+    std::string query = "select users.name, orders.order_id from users join orders on users.id = orders.user_id where orders.amount < 10;";
+
+    memdb::core::QueryResult result = db.execute(query);
+    ASSERT_TRUE(result.is_ok());
+
+    memdb::core::QueryCursor cursor = db.open_cursor(query);
+    std::vector<std::optional<memdb::core::Value>> row;
+    size_t count = 0;
+    while (cursor.next(row)) {
+        ASSERT_LT(count, result.get_data().size());
+        EXPECT_EQ(row[0]->get_string(), result.get_data()[count][0]->get_string());
+        EXPECT_EQ(row[1]->get_int(), result.get_data()[count][1]->get_int());
+        ++count;
+    }
+    EXPECT_EQ(count, result.get_data().size());
+    EXPECT_EQ(count, 20);
+}
+
+TEST(JoinTest, LimitOnJoin) {
+    memdb::core::Database db;
+    create_join_tables(db, 100, 5);
+
+    memdb::core::QueryResult result = db.execute("select users.id, orders.order_id from users join orders on users.id = orders.user_id limit 7 offset 3;");
+
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 7);
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 0);
+    EXPECT_EQ(result.get_data()[0][1]->get_int(), 300);
+    EXPECT_EQ(result.get_data()[2][0]->get_int(), 1);
+}
+
+TEST(JoinTest, OrderByOnJoin) {
+    memdb::core::Database db;
+    create_join_tables(db, 20, 3);
+
+    memdb::core::QueryResult result = db.execute("select users.name, orders.amount as amount from users join orders on users.id = orders.user_id order by amount desc, users.name limit 4;");
+
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    ASSERT_EQ(result.get_data().size(), 4);
+    EXPECT_EQ(result.get_data()[0][1]->get_int(), 59);
+    EXPECT_EQ(result.get_data()[0][0]->get_string(), "user19");
+    EXPECT_EQ(result.get_data()[3][1]->get_int(), 56);
+}
+
+TEST(JoinTest, PartitionedHashJoinMatchesSerial) {
+    memdb::core::ThreadPoolOptions pool_options;
+    pool_options.num_threads = 4;
+    memdb::core::Database db(pool_options);
+    ASSERT_TRUE(db.execute("create table accounts (id : int32, bucket: int32);").is_ok());
+    ASSERT_TRUE(db.execute("create table entries (entry_id : int32, account: int32, bucket: int32, amount: int32);").is_ok());
+    ASSERT_TRUE(db.execute("create table buckets (bucket : int32, label: string[8]);").is_ok());
+
+    std::vector<std::vector<std::optional<memdb::core::Value>>> accounts;
+    for (int i = 0; i < 6000; ++i) {
+        accounts.push_back({memdb::core::Value(i % 4000), memdb::core::Value(i % 7)});
+    }
+    db.insert_rows("accounts", accounts);
+    std::vector<std::vector<std::optional<memdb::core::Value>>> entries;
+    for (int i = 0; i < 20000; ++i) {
+        std::optional<memdb::core::Value> account;
+        if (i % 11 != 0) {
+            account = memdb::core::Value((i * 37) % 5000);
+        }
+        entries.push_back({memdb::core::Value(i), account, memdb::core::Value(i % 7), memdb::core::Value(i % 100)});
+    }
+    db.insert_rows("entries", entries);
+    std::vector<std::vector<std::optional<memdb::core::Value>>> buckets;
+    for (int i = 0; i < 7; ++i) {
+        buckets.push_back({memdb::core::Value(i), memdb::core::Value("b" + std::to_string(i))});
+    }
+    db.insert_rows("buckets", buckets);
+
+    memdb::core::QueryOptions serial;
+    serial.num_threads = 1;
+    memdb::core::QueryOptions parallel;
+    parallel.morsel_size = 1024;
+
+    const std::vector<std::string> queries = {
+        "select accounts.id, entries.entry_id from accounts join entries on accounts.id = entries.account;",
+        "select entries.entry_id, accounts.id from entries join accounts on entries.account = accounts.id && entries.bucket = accounts.bucket where entries.amount < 50;",
+        "select entries.entry_id, buckets.label from entries join accounts on entries.account = accounts.id join buckets on accounts.bucket = buckets.bucket where entries.amount > 90;"
+    };
+    for (const auto& query : queries) {
+        memdb::core::QueryResult expected = db.execute(query, serial);
+        memdb::core::QueryResult actual = db.execute(query, parallel);
+        ASSERT_TRUE(expected.is_ok()) << query << ": " << expected.get_error();
+        ASSERT_TRUE(actual.is_ok()) << query << ": " << actual.get_error();
+        ASSERT_FALSE(expected.get_data().empty()) << query;
+        EXPECT_EQ(actual.get_data(), expected.get_data()) << query;
+    }
+}
@@ -747,4 +747,32 @@ TEST(UpdateTest, UpdateWithInvalidSetClause) {
     
     ASSERT_FALSE(result.is_ok());
     EXPECT_THAT(result.get_error(), ::testing::HasSubstr("Invalid assignment in UPDATE: quantity 20"));
-}
\ No newline at end of file
+}
+TEST(UpdateTest, UpdateManyRowsInParallel) {
+    memdb::core::ThreadPoolOptions pool_options;
+    pool_options.num_threads = 4;
+    memdb::core::Database db(pool_options);
+    ASSERT_TRUE(db.execute("create table items (id : int32, quantity: int32);").is_ok());
+    std::vector<std::vector<std::optional<memdb::core::Value>>> rows;
+    for (int i = 0; i < 10000; ++i) {
+        rows.push_back({memdb::core::Value(i), memdb::core::Value(i % 10)});
+    }
+    db.insert_rows("items", rows);
+
+    memdb::core::QueryOptions options;
+    options.morsel_size = 256;
+    memdb::core::QueryResult result = db.execute("update items set quantity = quantity + 100 where quantity < 3;", options);
+    ASSERT_TRUE(result.is_ok()) << result.get_error();
+    EXPECT_EQ(result.get_data()[0][0]->get_int(), 3000);
+
+    result = db.execute("select id, quantity from items where quantity >= 100;");
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_data().size(), 3000);
+    for (size_t i = 0; i < result.get_data().size(); ++i) {
+        int id = result.get_data()[i][0]->get_int();
+        EXPECT_EQ(result.get_data()[i][1]->get_int(), id % 10 + 100);
+        if (i > 0) {
+            EXPECT_LT(result.get_data()[i - 1][0]->get_int(), id);
+        }
+    }
+}